@@ -1,4 +1,9 @@
 -- premake5.lua
+newoption {
+   trigger = "avx2",
+   description = "Use AVX2 instructions, binaries won't start on CPUs without them"
+}
+
 workspace "PixieEngine"
    architecture "x64"
    configurations { "Debug", "Release", "Dist" }
@@ -8,10 +13,18 @@ workspace "PixieEngine"
    filter "system:windows"
       buildoptions { "/EHsc", "/Zc:preprocessor", "/Zc:__cplusplus" }
 
+   -- SSE2 baseline of x64 by default, Math/SIMD.h enables 8 wide BVH node tests when compiling for AVX.
+   filter "options:avx2"
+      vectorextensions "AVX2"
+
+   filter {}
+
 OutputDir = "%{cfg.system}-%{cfg.architecture}/%{cfg.buildcfg}"
 
 include "PixieEngineCore/Build-Core.lua"
 
+include "PixieEngineCLI/Build-CLI.lua"
+
 include "PixieEngineApp/Build-App.lua"
 
 filter {}
@@ -2,8 +2,9 @@
 #include "ComponentRenderer.h"
 #include "PixieEngineApp.h"
 
-void ComponentRenderer::DrawTransform(Transform& transform, bool showHead, bool defaultOpen) {
+bool ComponentRenderer::DrawTransform(Transform& transform, bool showHead, bool defaultOpen) {
 	ImGuiTreeNodeFlags flags = defaultOpen ? ImGuiTreeNodeFlags_DefaultOpen : ImGuiTreeNodeFlags_None;
+	bool changed = false;
 	if(!showHead || ImGui::CollapsingHeader("Transform", flags)) {
 		const Float minPosition = (Float)-10000, maxPosition = (Float)10000;
 		const Float minRotation = (Float)-720, maxRotation = (Float)720;
@@ -11,16 +12,20 @@ void ComponentRenderer::DrawTransform(Transform& transform, bool showHead, bool
 		Vec3 position = transform.GetPosition();
 		if (ImGui::DragScalarN("Position", ImGuiFloat, &position, 3, 0.01f, &minPosition, &maxPosition)) {
 			transform.SetPosition(position);
+			changed = true;
 		}
 		Vec3 rotation = transform.GetEulerRotation();
 		if (ImGui::DragScalarN("Rotation", ImGuiFloat, &rotation, 3, 0.1f, &minRotation, &maxRotation)) {
 			transform.SetEulerRotation(rotation);
+			changed = true;
 		}
 		Vec3 scale = transform.GetScale();
 		if (ImGui::DragScalarN("Scale", ImGuiFloat, &scale, 3, 0.01f, &minScale, &maxScale)) {
 			transform.SetScale(scale);
+			changed = true;
 		}
 	}
+	return changed;
 }
 
 void ComponentRenderer::DrawMaterial(Material* material, bool showHead, bool defaultOpen) {
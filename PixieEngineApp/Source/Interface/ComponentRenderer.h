@@ -5,7 +5,7 @@ class PixieEngineApp;
 
 class ComponentRenderer {
 public:
-	static void DrawTransform(Transform& transform, bool showHead = true, bool defaultOpen = true);
+	static bool DrawTransform(Transform& transform, bool showHead = true, bool defaultOpen = true);
 	static void DrawMaterial(Material* material, bool showHead = true, bool defaultOpen = false);
 	static void DrawComponent(Component* component, bool showHead = true, bool defaultOpen = true);
 };
\ No newline at end of file
@@ -69,6 +69,24 @@ void AssetsBrowserWindow::Draw() {
 		}
 
 		ImGui::Columns(1);
+
+		for (const std::shared_ptr<ModelImport>& import : ResourceManager::GetModelImports()) {
+			if (import->IsDone()) {
+				continue;
+			}
+			ImGui::PushID(import.get());
+			ImGui::Separator();
+			ImGui::TextUnformatted((import->GetPath().filename().string() + std::string(": ") + to_string(import->GetStage())).c_str());
+			ImGui::ProgressBar((float)import->GetProgress(), ImVec2(-80.0f, 0.0f));
+			ImGui::SameLine();
+			if (import->IsCancelled()) {
+				ImGui::TextDisabled("Cancelling");
+			}
+			else if (ImGui::Button("Cancel")) {
+				import->Cancel();
+			}
+			ImGui::PopID();
+		}
 	}
 	ImGui::End();
 }
@@ -13,7 +13,9 @@ void InspectorWindow::Draw() {
 			ImGui::Text(object->GetName().c_str());
 			ImGui::Spacing();
 
-			ComponentRenderer::DrawTransform(object->GetTransform());
+			if (ComponentRenderer::DrawTransform(object->GetTransform())) {
+				SceneManager::UpdateSceneSnapshot();
+			}
 			ImGui::Spacing();
 
 			const std::vector<Component*>& components = object->GetComponents();
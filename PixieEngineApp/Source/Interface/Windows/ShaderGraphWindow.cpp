@@ -120,6 +120,7 @@ void ShaderGraphWindow::Draw() {
 		Camera camera = Camera(Vec3(-10, 0, 0), Vec3(0, 0, 0), Vec3(0, 1, 0), glm::radians(39.6f), { 1280, 720 }, 0, 100);
 
 		HighPrecisionTimer::StartTimer("Shader Graph Frame Time");
+		scene->UpdateTransforms();
 		m_shaderGraph.Process(*scene.get(), camera);
 		HighPrecisionTimer::StopTimer("Shader Graph Frame Time");
 
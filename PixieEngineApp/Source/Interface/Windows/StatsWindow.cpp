@@ -13,6 +13,22 @@ void StatsWindow::Draw() {
 		std::string texturesText = std::string("Active Textures: ") + std::to_string(Texture::GetActiveTexturesCount());
 		ImGui::Text(texturesText.c_str());
 
+		std::shared_ptr<SceneSnapshot> sceneSnapshot = SceneManager::GetSceneSnapshot();
+		if (sceneSnapshot) {
+			const BVHBuildStats& bvhStats = sceneSnapshot->GetBVHBuildStats();
+			ImGui::Text((std::string("BVH Build Time: ") + std::to_string(bvhStats.buildTime) + " ms").c_str());
+			ImGui::Text((std::string("BVH SAH Cost: ") + std::to_string(bvhStats.sahCost)).c_str());
+			ImGui::Text((std::string("BVH Nodes: ") + std::to_string(bvhStats.nodesCount)).c_str());
+			ImGui::Text((std::string("Reused Mesh BVHs: ") + std::to_string(sceneSnapshot->GetReusedMeshBVHsCount())).c_str());
+		}
+
+		std::shared_ptr<Scene> scene = SceneManager::GetScene();
+		if (scene) {
+			const TransformHierarchy& transforms = scene->GetTransformHierarchy();
+			ImGui::Text((std::string("Transform Hierarchy: ") + std::to_string(transforms.GetObjectsCount()) + " objects, " + std::to_string(transforms.GetLevelsCount()) + " levels").c_str());
+			ImGui::Text((std::string("Updated Transforms: ") + std::to_string(transforms.GetUpdatedCount())).c_str());
+		}
+
 		for (size_t i = 0; i < HighPrecisionTimer::s_timers.size(); i++) {
 			double milli = (double)HighPrecisionTimer::s_timers[i].m_lastDelta.count() / 1000000.0f;
 			ImGui::Text((HighPrecisionTimer::s_timers[i].m_name + std::string(": ") + std::to_string(milli)).c_str());
@@ -55,6 +55,112 @@ void ViewportSettingsWindow::Draw() {
 				if (ImGui::InputInt("Max Render Threads", &maxRenderThreads)) {
 					viewport->m_pathTracingRenderer.SetMaxRenderThreads(Clamp(maxRenderThreads, 1, 128));
 				}
+
+				BVHLayout activeBVHLayout = viewport->m_pathTracingRenderer.GetBVHLayout();
+				if (ImGui::BeginCombo("BVH Layout", to_string(activeBVHLayout).c_str())) {
+					for (int32_t n = 0; n < (int32_t)BVHLayout::COUNT; n++) {
+						BVHLayout layout = BVHLayout(n);
+						bool isSelected = (activeBVHLayout == layout);
+						if (ImGui::Selectable(to_string(layout).c_str(), isSelected)) {
+							viewport->m_pathTracingRenderer.SetBVHLayout(layout);
+						}
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				IntegratorMode activeIntegratorMode = viewport->m_pathTracingRenderer.GetIntegratorMode();
+				if (ImGui::BeginCombo("Integrator", to_string(activeIntegratorMode).c_str())) {
+					for (int32_t n = 0; n < (int32_t)IntegratorMode::COUNT; n++) {
+						IntegratorMode mode = IntegratorMode(n);
+						bool isSelected = (activeIntegratorMode == mode);
+						if (ImGui::Selectable(to_string(mode).c_str(), isSelected)) {
+							viewport->m_pathTracingRenderer.SetIntegratorMode(mode);
+						}
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				LightSamplerType activeLightSamplerType = viewport->m_pathTracingRenderer.GetLightSamplerType();
+				if (ImGui::BeginCombo("Light Sampler", to_string(activeLightSamplerType).c_str())) {
+					for (int32_t n = 0; n < (int32_t)LightSamplerType::COUNT; n++) {
+						LightSamplerType type = LightSamplerType(n);
+						bool isSelected = (activeLightSamplerType == type);
+						if (ImGui::Selectable(to_string(type).c_str(), isSelected)) {
+							viewport->m_pathTracingRenderer.SetLightSamplerType(type);
+						}
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				SamplerType activeSamplerType = viewport->m_pathTracingRenderer.GetSamplerType();
+				if (ImGui::BeginCombo("Sampler", to_string(activeSamplerType).c_str())) {
+					for (int32_t n = 0; n < (int32_t)SamplerType::COUNT; n++) {
+						SamplerType type = SamplerType(n);
+						bool isSelected = (activeSamplerType == type);
+						if (ImGui::Selectable(to_string(type).c_str(), isSelected)) {
+							viewport->m_pathTracingRenderer.SetSamplerType(type);
+						}
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				BVHBuildMethod activeBuildMethod = SceneManager::GetBVHBuildMethod();
+				if (ImGui::BeginCombo("BVH Build Method", to_string(activeBuildMethod).c_str())) {
+					for (int32_t n = 0; n < (int32_t)BVHBuildMethod::COUNT; n++) {
+						BVHBuildMethod method = BVHBuildMethod(n);
+						bool isSelected = (activeBuildMethod == method);
+						if (ImGui::Selectable(to_string(method).c_str(), isSelected)) {
+							SceneManager::SetBVHBuildMethod(method);
+						}
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				bool splatSamples = viewport->m_pathTracingRenderer.GetSplatSamples();
+				if (ImGui::Checkbox("Splat Samples", &splatSamples)) {
+					viewport->m_pathTracingRenderer.SetSplatSamples(splatSamples);
+				}
+
+				bool denoise = viewport->m_pathTracingRenderer.GetDenoise();
+				if (ImGui::Checkbox("Denoise", &denoise)) {
+					viewport->m_pathTracingRenderer.SetDenoise(denoise);
+				}
+				if (denoise) {
+					int32_t denoiseInterval = viewport->m_pathTracingRenderer.GetDenoiseInterval();
+					if (ImGui::InputInt("Denoise Interval", &denoiseInterval)) {
+						viewport->m_pathTracingRenderer.SetDenoiseInterval(Clamp(denoiseInterval, 1, 1024));
+					}
+				}
+
+				bool adaptiveSampling = viewport->m_pathTracingRenderer.GetAdaptiveSampling();
+				if (ImGui::Checkbox("Adaptive Sampling", &adaptiveSampling)) {
+					viewport->m_pathTracingRenderer.SetAdaptiveSampling(adaptiveSampling);
+				}
+				if (adaptiveSampling) {
+					float pixelErrorThreshold = (float)viewport->m_pathTracingRenderer.GetPixelErrorThreshold();
+					if (ImGui::DragFloat("Pixel Error Threshold", &pixelErrorThreshold, 0.0005f, 0.0f, 1.0f, "%.4f")) {
+						viewport->m_pathTracingRenderer.SetPixelErrorThreshold(pixelErrorThreshold);
+					}
+					float errorTarget = (float)viewport->m_pathTracingRenderer.GetErrorTarget();
+					if (ImGui::DragFloat("Error Target", &errorTarget, 0.0001f, 0.0f, 1.0f, "%.4f")) {
+						viewport->m_pathTracingRenderer.SetErrorTarget(errorTarget);
+					}
+				}
 				ImGui::Spacing();
 				
 				std::string samplesText = std::string("Samples: ") + std::to_string(viewport->m_pathTracingRenderer.GetSamplesCount());
@@ -65,6 +171,61 @@ void ViewportSettingsWindow::Draw() {
 				
 				std::string lastSampleTimeText = std::string("Last Sample Time: ") + std::to_string(viewport->m_pathTracingRenderer.GetLastSampleTime());
 				ImGui::Text(lastSampleTimeText.c_str());
+
+				std::string activePixelsText = std::string("Active Pixels: ") + std::to_string(viewport->m_pathTracingRenderer.GetActivePixelsCount());
+				ImGui::Text(activePixelsText.c_str());
+
+				std::string errorText = std::string("Error: ") + std::to_string(viewport->m_pathTracingRenderer.GetError());
+				ImGui::Text(errorText.c_str());
+
+				if (viewport->m_pathTracingRenderer.GetDenoise()) {
+					std::string denoiseTimeText = std::string("Denoise Time: ") + std::to_string(viewport->m_pathTracingRenderer.GetLastDenoiseTime());
+					ImGui::Text(denoiseTimeText.c_str());
+				}
+
+				std::string tileSizeText = std::string("Tile Size: ") + std::to_string(viewport->m_pathTracingRenderer.GetTileSize());
+				ImGui::Text(tileSizeText.c_str());
+
+				if (ImGui::TreeNode("AOVs")) {
+					for (int32_t n = 0; n < (int32_t)AOVType::COUNT; n++) {
+						AOVType type = AOVType(n);
+						bool isEnabled = viewport->m_pathTracingRenderer.IsAOVEnabled(type);
+						if (ImGui::Checkbox(to_string(type).c_str(), &isEnabled)) {
+							viewport->m_pathTracingRenderer.SetAOVEnabled(type, isEnabled);
+						}
+					}
+					if (ImGui::Button("Save render.exr")) {
+						viewport->m_pathTracingRenderer.SaveRender("render.exr");
+					}
+					ImGui::TreePop();
+				}
+
+				if (ImGui::TreeNode("Texture Cache")) {
+					int32_t budget = (int32_t)(TextureCache::GetBudget() / (1024 * 1024));
+					if (ImGui::InputInt("Budget (MB)", &budget)) {
+						TextureCache::SetBudget((size_t)std::max(budget, 1) * 1024 * 1024);
+					}
+					TextureCacheStats cacheStats = TextureCache::GetStats();
+					std::string texturesText = std::string("Textures: ") + std::to_string(cacheStats.residentTexturesCount) + " / " + std::to_string(cacheStats.texturesCount) + " resident, " +
+						std::to_string(cacheStats.residentBytes / (1024 * 1024)) + " MB";
+					ImGui::Text(texturesText.c_str());
+					std::string lookupsText = std::string("Hits: ") + std::to_string(cacheStats.hits) + ", misses: " + std::to_string(cacheStats.misses) + ", evictions: " + std::to_string(cacheStats.evictions);
+					ImGui::Text(lookupsText.c_str());
+					if (ImGui::Button("Reset Statistics")) {
+						TextureCache::ResetStats();
+					}
+					ImGui::TreePop();
+				}
+
+				if (ImGui::TreeNode("Render Threads")) {
+					std::vector<RenderThreadStats> threadStats = viewport->m_pathTracingRenderer.GetThreadStats();
+					for (size_t i = 0; i < threadStats.size(); i++) {
+						std::string threadText = std::string("Thread ") + std::to_string(i) + ": " + std::to_string((int32_t)(threadStats[i].GetUtilization() * 100.0f)) + "% busy, " +
+							std::to_string(threadStats[i].tilesRendered) + " tiles, " + std::to_string(threadStats[i].tilesStolen) + " stolen";
+						ImGui::Text(threadText.c_str());
+					}
+					ImGui::TreePop();
+				}
 			}
 
 			if (activeRenderMode == RenderMode::Forward || activeRenderMode == RenderMode::Deffered) {
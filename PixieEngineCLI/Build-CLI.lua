@@ -0,0 +1,54 @@
+project "PixieEngineCLI"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++20"
+   targetdir "Build/%{cfg.buildcfg}"
+   staticruntime "off"
+
+   pchheader "pch.h"
+   pchsource "Source/pch.cpp"
+
+   files 
+   { 
+      "Source/**.h", 
+      "Source/**.cpp"
+   }
+
+   includedirs
+   {
+      "Source",
+      "../PixieEngineCore/Source",
+      "../Dependencies/glad/include",
+      "../Dependencies",
+      "../Dependencies/stb",
+      "../Dependencies/freetype/include",
+   }
+
+   links
+   {
+      "PixieEngineCore"
+   }
+
+   targetdir ("../Build/" .. OutputDir .. "/%{prj.name}")
+   objdir ("../Build/Intermediates/" .. OutputDir .. "/%{prj.name}")
+
+   filter "system:windows"
+       systemversion "latest"
+       defines { "WINDOWS" }
+
+   filter "configurations:Debug"
+       defines { "DEBUG" }
+       runtime "Debug"
+       symbols "On"
+
+   filter "configurations:Release"
+       defines { "RELEASE" }
+       runtime "Release"
+       optimize "On"
+       symbols "On"
+
+   filter "configurations:Dist"
+       defines { "DIST" }
+       runtime "Release"
+       optimize "On"
+       symbols "Off"
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "BatchRenderer.h"
+
+BatchRenderer::BatchRenderer(SceneSnapshot* sceneSnapshot, const Camera& camera, LightSamplerType lightSamplerType) :
+	m_sceneSnapshot(sceneSnapshot), m_camera(camera), m_film(camera.GetResolution()), m_aovs(camera.GetResolution()) {
+	m_rayTracer.SetSceneSnapshot(m_sceneSnapshot, lightSamplerType);
+	GenerateTiles();
+}
+
+void BatchRenderer::SetSplatSamples(bool splatSamples) {
+	m_film.m_splatSamples = splatSamples;
+}
+
+void BatchRenderer::SetAOVEnabled(AOVType type, bool enabled) {
+	m_aovs.SetEnabled(type, enabled);
+}
+
+void BatchRenderer::Render(int32_t samplesPerPixel, int32_t threadsCount, IntegratorMode integratorMode, SamplerType samplerType) {
+	m_film.Reset();
+	m_aovs.Reset();
+	m_nextTile = 0;
+	m_finishedTiles = 0;
+	m_boxChecks = 0;
+	m_shapeChecks = 0;
+	threadsCount = Clamp(threadsCount, 1, (int32_t)m_tiles.size());
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	for (int32_t i = 0; i < threadsCount; i++) {
+		threads.emplace_back([this, samplesPerPixel, integratorMode, samplerType]() {
+			std::unique_ptr<Sampler> sampler(CreateSampler(samplerType, samplesPerPixel, m_film.m_resolution));
+			std::vector<std::shared_ptr<Sampler>> tileSamplers;
+			FilmTile filmTile;
+			int32_t index;
+			while ((index = m_nextTile++) < (int32_t)m_tiles.size()) {
+				m_film.StartTile(filmTile, m_tiles[index]);
+				if (integratorMode == IntegratorMode::Wavefront) {
+					RenderTileWavefront(m_tiles[index], sampler.get(), tileSamplers, samplesPerPixel, filmTile);
+				}
+				else {
+					RenderTile(m_tiles[index], sampler.get(), samplesPerPixel, filmTile);
+				}
+				m_film.MergeTile(filmTile);
+				int32_t finished = ++m_finishedTiles;
+				if (finished % 64 == 0 || finished == (int32_t)m_tiles.size()) {
+					std::cout << "\rTiles: " << finished << "/" << m_tiles.size() << std::flush;
+				}
+			}
+			});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	std::cout << "\n";
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	m_renderTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000000.0f;
+	m_samplesCount = (uint64_t)m_film.m_resolution.x * m_film.m_resolution.y * samplesPerPixel;
+}
+
+Buffer2D<Vec3> BatchRenderer::GetImage() const {
+	return m_film.GetImage();
+}
+
+std::vector<ImageChannel> BatchRenderer::GetAOVChannels() const {
+	return m_aovs.GetChannels();
+}
+
+Float BatchRenderer::GetRenderTime() const {
+	return m_renderTime;
+}
+
+uint64_t BatchRenderer::GetSamplesCount() const {
+	return m_samplesCount;
+}
+
+uint64_t BatchRenderer::GetBoxChecksCount() const {
+	return m_boxChecks;
+}
+
+uint64_t BatchRenderer::GetShapeChecksCount() const {
+	return m_shapeChecks;
+}
+
+void BatchRenderer::GenerateTiles() {
+	m_tiles.clear();
+	glm::ivec2 resolution = m_film.m_resolution;
+	glm::ivec2 tileGridSize = glm::ceil(Vec2(resolution) / Vec2(m_tileSize));
+	for (int32_t yTile = 0; yTile < tileGridSize.y; yTile++) {
+		for (int32_t xTile = 0; xTile < tileGridSize.x; xTile++) {
+			int32_t xMax = glm::min(resolution.x, (xTile + 1) * m_tileSize.x);
+			int32_t yMax = glm::min(resolution.y, (yTile + 1) * m_tileSize.y);
+			glm::ivec2 min = glm::ivec2(xTile * m_tileSize.x, yTile * m_tileSize.y);
+			glm::ivec2 max = glm::ivec2(xMax, yMax);
+			m_tiles.push_back(Bounds2i(min, max));
+		}
+	}
+}
+
+void BatchRenderer::RenderTile(const Bounds2i& tile, Sampler* sampler, int32_t samplesPerPixel, FilmTile& filmTile) {
+	uint64_t boxChecks = 0, shapeChecks = 0;
+	for (int32_t y = tile.min.y; y < tile.max.y; y++) {
+		for (int32_t x = tile.min.x; x < tile.max.x; x++) {
+			for (int32_t sampleIndex = 0; sampleIndex < samplesPerPixel; sampleIndex++) {
+				sampler->StartPixelSample(glm::ivec2(x, y), sampleIndex);
+				FilmFilterSample fs = m_film.SampleFilter(sampler->GetPixel2D());
+				Vec2 pFilm = Vec2(x, y) + fs.p + Vec2(0.5f, 0.5f);
+				Ray ray = m_camera.GetRay(m_film.GetUV(pFilm));
+				GBufferPixel pixel = m_rayTracer.SampleLightRay(ray, sampler);
+				m_film.AddSample(filmTile, { x, y }, pFilm, pixel.light, fs.weight, sampleIndex);
+				if (m_aovs.HasEnabled()) {
+					m_aovs.AddSample(x, y, pixel);
+				}
+				boxChecks += pixel.boxChecks;
+				shapeChecks += pixel.shapeChecks;
+			}
+		}
+	}
+	m_boxChecks += boxChecks;
+	m_shapeChecks += shapeChecks;
+}
+
+void BatchRenderer::RenderTileWavefront(const Bounds2i& tile, const Sampler* prototype, std::vector<std::shared_ptr<Sampler>>& samplers, int32_t samplesPerPixel, FilmTile& filmTile) {
+	glm::ivec2 size = tile.Diagonal();
+	int32_t pixelsCount = size.x * size.y;
+	while ((int32_t)samplers.size() < pixelsCount) {
+		samplers.push_back(std::shared_ptr<Sampler>(prototype->Clone()));
+	}
+
+	uint64_t boxChecks = 0, shapeChecks = 0;
+	std::vector<Float> filterWeights(pixelsCount);
+	std::vector<Vec2> filmPositions(pixelsCount);
+	std::vector<Ray> rays;
+	std::vector<Sampler*> raySamplers;
+	std::vector<GBufferPixel> pixels;
+	rays.reserve(pixelsCount);
+	raySamplers.reserve(pixelsCount);
+	for (int32_t sampleIndex = 0; sampleIndex < samplesPerPixel; sampleIndex++) {
+		rays.clear();
+		raySamplers.clear();
+		for (int32_t y = tile.min.y; y < tile.max.y; y++) {
+			for (int32_t x = tile.min.x; x < tile.max.x; x++) {
+				Sampler* sampler = samplers[rays.size()].get();
+				sampler->StartPixelSample(glm::ivec2(x, y), sampleIndex);
+				FilmFilterSample fs = m_film.SampleFilter(sampler->GetPixel2D());
+				filterWeights[rays.size()] = fs.weight;
+				filmPositions[rays.size()] = Vec2(x, y) + fs.p + Vec2(0.5f, 0.5f);
+				rays.push_back(m_camera.GetRay(m_film.GetUV(filmPositions[rays.size()])));
+				raySamplers.push_back(sampler);
+			}
+		}
+		m_rayTracer.SampleLightRays(rays, raySamplers, pixels);
+		for (int32_t i = 0; i < pixelsCount; i++) {
+			glm::ivec2 p(tile.min.x + i % size.x, tile.min.y + i / size.x);
+			m_film.AddSample(filmTile, p, filmPositions[i], pixels[i].light, filterWeights[i], sampleIndex);
+			if (m_aovs.HasEnabled()) {
+				m_aovs.AddSample(p.x, p.y, pixels[i]);
+			}
+			boxChecks += pixels[i].boxChecks;
+			shapeChecks += pixels[i].shapeChecks;
+		}
+	}
+	m_boxChecks += boxChecks;
+	m_shapeChecks += shapeChecks;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "pch.h"
+
+// Offline path tracer without any OpenGL dependencies. Every tile is rendered with all samples in order
+// by a single thread, so the result does not depend on threads count, apart from summation order of splats across tile borders.
+class BatchRenderer {
+public:
+	BatchRenderer(SceneSnapshot* sceneSnapshot, const Camera& camera, LightSamplerType lightSamplerType = LightSamplerType::BVH);
+
+	void SetSplatSamples(bool splatSamples);
+	void SetAOVEnabled(AOVType type, bool enabled);
+	void Render(int32_t samplesPerPixel, int32_t threadsCount, IntegratorMode integratorMode = IntegratorMode::Recursive, SamplerType samplerType = SamplerType::ZSobol);
+	Buffer2D<Vec3> GetImage() const;
+	std::vector<ImageChannel> GetAOVChannels() const;
+	Float GetRenderTime() const;
+	uint64_t GetSamplesCount() const;
+	uint64_t GetBoxChecksCount() const;
+	uint64_t GetShapeChecksCount() const;
+
+protected:
+	const glm::ivec2 m_tileSize = glm::ivec2(32, 32);
+	SceneSnapshot* m_sceneSnapshot;
+	Camera m_camera;
+	VolumetricRayTracer m_rayTracer;
+	Film m_film;
+	AOVBuffer m_aovs;
+	std::vector<Bounds2i> m_tiles;
+	std::atomic<int32_t> m_nextTile = 0;
+	std::atomic<int32_t> m_finishedTiles = 0;
+	Float m_renderTime = 0.0f;
+	uint64_t m_samplesCount = 0;
+	std::atomic<uint64_t> m_boxChecks = 0;
+	std::atomic<uint64_t> m_shapeChecks = 0;
+
+	void GenerateTiles();
+	void RenderTile(const Bounds2i& tile, Sampler* sampler, int32_t samplesPerPixel, FilmTile& filmTile);
+	void RenderTileWavefront(const Bounds2i& tile, const Sampler* prototype, std::vector<std::shared_ptr<Sampler>>& samplers, int32_t samplesPerPixel, FilmTile& filmTile);
+};
@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "BatchRenderer.h"
+
+struct CommandLineOptions {
+	std::filesystem::path scenePath;
+	std::filesystem::path outputPath = "render.exr";
+	int32_t samplesPerPixel = 64;
+	int32_t threadsCount = (int32_t)std::max(1u, std::thread::hardware_concurrency());
+	glm::ivec2 resolution = { 0, 0 };
+	BVHLayout bvhLayout = BVHLayout::Binary;
+	BVHBuildMethod bvhBuildMethod = BVHBuildMethod::SAH;
+	IntegratorMode integratorMode = IntegratorMode::Recursive;
+	LightSamplerType lightSamplerType = LightSamplerType::BVH;
+	SamplerType samplerType = SamplerType::ZSobol;
+	bool splatSamples = false;
+	std::vector<AOVType> aovs;
+	int32_t textureBudget = 0; // megabytes, 0 keeps default
+};
+
+void PrintUsage() {
+	std::cout << "Usage: PixieEngineCLI <scene.pbrt> [options]\n";
+	std::cout << "  --spp <count>           samples per pixel (default 64)\n";
+	std::cout << "  --threads <count>       render threads (default hardware concurrency)\n";
+	std::cout << "  --resolution <W>x<H>    override camera resolution\n";
+	std::cout << "  --bvh <layout>          binary, bvh4 or bvh8 (default binary)\n";
+	std::cout << "  --bvh-build <method>    sah or lbvh (default sah)\n";
+	std::cout << "  --integrator <mode>     recursive or wavefront (default recursive)\n";
+	std::cout << "  --light-sampler <type>  uniform, power or bvh (default bvh)\n";
+	std::cout << "  --sampler <type>        independent, stratified, sobol or zsobol (default zsobol)\n";
+	std::cout << "  --splat                 splat samples over filter radius instead of filter importance sampling\n";
+	std::cout << "  --aov <list>            comma separated AOV layers written to exr output: albedo, normal, position,\n";
+	std::cout << "                          uv, depth, boxChecks, shapeChecks or all\n";
+	std::cout << "  --texture-budget <MB>   memory budget of decoded textures (default 512)\n";
+	std::cout << "  --output <file>         output image, .exr, .pfm or .png (default render.exr)\n";
+}
+
+bool ParseCommandLine(int32_t argc, char** argv, CommandLineOptions& options) {
+	for (int32_t i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--spp" && hasValue) {
+			options.samplesPerPixel = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--threads" && hasValue) {
+			options.threadsCount = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--resolution" && hasValue) {
+			if (std::sscanf(argv[++i], "%dx%d", &options.resolution.x, &options.resolution.y) != 2 || options.resolution.x <= 0 || options.resolution.y <= 0) {
+				std::cout << "Error: Invalid resolution: " << argv[i] << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--bvh" && hasValue) {
+			std::string layout = argv[++i];
+			if (layout == "binary") options.bvhLayout = BVHLayout::Binary;
+			else if (layout == "bvh4") options.bvhLayout = BVHLayout::Wide4;
+			else if (layout == "bvh8") options.bvhLayout = BVHLayout::Wide8;
+			else {
+				std::cout << "Error: Unknown BVH layout: " << layout << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--bvh-build" && hasValue) {
+			std::string method = argv[++i];
+			if (method == "sah") options.bvhBuildMethod = BVHBuildMethod::SAH;
+			else if (method == "lbvh") options.bvhBuildMethod = BVHBuildMethod::LBVH;
+			else {
+				std::cout << "Error: Unknown BVH build method: " << method << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--integrator" && hasValue) {
+			std::string mode = argv[++i];
+			if (mode == "recursive") options.integratorMode = IntegratorMode::Recursive;
+			else if (mode == "wavefront") options.integratorMode = IntegratorMode::Wavefront;
+			else {
+				std::cout << "Error: Unknown integrator mode: " << mode << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--light-sampler" && hasValue) {
+			std::string type = argv[++i];
+			if (type == "uniform") options.lightSamplerType = LightSamplerType::Uniform;
+			else if (type == "power") options.lightSamplerType = LightSamplerType::Power;
+			else if (type == "bvh") options.lightSamplerType = LightSamplerType::BVH;
+			else {
+				std::cout << "Error: Unknown light sampler: " << type << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--sampler" && hasValue) {
+			std::string type = argv[++i];
+			if (type == "independent") options.samplerType = SamplerType::Independent;
+			else if (type == "stratified") options.samplerType = SamplerType::Stratified;
+			else if (type == "sobol") options.samplerType = SamplerType::PaddedSobol;
+			else if (type == "zsobol") options.samplerType = SamplerType::ZSobol;
+			else {
+				std::cout << "Error: Unknown sampler: " << type << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--splat") {
+			options.splatSamples = true;
+		}
+		else if (arg == "--aov" && hasValue) {
+			std::stringstream list(argv[++i]);
+			std::string name;
+			while (std::getline(list, name, ',')) {
+				bool found = false;
+				for (int32_t n = 0; n < (int32_t)AOVType::COUNT; n++) {
+					if (name == "all" || name == GetAOVLayerName(AOVType(n))) {
+						options.aovs.push_back(AOVType(n));
+						found = true;
+					}
+				}
+				if (!found) {
+					std::cout << "Error: Unknown AOV: " << name << "\n";
+					return false;
+				}
+			}
+		}
+		else if (arg == "--texture-budget" && hasValue) {
+			options.textureBudget = std::atoi(argv[++i]);
+			if (options.textureBudget <= 0) {
+				std::cout << "Error: Invalid texture budget: " << argv[i] << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--output" && hasValue) {
+			options.outputPath = argv[++i];
+		}
+		else if (arg.starts_with("--")) {
+			std::cout << "Error: Unknown option: " << arg << "\n";
+			return false;
+		}
+		else {
+			options.scenePath = arg;
+		}
+	}
+	if (options.scenePath.empty()) {
+		return false;
+	}
+	if (!ImageWriter::IsSupportedFormat(options.outputPath)) {
+		std::cout << "Error: Unsupported output format: " << options.outputPath << "\n";
+		return false;
+	}
+	if (!options.aovs.empty() && options.outputPath.extension() != ".exr") {
+		std::cout << "Error: AOVs require multi-layer exr output\n";
+		return false;
+	}
+	return true;
+}
+
+Camera GetRenderCamera(SceneSnapshot& snapshot, glm::ivec2 resolution) {
+	if (!snapshot.GetCameras().empty()) {
+		Camera camera = snapshot.GetCameras()[0];
+		if (resolution.x > 0) camera.SetResolution(resolution);
+		return camera;
+	}
+	if (resolution.x <= 0) resolution = { 1280, 720 };
+	Vec3 center;
+	Float radius;
+	snapshot.GetBounds().BoundingSphere(&center, &radius);
+	Float fovy = glm::radians(39.6f);
+	Vec3 lookFrom = center + Vec3(0.0f, 0.0f, radius / std::sin(fovy / 2.0f));
+	return Camera(lookFrom, center, Vec3(0, 1, 0), fovy, resolution, 0, 10);
+}
+
+std::chrono::high_resolution_clock::time_point PrintElapsed(const std::string& name, std::chrono::high_resolution_clock::time_point start) {
+	auto now = std::chrono::high_resolution_clock::now();
+	std::cout << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() << " ms\n";
+	return now;
+}
+
+int32_t main(int32_t argc, char** argv) {
+	CommandLineOptions options;
+	if (!ParseCommandLine(argc, argv, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	ResourceManager::SetApplicationPath(argv[0]);
+	ResourceManager::Initialize();
+	if (options.textureBudget > 0) {
+		TextureCache::SetBudget((size_t)options.textureBudget * 1024 * 1024);
+	}
+
+	// Scene cache stores mesh BVHs built with this method, so the snapshot can reuse them.
+	SceneManager::SetBVHBuildMethod(options.bvhBuildMethod);
+
+	auto time = std::chrono::high_resolution_clock::now();
+	std::shared_ptr<Scene> scene = ResourceManager::LoadScene(options.scenePath);
+	if (!scene) {
+		std::cout << "Error: Failed to load scene: " << options.scenePath << "\n";
+		return 1;
+	}
+	// Skybox is loaded in background, batch renders need the HDR environment rather than the placeholder.
+	scene->WaitForSkybox();
+	time = PrintElapsed("Scene loading", time);
+
+	SceneSnapshot snapshot(scene.get(), options.bvhBuildMethod);
+	snapshot.SetBVHLayout(options.bvhLayout);
+	time = PrintElapsed("Scene snapshot", time);
+	const BVHBuildStats& bvhStats = snapshot.GetBVHBuildStats();
+	std::cout << "BVH build (" << to_string(options.bvhBuildMethod) << "): " << bvhStats.buildTime << " ms, SAH cost: " << bvhStats.sahCost << "\n";
+	std::cout << "Triangles: " << snapshot.GetTrianglesCount() << ", mesh instances: " << snapshot.GetMeshInstancesCount() << ", BVH nodes: " << snapshot.GetNodesCount() << ", BVH layout: " << to_string(options.bvhLayout) << "\n";
+
+	Camera camera = GetRenderCamera(snapshot, options.resolution);
+	glm::ivec2 resolution = camera.GetResolution();
+	std::cout << "Rendering " << resolution.x << "x" << resolution.y << " at " << options.samplesPerPixel << " spp on " << options.threadsCount << " threads, " << to_string(options.integratorMode) << " integrator, " << to_string(options.lightSamplerType) << " light sampler, " << to_string(options.samplerType) << " sampler\n";
+
+	BatchRenderer renderer(&snapshot, camera, options.lightSamplerType);
+	renderer.SetSplatSamples(options.splatSamples);
+	for (AOVType type : options.aovs) {
+		renderer.SetAOVEnabled(type, true);
+	}
+	renderer.Render(options.samplesPerPixel, options.threadsCount, options.integratorMode, options.samplerType);
+	time = std::chrono::high_resolution_clock::now();
+	std::cout << "Rendering: " << (int64_t)(renderer.GetRenderTime() * 1000.0f) << " ms, ";
+	std::cout << (uint64_t)(renderer.GetSamplesCount() / std::max(renderer.GetRenderTime(), 1e-6f)) << " samples/sec\n";
+	std::cout << "Box checks: " << renderer.GetBoxChecksCount() << ", shape checks: " << renderer.GetShapeChecksCount() << "\n";
+	TextureCacheStats cacheStats = TextureCache::GetStats();
+	if (cacheStats.texturesCount > 0) {
+		std::cout << "Textures: " << cacheStats.texturesCount << ", resident: " << cacheStats.residentBytes / (1024 * 1024) << " MB, hits: " << cacheStats.hits << ", misses: " << cacheStats.misses << ", evictions: " << cacheStats.evictions << "\n";
+	}
+
+	bool isWritten = options.aovs.empty() ? ImageWriter::Write(options.outputPath, renderer.GetImage()) :
+		ImageWriter::WriteEXR(options.outputPath, renderer.GetImage(), renderer.GetAOVChannels());
+	if (!isWritten) {
+		return 1;
+	}
+	PrintElapsed("Image writing", time);
+	std::cout << "Saved " << options.outputPath << "\n";
+	return 0;
+}
@@ -0,0 +1,3 @@
+#pragma once
+#include "../PixieEngineCore/Source/PixieEngineCore.h"
+#include "Resources/ImageWriter.h"
@@ -137,7 +137,7 @@ void Animator::PlayAnimation(Animation* pAnimation) {
     currentTime = 0.0f;
 }
 
-void Animator::CalculateBoneTransform(SceneObject* node, Mat4 parentTransform) {
+void Animator::CalculateBoneTransform(const SceneObject* node, Mat4 parentTransform) {
     std::string nodeName = node->GetName();
     Mat4 nodeTransform = node->GetTransform().GetMatrix();
 
@@ -163,7 +163,7 @@ void Animator::CalculateBoneTransform(SceneObject* node, Mat4 parentTransform) {
     }
 }
 
-void Animator::CalculateBoneTransform(SceneObject* node, Mat4 parentTransform, std::array<Mat4, MaxBonesPerModel>& transforms) {
+void Animator::CalculateBoneTransform(const SceneObject* node, Mat4 parentTransform, std::array<Mat4, MaxBonesPerModel>& transforms) {
     std::string nodeName = node->GetName();
     Mat4 nodeTransform = node->GetTransform().GetMatrix();
 
@@ -85,6 +85,6 @@ private:
     Float currentTime = 0.0f;
     Float deltaTime = 0.0f;
 
-    void CalculateBoneTransform(SceneObject* node, Mat4 parentTransform);
-    void CalculateBoneTransform(SceneObject* node, Mat4 parentTransform, std::array<Mat4, MaxBonesPerModel>& transforms);
+    void CalculateBoneTransform(const SceneObject* node, Mat4 parentTransform);
+    void CalculateBoneTransform(const SceneObject* node, Mat4 parentTransform, std::array<Mat4, MaxBonesPerModel>& transforms);
 };
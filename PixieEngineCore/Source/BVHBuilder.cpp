@@ -0,0 +1,292 @@
+#include "pch.h"
+#include "BVHBuilder.h"
+#include "Parallel.h"
+
+std::string to_string(BVHBuildMethod method) {
+	switch (method) {
+	case BVHBuildMethod::SAH: return "SAH";
+	case BVHBuildMethod::LBVH: return "LBVH";
+	default: return "Undefined BVH Build Method";
+	}
+}
+
+static uint32_t LeftShift3(uint32_t x) {
+	if (x == (1 << 10)) {
+		x--;
+	}
+	x = (x | (x << 16)) & 0x030000ff;
+	x = (x | (x << 8)) & 0x0300f00f;
+	x = (x | (x << 4)) & 0x030c30c3;
+	x = (x | (x << 2)) & 0x09249249;
+	return x;
+}
+
+static uint32_t EncodeMorton3(Vec3 p) {
+	return (LeftShift3((uint32_t)p.x) << 2) | (LeftShift3((uint32_t)p.y) << 1) | LeftShift3((uint32_t)p.z);
+}
+
+/*
+	BVH Build Stats
+*/
+
+void BVHBuildStats::Add(const BVHBuildStats& other) {
+	buildTime += other.buildTime;
+	sahCost += other.sahCost;
+	nodesCount += other.nodesCount;
+	primitivesCount += other.primitivesCount;
+}
+
+/*
+	BVH Builder
+*/
+
+BVHBuilder::BVHBuilder(BVHBuildMethod method, int32_t leafSize, int32_t maxLeafSize) :
+	m_method(method), m_leafSize(leafSize), m_maxLeafSize(std::max(leafSize, maxLeafSize)) {}
+
+int32_t BVHBuilder::Build(const std::vector<Bounds3f>& bounds, std::vector<BVHNode>& nodes, int32_t primitivesOffset) {
+	auto startTime = std::chrono::steady_clock::now();
+	m_stats = BVHBuildStats();
+	m_bounds = &bounds;
+	int32_t primitivesCount = (int32_t)bounds.size();
+	if (primitivesCount == 0) {
+		return -1;
+	}
+
+	m_primitives.resize(primitivesCount);
+	std::iota(m_primitives.begin(), m_primitives.end(), 0);
+	m_centroids.resize(primitivesCount);
+	ParallelFor(primitivesCount, [&](int32_t start, int32_t end) {
+		for (int32_t i = start; i < end; i++) {
+			m_centroids[i] = bounds[i].Center();
+		}
+		});
+
+	std::unique_ptr<BuildNode> root;
+	if (m_method == BVHBuildMethod::LBVH) {
+		Bounds3f centroidBounds;
+		for (int32_t i = 0; i < primitivesCount; i++) {
+			centroidBounds = Union(centroidBounds, m_centroids[i]);
+		}
+		m_mortonCodes.resize(primitivesCount);
+		ParallelFor(primitivesCount, [&](int32_t start, int32_t end) {
+			for (int32_t i = start; i < end; i++) {
+				m_mortonCodes[i] = EncodeMorton3(centroidBounds.Offset(m_centroids[i]) * (Float)(1 << 10));
+			}
+			});
+		SortMortonCodes();
+		root = BuildLBVHRecursive(0, primitivesCount, 29, 0);
+	}
+	else {
+		root = BuildSAHRecursive(0, primitivesCount, 0);
+	}
+
+	int32_t rootIndex = (int32_t)nodes.size();
+	Flatten(root.get(), nodes, primitivesOffset, root->bounds.Area());
+	m_stats.nodesCount = (int32_t)nodes.size() - rootIndex;
+	m_stats.primitivesCount = primitivesCount;
+	m_stats.buildTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count() / 1000.0f;
+	return rootIndex;
+}
+
+const std::vector<int32_t>& BVHBuilder::GetPrimitivesOrder() const {
+	return m_primitives;
+}
+
+const BVHBuildStats& BVHBuilder::GetStats() const {
+	return m_stats;
+}
+
+std::unique_ptr<BVHBuilder::BuildNode> BVHBuilder::BuildSAHRecursive(int32_t start, int32_t end, int32_t depth) {
+	const std::vector<Bounds3f>& primitiveBounds = *m_bounds;
+	int32_t primitivesCount = end - start;
+
+	Bounds3f bounds, centroidBounds;
+	for (int32_t i = start; i < end; i++) {
+		int32_t primitive = m_primitives[i];
+		bounds = Union(bounds, primitiveBounds[primitive]);
+		centroidBounds = Union(centroidBounds, m_centroids[primitive]);
+	}
+	int32_t axis = centroidBounds.MaxDimension();
+	if (primitivesCount <= m_leafSize) {
+		return CreateLeaf(start, end, bounds, axis);
+	}
+
+	int32_t mid = (start + end) / 2;
+	if (centroidBounds.max[axis] > centroidBounds.min[axis]) {
+		// Binned SAH, primitives are only partitioned, never sorted.
+		auto getBucket = [&](int32_t primitive) {
+			int32_t b = (int32_t)(c_bucketsCount * centroidBounds.Offset(m_centroids[primitive])[axis]);
+			return std::min(b, c_bucketsCount - 1);
+			};
+
+		std::array<int32_t, c_bucketsCount> bucketCounts{ 0 };
+		std::array<Bounds3f, c_bucketsCount> bucketBounds;
+		for (int32_t i = start; i < end; i++) {
+			int32_t b = getBucket(m_primitives[i]);
+			bucketCounts[b]++;
+			bucketBounds[b] = Union(bucketBounds[b], primitiveBounds[m_primitives[i]]);
+		}
+
+		constexpr int32_t splitsCount = c_bucketsCount - 1;
+		std::array<Float, splitsCount> costs{ 0 };
+		int32_t countBelow = 0;
+		Bounds3f boundsBelow;
+		for (int32_t i = 0; i < splitsCount; i++) {
+			boundsBelow = Union(boundsBelow, bucketBounds[i]);
+			countBelow += bucketCounts[i];
+			costs[i] += countBelow * (countBelow > 0 ? boundsBelow.Area() : 0.0f);
+		}
+		int32_t countAbove = 0;
+		Bounds3f boundsAbove;
+		for (int32_t i = splitsCount; i >= 1; i--) {
+			boundsAbove = Union(boundsAbove, bucketBounds[i]);
+			countAbove += bucketCounts[i];
+			costs[i - 1] += countAbove * (countAbove > 0 ? boundsAbove.Area() : 0.0f);
+		}
+
+		int32_t minCostSplitBucket = -1;
+		Float minCost = Infinity;
+		for (int32_t i = 0; i < splitsCount; i++) {
+			if (costs[i] < minCost) {
+				minCost = costs[i];
+				minCostSplitBucket = i;
+			}
+		}
+
+		Float leafCost = (Float)primitivesCount;
+		minCost = c_traversalCost + minCost / bounds.Area();
+		if (minCost > leafCost && primitivesCount <= m_maxLeafSize) {
+			return CreateLeaf(start, end, bounds, axis);
+		}
+
+		auto midIter = std::partition(m_primitives.begin() + start, m_primitives.begin() + end,
+			[&](int32_t primitive) {
+				return getBucket(primitive) <= minCostSplitBucket;
+			});
+		mid = (int32_t)(midIter - m_primitives.begin());
+		if (mid == start || mid == end) {
+			mid = (start + end) / 2;
+		}
+	}
+	else if (primitivesCount <= m_maxLeafSize) {
+		// All centroids are in the same point, splitting will not help.
+		return CreateLeaf(start, end, bounds, axis);
+	}
+
+	std::unique_ptr<BuildNode> node = std::make_unique<BuildNode>();
+	node->bounds = bounds;
+	node->axis = axis;
+	if (IsParallel(primitivesCount, depth)) {
+		std::future<std::unique_ptr<BuildNode>> firstChild = std::async(std::launch::async, [this, start, mid, depth]() {
+			return BuildSAHRecursive(start, mid, depth + 1);
+			});
+		node->children[1] = BuildSAHRecursive(mid, end, depth + 1);
+		node->children[0] = firstChild.get();
+	}
+	else {
+		node->children[0] = BuildSAHRecursive(start, mid, depth + 1);
+		node->children[1] = BuildSAHRecursive(mid, end, depth + 1);
+	}
+	return node;
+}
+
+std::unique_ptr<BVHBuilder::BuildNode> BVHBuilder::BuildLBVHRecursive(int32_t start, int32_t end, int32_t bit, int32_t depth) {
+	int32_t primitivesCount = end - start;
+	if (primitivesCount <= m_leafSize || (bit < 0 && primitivesCount <= m_maxLeafSize)) {
+		Bounds3f bounds;
+		for (int32_t i = start; i < end; i++) {
+			bounds = Union(bounds, (*m_bounds)[m_primitives[i]]);
+		}
+		return CreateLeaf(start, end, bounds, 0);
+	}
+
+	int32_t mid = (start + end) / 2;
+	int32_t axis = 0;
+	if (bit >= 0) {
+		uint32_t mask = 1u << bit;
+		if ((m_mortonCodes[start] & mask) == (m_mortonCodes[end - 1] & mask)) {
+			return BuildLBVHRecursive(start, end, bit - 1, depth);
+		}
+		// Codes share all higher bits, so the first code with this bit set splits the range.
+		mid = (int32_t)(std::partition_point(m_mortonCodes.begin() + start, m_mortonCodes.begin() + end,
+			[mask](uint32_t code) { return (code & mask) == 0; }) - m_mortonCodes.begin());
+		axis = 2 - bit % 3;
+	}
+
+	std::unique_ptr<BuildNode> node = std::make_unique<BuildNode>();
+	node->axis = axis;
+	if (IsParallel(primitivesCount, depth)) {
+		std::future<std::unique_ptr<BuildNode>> firstChild = std::async(std::launch::async, [this, start, mid, bit, depth]() {
+			return BuildLBVHRecursive(start, mid, bit - 1, depth + 1);
+			});
+		node->children[1] = BuildLBVHRecursive(mid, end, bit - 1, depth + 1);
+		node->children[0] = firstChild.get();
+	}
+	else {
+		node->children[0] = BuildLBVHRecursive(start, mid, bit - 1, depth + 1);
+		node->children[1] = BuildLBVHRecursive(mid, end, bit - 1, depth + 1);
+	}
+	node->bounds = Union(node->children[0]->bounds, node->children[1]->bounds);
+	return node;
+}
+
+std::unique_ptr<BVHBuilder::BuildNode> BVHBuilder::CreateLeaf(int32_t start, int32_t end, const Bounds3f& bounds, int32_t axis) {
+	std::unique_ptr<BuildNode> node = std::make_unique<BuildNode>();
+	node->bounds = bounds;
+	node->firstPrimitive = start;
+	node->primitivesCount = end - start;
+	node->axis = axis;
+	return node;
+}
+
+void BVHBuilder::SortMortonCodes() {
+	// LSD radix sort of 30 bit codes in 3 passes, moving primitive indices along with codes.
+	constexpr int32_t bitsPerPass = 10;
+	constexpr int32_t bucketsCount = 1 << bitsPerPass;
+	int32_t primitivesCount = (int32_t)m_primitives.size();
+	std::vector<uint32_t> codes(primitivesCount);
+	std::vector<int32_t> primitives(primitivesCount);
+	for (int32_t pass = 0; pass < 3; pass++) {
+		int32_t shift = pass * bitsPerPass;
+		std::vector<int32_t> offsets(bucketsCount, 0);
+		for (int32_t i = 0; i < primitivesCount; i++) {
+			offsets[(m_mortonCodes[i] >> shift) & (bucketsCount - 1)]++;
+		}
+		int32_t sum = 0;
+		for (int32_t b = 0; b < bucketsCount; b++) {
+			int32_t count = offsets[b];
+			offsets[b] = sum;
+			sum += count;
+		}
+		for (int32_t i = 0; i < primitivesCount; i++) {
+			int32_t b = (m_mortonCodes[i] >> shift) & (bucketsCount - 1);
+			codes[offsets[b]] = m_mortonCodes[i];
+			primitives[offsets[b]] = m_primitives[i];
+			offsets[b]++;
+		}
+		std::swap(codes, m_mortonCodes);
+		std::swap(primitives, m_primitives);
+	}
+}
+
+int32_t BVHBuilder::Flatten(const BuildNode* node, std::vector<BVHNode>& nodes, int32_t primitivesOffset, Float rootArea) {
+	int32_t nodeIndex = (int32_t)nodes.size();
+	Float areaRatio = rootArea > 0.0f ? node->bounds.Area() / rootArea : 1.0f;
+	if (node->primitivesCount > 0) {
+		nodes.push_back(BVHNode(primitivesOffset + node->firstPrimitive, (int16_t)node->primitivesCount, (int8_t)node->axis));
+		nodes.back().pMin = node->bounds.min;
+		nodes.back().pMax = node->bounds.max;
+		m_stats.sahCost += areaRatio * node->primitivesCount;
+		return nodeIndex;
+	}
+	nodes.push_back(BVHNode(node->bounds.min, node->bounds.max, (int8_t)node->axis));
+	m_stats.sahCost += areaRatio * c_traversalCost;
+	Flatten(node->children[0].get(), nodes, primitivesOffset, rootArea);
+	nodes[nodeIndex].childOffset = Flatten(node->children[1].get(), nodes, primitivesOffset, rootArea);
+	return nodeIndex;
+}
+
+bool BVHBuilder::IsParallel(int32_t primitivesCount, int32_t depth) const {
+	static const int32_t maxParallelDepth = (int32_t)std::ceil(std::log2(std::max(1u, std::thread::hardware_concurrency()))) + 1;
+	return primitivesCount >= c_parallelBuildThreshold && depth < maxParallelDepth;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "pch.h"
+#include "BVHNode.h"
+#include "Math/Bounds.h"
+
+enum class BVHBuildMethod : int32_t {
+	SAH = 0,
+	LBVH,
+	COUNT
+};
+
+std::string to_string(BVHBuildMethod method);
+
+struct BVHBuildStats {
+	Float buildTime = 0.0f; // milliseconds
+	Float sahCost = 0.0f; // relative to root bounds, traversal step costs half of primitive test
+	int32_t nodesCount = 0;
+	int32_t primitivesCount = 0;
+
+	void Add(const BVHBuildStats& other);
+};
+
+// Builds BVHNode hierarchy over primitive bounds. Subtrees of large ranges are built on separate threads.
+// Nodes are appended in depth first order: first child follows its parent, second child index is stored in childOffset.
+// Leaf childOffset is primitivesOffset + position in GetPrimitivesOrder().
+class BVHBuilder {
+public:
+	BVHBuilder(BVHBuildMethod method, int32_t leafSize = 4, int32_t maxLeafSize = 255);
+
+	int32_t Build(const std::vector<Bounds3f>& bounds, std::vector<BVHNode>& nodes, int32_t primitivesOffset = 0);
+	const std::vector<int32_t>& GetPrimitivesOrder() const;
+	const BVHBuildStats& GetStats() const;
+
+protected:
+	struct BuildNode {
+		Bounds3f bounds;
+		std::unique_ptr<BuildNode> children[2];
+		int32_t firstPrimitive = 0;
+		int32_t primitivesCount = 0;
+		int32_t axis = 0;
+	};
+
+	static constexpr int32_t c_bucketsCount = 12;
+	static constexpr int32_t c_parallelBuildThreshold = 16 * 1024;
+	static constexpr Float c_traversalCost = 0.5f;
+
+	BVHBuildMethod m_method;
+	int32_t m_leafSize;
+	int32_t m_maxLeafSize;
+	const std::vector<Bounds3f>* m_bounds = nullptr;
+	std::vector<Vec3> m_centroids;
+	std::vector<int32_t> m_primitives;
+	std::vector<uint32_t> m_mortonCodes;
+	BVHBuildStats m_stats;
+
+	std::unique_ptr<BuildNode> BuildSAHRecursive(int32_t start, int32_t end, int32_t depth);
+	std::unique_ptr<BuildNode> BuildLBVHRecursive(int32_t start, int32_t end, int32_t bit, int32_t depth);
+	std::unique_ptr<BuildNode> CreateLeaf(int32_t start, int32_t end, const Bounds3f& bounds, int32_t axis);
+	void SortMortonCodes();
+	int32_t Flatten(const BuildNode* node, std::vector<BVHNode>& nodes, int32_t primitivesOffset, Float rootArea);
+	bool IsParallel(int32_t primitivesCount, int32_t depth) const;
+};
@@ -42,7 +42,7 @@ struct BVHNode {
 	BVHNode(Vec3 pMin, Vec3 pMax, int8_t axis) :
 		pMin(pMin), pMax(pMax), axis(axis) {}
 
-    bool IsIntersected(const Ray& ray, Float maxDistance, Float* tHit0 = nullptr, Float* tHit1 = nullptr) {
+    bool IsIntersected(const Ray& ray, Float maxDistance, Float* tHit0 = nullptr, Float* tHit1 = nullptr) const {
         return IsAABBIntersected(ray, pMin, pMax, maxDistance, tHit0, tHit1);
     }
 };
@@ -56,16 +56,15 @@ enum class ObjectType : int32_t {
 constexpr int32_t ObjectBVHNodeChildrenCount = 2;
 
 struct ObjectBVHNode {
-    Transform transform;
     Vec3 pMin;
     Vec3 pMax;
     ObjectType childrenTypes[ObjectBVHNodeChildrenCount] = { ObjectType::Node , ObjectType::Node };
     int32_t childrenIndexes[ObjectBVHNodeChildrenCount] = {-1, -1};
 
-    ObjectBVHNode(Transform transform, Vec3 pMin, Vec3 pMax) :
-        transform(transform), pMin(pMin), pMax(pMax) {}
+    ObjectBVHNode(Vec3 pMin, Vec3 pMax) :
+        pMin(pMin), pMax(pMax) {}
 
-    bool IsIntersected(const Ray& ray, Float maxDistance, Float* tHit0 = nullptr, Float* tHit1 = nullptr) {
+    bool IsIntersected(const Ray& ray, Float maxDistance, Float* tHit0 = nullptr, Float* tHit1 = nullptr) const {
         return IsAABBIntersected(ray, pMin, pMax, maxDistance, tHit0, tHit1);
     }
 };
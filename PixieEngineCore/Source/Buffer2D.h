@@ -39,6 +39,19 @@ public:
 		m_data[y * m_resolution.x + x] = value;
 	}
 
+	// Component wise atomic add, safe against concurrent adds to the same value.
+	void AtomicAddValue(uint32_t x, uint32_t y, T value) {
+		T& target = m_data[y * m_resolution.x + x];
+		if constexpr (std::is_arithmetic_v<T>) {
+			std::atomic_ref<T>(target).fetch_add(value, std::memory_order_relaxed);
+		}
+		else {
+			for (int32_t i = 0; i < T::length(); i++) {
+				std::atomic_ref<typename T::value_type>(target[i]).fetch_add(value[i], std::memory_order_relaxed);
+			}
+		}
+	}
+
 	int32_t GetWidth() const {
 		return m_resolution.x;
 	}
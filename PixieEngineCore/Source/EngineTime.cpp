@@ -32,6 +32,13 @@ void HighPrecisionTimer::StopTimer(const std::string& name) {
 	timer.m_lastDelta = timer.m_end - timer.m_start;
 }
 
+void HighPrecisionTimer::RecordTimer(const std::string& name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+	HighPrecisionTimeMeasurement& timer = GetTimer(name);
+	timer.m_start = start;
+	timer.m_end = end;
+	timer.m_lastDelta = end - start;
+}
+
 HighPrecisionTimeMeasurement& HighPrecisionTimer::GetTimer(const std::string& name) {
 	for (int32_t i = 0; i < s_timers.size(); i++) {
 		if (s_timers[i].m_name == name) {
@@ -31,5 +31,7 @@ public:
 
 	static void StartTimer(const std::string& name);
 	static void StopTimer(const std::string& name);
+	// Stores interval measured elsewhere, e.g. on a worker thread, registry itself must be accessed from one thread.
+	static void RecordTimer(const std::string& name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
 	static HighPrecisionTimeMeasurement& GetTimer(const std::string& name);
 };
@@ -0,0 +1,169 @@
+#include "pch.h"
+#include "JobSystem.h"
+
+std::vector<std::unique_ptr<JobSystem::Worker>> JobSystem::m_workers;
+std::mutex JobSystem::m_mutex;
+std::condition_variable JobSystem::m_condition;
+JobGraph* JobSystem::m_graph = nullptr;
+uint64_t JobSystem::m_generation = 0;
+std::atomic<int32_t> JobSystem::m_busyWorkers = 0;
+bool JobSystem::m_stop = false;
+
+/*
+	Job Graph
+*/
+
+int32_t JobGraph::Add(const std::string& name, std::function<void()> function, const std::vector<int32_t>& dependencies) {
+	int32_t index = (int32_t)m_jobs.size();
+	Job& job = m_jobs.emplace_back();
+	job.name = name;
+	job.function = std::move(function);
+	for (int32_t dependency : dependencies) {
+		if (dependency < 0 || dependency >= index) {
+			continue;
+		}
+		m_jobs[dependency].dependents.push_back(index);
+		job.dependenciesCount++;
+	}
+	return index;
+}
+
+int32_t JobGraph::GetJobsCount() const {
+	return (int32_t)m_jobs.size();
+}
+
+const JobGraph::Job& JobGraph::GetJob(int32_t index) const {
+	return m_jobs[index];
+}
+
+/*
+	Job System
+*/
+
+void JobSystem::Run(JobGraph& graph) {
+	int32_t jobsCount = graph.GetJobsCount();
+	if (jobsCount == 0) {
+		return;
+	}
+	if (m_workers.empty()) {
+		Start();
+	}
+
+	// Workers are idle between runs, so deques can be reset safely. Every job is pushed once.
+	for (std::unique_ptr<Worker>& worker : m_workers) {
+		worker->deque.Reset(jobsCount);
+	}
+	graph.m_remainingJobs = jobsCount;
+	for (int32_t i = 0; i < jobsCount; i++) {
+		JobGraph::Job& job = graph.m_jobs[i];
+		job.remainingDependencies = job.dependenciesCount;
+		if (job.dependenciesCount == 0) {
+			m_workers[0]->deque.Push(i);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_graph = &graph;
+		m_generation++;
+	}
+	m_condition.notify_all();
+
+	ExecuteJobs(graph, 0);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_graph = nullptr;
+	}
+	// Workers may still be looking for jobs in the deques of this graph.
+	while (m_busyWorkers.load() > 0) {
+		std::this_thread::yield();
+	}
+}
+
+int32_t JobSystem::GetWorkersCount() {
+	return (int32_t)m_workers.size();
+}
+
+void JobSystem::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_all();
+	for (std::unique_ptr<Worker>& worker : m_workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+	m_workers.clear();
+	m_stop = false;
+}
+
+void JobSystem::Start() {
+	int32_t threadsCount = (int32_t)std::max(1u, std::thread::hardware_concurrency());
+	for (int32_t i = 0; i < threadsCount; i++) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+	for (int32_t i = 1; i < threadsCount; i++) {
+		m_workers[i]->thread = std::thread(WorkerLoop, i);
+	}
+	// Joinable threads must not outlive static destruction.
+	std::atexit(Shutdown);
+}
+
+void JobSystem::WorkerLoop(int32_t index) {
+	uint64_t generation = 0;
+	while (true) {
+		JobGraph* graph = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [&]() { return m_stop || m_generation != generation; });
+			if (m_stop) {
+				return;
+			}
+			generation = m_generation;
+			graph = m_graph;
+			if (!graph) {
+				continue;
+			}
+			m_busyWorkers++;
+		}
+		ExecuteJobs(*graph, index);
+		m_busyWorkers--;
+	}
+}
+
+void JobSystem::ExecuteJobs(JobGraph& graph, int32_t index) {
+	WorkStealingDeque& deque = m_workers[index]->deque;
+	while (graph.m_remainingJobs.load(std::memory_order_acquire) > 0) {
+		int64_t jobIndex;
+		if (!FindJob(index, jobIndex)) {
+			std::this_thread::yield();
+			continue;
+		}
+		JobGraph::Job& job = graph.m_jobs[jobIndex];
+		job.start = std::chrono::steady_clock::now();
+		job.function();
+		job.end = std::chrono::steady_clock::now();
+		for (int32_t dependent : job.dependents) {
+			if (graph.m_jobs[dependent].remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				deque.Push(dependent);
+			}
+		}
+		graph.m_remainingJobs.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+bool JobSystem::FindJob(int32_t index, int64_t& job) {
+	if (m_workers[index]->deque.Pop(job)) {
+		return true;
+	}
+	int32_t workersCount = (int32_t)m_workers.size();
+	for (int32_t i = 1; i < workersCount; i++) {
+		if (m_workers[(index + i) % workersCount]->deque.Steal(job)) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "pch.h"
+#include "WorkStealingDeque.h"
+
+// Set of jobs with dependencies between them, executed by JobSystem. Jobs are added before running the graph and
+// may only depend on jobs added earlier, so the graph is acyclic by construction.
+class JobGraph {
+public:
+	struct Job {
+		std::string name;
+		std::function<void()> function;
+		std::vector<int32_t> dependents;
+		int32_t dependenciesCount = 0;
+		std::atomic<int32_t> remainingDependencies = 0;
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+	};
+
+	int32_t Add(const std::string& name, std::function<void()> function, const std::vector<int32_t>& dependencies = {});
+	int32_t GetJobsCount() const;
+	const Job& GetJob(int32_t index) const;
+
+protected:
+	std::deque<Job> m_jobs;
+	std::atomic<int32_t> m_remainingJobs = 0;
+
+	friend class JobSystem;
+};
+
+// Fixed pool of worker threads started on first use. Every thread owns a deque of ready jobs, takes its own jobs in
+// LIFO order and steals from other threads when it runs out. Finishing a job pushes dependents that became ready to
+// the deque of the thread that finished it. The thread running a graph executes jobs as well until the graph is done.
+class JobSystem {
+public:
+	// Runs all jobs of the graph and returns when they are finished. Not reentrant, jobs must not run graphs.
+	static void Run(JobGraph& graph);
+	static int32_t GetWorkersCount();
+	static void Shutdown();
+
+protected:
+	struct alignas(64) Worker {
+		WorkStealingDeque deque;
+		std::thread thread;
+	};
+
+	// Index 0 belongs to the thread running the graph.
+	static std::vector<std::unique_ptr<Worker>> m_workers;
+	static std::mutex m_mutex;
+	static std::condition_variable m_condition;
+	static JobGraph* m_graph;
+	static uint64_t m_generation;
+	static std::atomic<int32_t> m_busyWorkers;
+	static bool m_stop;
+
+	static void Start();
+	static void WorkerLoop(int32_t index);
+	static void ExecuteJobs(JobGraph& graph, int32_t index);
+	static bool FindJob(int32_t index, int64_t& job);
+};
@@ -44,3 +44,17 @@ DirectionCone Union(const DirectionCone& a, const DirectionCone& b) {
     Vec3 w = RotateAroundAxis(glm::degrees(theta_r), wr).ApplyVector(a.w);
     return DirectionCone(w, std::cos(theta_o));
 }
+
+DirectionCone BoundSubtendedDirections(const Bounds3f& b, Vec3 p) {
+    Float radius;
+    Vec3 center;
+    b.BoundingSphere(&center, &radius);
+    Float distance2 = glm::length2(p - center);
+    if (distance2 < Sqr(radius)) {
+        return DirectionCone::EntireSphere();
+    }
+    Vec3 w = glm::normalize(center - p);
+    Float sin2ThetaMax = Sqr(radius) / distance2;
+    Float cosThetaMax = SafeSqrt(1 - sin2ThetaMax);
+    return DirectionCone(w, cosThetaMax);
+}
@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "Math/MathBase.h"
 #include "Math/Transform.h"
+#include "Math/Bounds.h"
 
 struct DirectionCone {
 	Vec3 w = Vec3(0);
@@ -16,3 +17,5 @@ struct DirectionCone {
 
 bool Inside(const DirectionCone& d, Vec3 w);
 DirectionCone Union(const DirectionCone& a, const DirectionCone& b);
+// Cone of directions from point p that contains the whole bounding box.
+DirectionCone BoundSubtendedDirections(const Bounds3f& b, Vec3 p);
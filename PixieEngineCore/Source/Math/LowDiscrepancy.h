@@ -0,0 +1,76 @@
+#pragma once
+#include "pch.h"
+#include "MathBase.h"
+#include "Random.h"
+
+static constexpr int32_t SobolMatrixSize = 52;
+static constexpr int32_t SobolDimensionsCount = 2;
+
+// Generator matrices of first two Sobol dimensions in 32 bit fixed point, column k holds direction number m_k / 2^k.
+// First dimension is van der Corput sequence, second one uses primitive polynomial x + 1 with m_1 = 1.
+constexpr std::array<std::array<uint32_t, SobolMatrixSize>, SobolDimensionsCount> GenerateSobolMatrices() {
+	std::array<std::array<uint32_t, SobolMatrixSize>, SobolDimensionsCount> matrices = {};
+	uint64_t m = 1;
+	for (int32_t k = 1; k <= SobolMatrixSize; k++) {
+		if (k > 1) {
+			m = (m << 1) ^ m;
+		}
+		matrices[0][k - 1] = k <= 32 ? 1u << (32 - k) : 0u;
+		matrices[1][k - 1] = k <= 32 ? (uint32_t)(m << (32 - k)) : (uint32_t)(m >> (k - 32));
+	}
+	return matrices;
+}
+
+static constexpr std::array<std::array<uint32_t, SobolMatrixSize>, SobolDimensionsCount> SobolMatrices = GenerateSobolMatrices();
+
+inline uint32_t ReverseBits32(uint32_t v) {
+	v = (v << 16) | (v >> 16);
+	v = ((v & 0x00ff00ff) << 8) | ((v & 0xff00ff00) >> 8);
+	v = ((v & 0x0f0f0f0f) << 4) | ((v & 0xf0f0f0f0) >> 4);
+	v = ((v & 0x33333333) << 2) | ((v & 0xcccccccc) >> 2);
+	v = ((v & 0x55555555) << 1) | ((v & 0xaaaaaaaa) >> 1);
+	return v;
+}
+
+inline uint64_t LeftShift2(uint64_t x) {
+	x &= 0xffffffff;
+	x = (x ^ (x << 16)) & 0x0000ffff0000ffff;
+	x = (x ^ (x << 8)) & 0x00ff00ff00ff00ff;
+	x = (x ^ (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+	x = (x ^ (x << 2)) & 0x3333333333333333;
+	x = (x ^ (x << 1)) & 0x5555555555555555;
+	return x;
+}
+
+inline uint64_t EncodeMorton2(uint32_t x, uint32_t y) {
+	return (LeftShift2(y) << 1) | LeftShift2(x);
+}
+
+// Hash based approximation of Owen scrambling: every bit is flipped depending only on the bits above it.
+struct FastOwenScrambler {
+	uint32_t seed;
+
+	FastOwenScrambler(uint32_t seed) : seed(seed) {}
+
+	uint32_t operator()(uint32_t v) const {
+		v = ReverseBits32(v);
+		v ^= v * 0x3d20adea;
+		v += seed;
+		v *= (seed >> 16) | 1;
+		v ^= v * 0x05526c56;
+		v ^= v * 0x53a22864;
+		return ReverseBits32(v);
+	}
+};
+
+template <typename Randomizer>
+inline Float SobolSample(uint64_t a, int32_t dimension, Randomizer randomizer) {
+	uint32_t v = 0;
+	for (int32_t i = 0; a != 0 && i < SobolMatrixSize; a >>= 1, i++) {
+		if (a & 1) {
+			v ^= SobolMatrices[dimension][i];
+		}
+	}
+	v = randomizer(v);
+	return std::min<Float>(v * (Float)0x1p-32, OneMinusEpsilon);
+}
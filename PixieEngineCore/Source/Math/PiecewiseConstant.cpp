@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "PiecewiseConstant.h"
+#include "Parallel.h"
+#include "Resources/BinaryIO.h"
 
 PiecewiseConstant1D::PiecewiseConstant1D(std::vector<Float> f) :
 	PiecewiseConstant1D(f, 0.0f, 1.0f) {}
@@ -70,6 +72,18 @@ std::optional<Float> PiecewiseConstant1D::Invert(Float x) const {
 	return Lerp(delta, m_cdf[offset], m_cdf[offset + 1]);
 }
 
+void PiecewiseConstant1D::Write(std::ostream& stream) const {
+	WriteBinary(stream, m_func);
+	WriteBinary(stream, m_cdf);
+	WriteBinary(stream, m_min);
+	WriteBinary(stream, m_max);
+	WriteBinary(stream, m_funcInt);
+}
+
+bool PiecewiseConstant1D::Read(std::istream& stream) {
+	return ReadBinary(stream, m_func) && ReadBinary(stream, m_cdf) && ReadBinary(stream, m_min) && ReadBinary(stream, m_max) && ReadBinary(stream, m_funcInt);
+}
+
 PiecewiseConstant2D::PiecewiseConstant2D(const Buffer2D<Float>& data) :
 	PiecewiseConstant2D(data, Bounds2f(Vec2(0, 0), Vec2(1, 1))) {}
 
@@ -77,10 +91,12 @@ PiecewiseConstant2D::PiecewiseConstant2D(const Buffer2D<Float>& data, Bounds2f d
 	m_domain(domain) {
 	int32_t nu = data.GetWidth();
 	int32_t nv = data.GetHeight();
-	m_pConditionalV.reserve(nv);
-	for (int32_t v = 0; v < nv; v++) {
-		m_pConditionalV.emplace_back(data.CopyRow(v), domain.min[0], domain.max[0]);
-	}
+	m_pConditionalV.resize(nv);
+	ParallelFor(nv, [&](int32_t start, int32_t end) {
+		for (int32_t v = start; v < end; v++) {
+			m_pConditionalV[v] = PiecewiseConstant1D(data.CopyRow(v), domain.min[0], domain.max[0]);
+		}
+	}, 64);
 
 	std::vector<Float> marginalFunc;
 	marginalFunc.reserve(nv);
@@ -143,3 +159,27 @@ std::optional<Vec2> PiecewiseConstant2D::Invert(Vec2 p) const {
 	}
 	return Vec2(*cInv, *mInv);
 }
+
+void PiecewiseConstant2D::Write(std::ostream& stream) const {
+	WriteBinary(stream, m_domain.min);
+	WriteBinary(stream, m_domain.max);
+	WriteBinary(stream, (uint64_t)m_pConditionalV.size());
+	for (const PiecewiseConstant1D& conditional : m_pConditionalV) {
+		conditional.Write(stream);
+	}
+	m_pMarginal.Write(stream);
+}
+
+bool PiecewiseConstant2D::Read(std::istream& stream) {
+	uint64_t rowsCount = 0;
+	if (!ReadBinary(stream, m_domain.min) || !ReadBinary(stream, m_domain.max) || !ReadBinary(stream, rowsCount)) {
+		return false;
+	}
+	m_pConditionalV.resize(rowsCount);
+	for (PiecewiseConstant1D& conditional : m_pConditionalV) {
+		if (!conditional.Read(stream)) {
+			return false;
+		}
+	}
+	return m_pMarginal.Read(stream);
+}
@@ -15,6 +15,8 @@ public:
 	size_t size() const;
 	Float Sample(Float u, Float* pdf = nullptr, int32_t* offset = nullptr) const;
 	std::optional<Float> Invert(Float x) const;
+	void Write(std::ostream& stream) const;
+	bool Read(std::istream& stream);
 
 protected:
 	std::vector<Float> m_func;
@@ -26,6 +28,7 @@ protected:
 	friend class PiecewiseConstant2D;
 };
 
+// Rows of conditional distributions are built in parallel.
 class PiecewiseConstant2D {
 public:
 	PiecewiseConstant2D() = default;
@@ -39,6 +42,8 @@ public:
 	Vec2 Sample(Vec2 u, Float* pdf = nullptr, glm::ivec2* offset = nullptr) const;
 	Float PDF(Vec2 pr) const;
 	std::optional<Vec2> Invert(Vec2 p) const;
+	void Write(std::ostream& stream) const;
+	bool Read(std::istream& stream);
 
 protected:
 	Bounds2f m_domain;
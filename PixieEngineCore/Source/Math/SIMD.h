@@ -0,0 +1,9 @@
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define PIXIE_ENGINE_SSE
+#include <immintrin.h>
+#endif
+#if defined(PIXIE_ENGINE_SSE) && (defined(__AVX__) || defined(__AVX2__))
+#define PIXIE_ENGINE_AVX
+#endif
@@ -0,0 +1,413 @@
+#include "pch.h"
+#include "MeshBVH.h"
+#include "Resources/BinaryIO.h"
+
+std::string to_string(BVHLayout layout) {
+	switch (layout) {
+	case BVHLayout::Binary: return "Binary";
+	case BVHLayout::Wide4: return "BVH4";
+	case BVHLayout::Wide8: return "BVH8";
+	default: return "Undefined BVH Layout";
+	}
+}
+
+MeshBVH::MeshBVH(const Mesh* mesh, BVHBuildMethod buildMethod) :
+	m_meshVersion(mesh->m_version), m_buildMethod(buildMethod) {
+	std::vector<Triangle> triangles;
+	triangles.reserve(mesh->m_indices.size() / 3);
+	for (size_t i = 0; i < mesh->m_indices.size() / 3; i++) {
+		Triangle triangle = Triangle(0,
+			mesh->m_vertices[mesh->m_indices[i * 3 + 0]],
+			mesh->m_vertices[mesh->m_indices[i * 3 + 1]],
+			mesh->m_vertices[mesh->m_indices[i * 3 + 2]]
+		);
+
+		if (!triangle.Area() || isnan(triangle.normal)) {
+			m_invalidTrianglesCount++;
+			continue;
+		}
+		triangles.push_back(triangle);
+	}
+	if (triangles.empty()) {
+		return;
+	}
+
+	std::vector<Bounds3f> bounds(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i++) {
+		bounds[i] = triangles[i].Bounds();
+	}
+	BVHBuilder builder(m_buildMethod);
+	builder.Build(bounds, m_nodes);
+	m_buildStats = builder.GetStats();
+
+	const std::vector<int32_t>& order = builder.GetPrimitivesOrder();
+	m_triangleShadings.resize(triangles.size());
+	m_triangleLanes.resize(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i++) {
+		const Triangle& triangle = triangles[order[i]];
+		Float uvArea = glm::abs((triangle.uv1.x - triangle.uv0.x) * (triangle.uv2.y - triangle.uv0.y) - (triangle.uv2.x - triangle.uv0.x) * (triangle.uv1.y - triangle.uv0.y)) * 0.5f;
+		m_triangleShadings[i] = { triangle.normal, triangle.uv0, triangle.uv1, triangle.uv2, glm::sqrt(uvArea / triangle.Area()) };
+	}
+	// Every leaf starts a new packet and its last packet is padded with masked lanes, so a leaf is tested with
+	// whole packets only. Leaves reference their first packet instead of their first triangle.
+	for (BVHNode& node : m_nodes) {
+		if (node.nTriangles == 0) {
+			continue;
+		}
+		int32_t firstTriangle = node.childOffset;
+		node.childOffset = (int32_t)m_trianglePackets.size();
+		for (int32_t i = 0; i < node.nTriangles; i++) {
+			int32_t triangleIndex = firstTriangle + i;
+			if (i % TrianglePacketSize == 0) {
+				m_trianglePackets.emplace_back();
+				m_packetTriangleOffsets.push_back(triangleIndex);
+			}
+			const Triangle& triangle = triangles[order[triangleIndex]];
+			m_trianglePackets.back().SetTriangle(i % TrianglePacketSize, triangle.p0, triangle.p1, triangle.p2);
+			m_triangleLanes[triangleIndex] = ((int32_t)m_trianglePackets.size() - 1) * TrianglePacketSize + i % TrianglePacketSize;
+		}
+	}
+}
+
+bool MeshBVH::IsUpToDate(const Mesh* mesh, BVHBuildMethod buildMethod) const {
+	return mesh->m_version == m_meshVersion && buildMethod == m_buildMethod;
+}
+
+bool MeshBVH::IsEmpty() const {
+	return m_nodes.empty();
+}
+
+Bounds3f MeshBVH::GetBounds() const {
+	return m_nodes.size() > 0 ? Bounds3f(m_nodes[0].pMin, m_nodes[0].pMax) : Bounds3f();
+}
+
+int32_t MeshBVH::GetTrianglesCount() const {
+	return (int32_t)m_triangleShadings.size();
+}
+
+int32_t MeshBVH::GetInvalidTrianglesCount() const {
+	return m_invalidTrianglesCount;
+}
+
+int32_t MeshBVH::GetNodesCount() const {
+	return (int32_t)m_nodes.size();
+}
+
+const BVHBuildStats& MeshBVH::GetBuildStats() const {
+	return m_buildStats;
+}
+
+const TriangleShading& MeshBVH::GetTriangleShading(int32_t index) const {
+	return m_triangleShadings[index];
+}
+
+Triangle MeshBVH::GetTriangle(int32_t index, int32_t materialIndex, const Transform& transform) const {
+	const TrianglePacket& packet = m_trianglePackets[m_triangleLanes[index] / TrianglePacketSize];
+	int32_t lane = m_triangleLanes[index] % TrianglePacketSize;
+	Vec3 p0 = Vec3(packet.p0[0][lane], packet.p0[1][lane], packet.p0[2][lane]);
+	Vec3 edge1 = Vec3(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+	Vec3 edge2 = Vec3(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+	return Triangle(materialIndex, Vertex(transform.ApplyPoint(p0)), Vertex(transform.ApplyPoint(p0 + edge1)), Vertex(transform.ApplyPoint(p0 + edge2)));
+}
+
+Vec2 MeshBVH::GetTriangleUV(int32_t index, Vec3 localPosition) const {
+	const TrianglePacket& packet = m_trianglePackets[m_triangleLanes[index] / TrianglePacketSize];
+	int32_t lane = m_triangleLanes[index] % TrianglePacketSize;
+	Vec3 p0 = Vec3(packet.p0[0][lane], packet.p0[1][lane], packet.p0[2][lane]);
+	Vec3 edge1 = Vec3(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+	Vec3 edge2 = Vec3(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+	Vec3 d = localPosition - p0;
+	Float d11 = glm::dot(edge1, edge1);
+	Float d12 = glm::dot(edge1, edge2);
+	Float d22 = glm::dot(edge2, edge2);
+	Float denominator = d11 * d22 - d12 * d12;
+	const TriangleShading& shading = m_triangleShadings[index];
+	if (denominator == 0.0f) {
+		return shading.uv0;
+	}
+	Float b1 = (d22 * glm::dot(d, edge1) - d12 * glm::dot(d, edge2)) / denominator;
+	Float b2 = (d11 * glm::dot(d, edge2) - d12 * glm::dot(d, edge1)) / denominator;
+	return shading.uv0 * (1.0f - b1 - b2) + shading.uv1 * b1 + shading.uv2 * b2;
+}
+
+void MeshBVH::PrepareLayout(BVHLayout layout) {
+	if (m_nodes.empty()) {
+		return;
+	}
+	// Snapshots sharing this BVH may request the same layout from different render threads.
+	if (layout == BVHLayout::Wide4) {
+		std::call_once(m_wide4Collapsed, [this]() { CollapseBVH(m_wideNodes4, 0); });
+	}
+	else if (layout == BVHLayout::Wide8) {
+		std::call_once(m_wide8Collapsed, [this]() { CollapseBVH(m_wideNodes8, 0); });
+	}
+}
+
+void MeshBVH::Write(std::ostream& stream) const {
+	WriteBinary(stream, m_buildMethod);
+	WriteBinary(stream, m_buildStats);
+	WriteBinary(stream, m_invalidTrianglesCount);
+	WriteBinary(stream, m_nodes);
+	WriteBinary(stream, m_trianglePackets);
+	WriteBinary(stream, m_packetTriangleOffsets);
+	WriteBinary(stream, m_triangleShadings);
+	WriteBinary(stream, m_triangleLanes);
+}
+
+std::shared_ptr<MeshBVH> MeshBVH::Read(std::istream& stream, const Mesh* mesh) {
+	std::shared_ptr<MeshBVH> bvh = std::shared_ptr<MeshBVH>(new MeshBVH());
+	if (!ReadBinary(stream, bvh->m_buildMethod) || !ReadBinary(stream, bvh->m_buildStats) || !ReadBinary(stream, bvh->m_invalidTrianglesCount) ||
+		!ReadBinary(stream, bvh->m_nodes) || !ReadBinary(stream, bvh->m_trianglePackets) || !ReadBinary(stream, bvh->m_packetTriangleOffsets) ||
+		!ReadBinary(stream, bvh->m_triangleShadings) || !ReadBinary(stream, bvh->m_triangleLanes)) {
+		return nullptr;
+	}
+	size_t trianglesCount = bvh->m_triangleShadings.size();
+	if (trianglesCount + bvh->m_invalidTrianglesCount != mesh->m_indices.size() / 3 ||
+		bvh->m_packetTriangleOffsets.size() != bvh->m_trianglePackets.size() || bvh->m_triangleLanes.size() != trianglesCount ||
+		(trianglesCount > 0) != (bvh->m_nodes.size() > 0)) {
+		return nullptr;
+	}
+	bvh->m_meshVersion = mesh->m_version;
+	return bvh;
+}
+
+template<int32_t Width>
+int32_t MeshBVH::CollapseBVH(std::vector<WideBVHNode<Width>>& wideNodes, int32_t nodeIndex) {
+	// Open the largest interior children until the wide node is full.
+	std::array<int32_t, Width> children;
+	int32_t childrenCount = 0;
+	if (m_nodes[nodeIndex].nTriangles > 0) {
+		children[childrenCount++] = nodeIndex;
+	}
+	else {
+		children[childrenCount++] = nodeIndex + 1;
+		children[childrenCount++] = m_nodes[nodeIndex].childOffset;
+	}
+	while (childrenCount < Width) {
+		int32_t largestChild = -1;
+		Float largestArea = -1.0f;
+		for (int32_t i = 0; i < childrenCount; i++) {
+			const BVHNode& child = m_nodes[children[i]];
+			Float area = Bounds3f(child.pMin, child.pMax).Area();
+			if (child.nTriangles == 0 && area > largestArea) {
+				largestArea = area;
+				largestChild = i;
+			}
+		}
+		if (largestChild == -1) {
+			break;
+		}
+		int32_t openedNode = children[largestChild];
+		children[largestChild] = openedNode + 1;
+		children[childrenCount++] = m_nodes[openedNode].childOffset;
+	}
+
+	int32_t wideNodeIndex = (int32_t)wideNodes.size();
+	wideNodes.push_back(WideBVHNode<Width>());
+	for (int32_t i = 0; i < childrenCount; i++) {
+		const BVHNode& child = m_nodes[children[i]];
+		int32_t offset = child.nTriangles > 0 ? child.childOffset : CollapseBVH(wideNodes, children[i]);
+		wideNodes[wideNodeIndex].SetChild(i, child.pMin, child.pMax, offset, child.nTriangles);
+	}
+	return wideNodeIndex;
+}
+
+// Orders hit children from far to near, so pushed on a stack the nearest one is traversed first.
+template<int32_t Width>
+static inline int32_t SortWideHits(int32_t mask, int32_t childrenCount, const float* tNear, std::array<int32_t, Width>& hits) {
+	int32_t hitsCount = 0;
+	for (int32_t i = 0; i < childrenCount; i++) {
+		if (!(mask & (1 << i))) {
+			continue;
+		}
+		int32_t j = hitsCount++;
+		while (j > 0 && tNear[hits[j - 1]] < tNear[i]) {
+			hits[j] = hits[j - 1];
+			j--;
+		}
+		hits[j] = i;
+	}
+	return hitsCount;
+}
+
+void MeshBVH::Intersect(BVHLayout layout, const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* boxChecks, int32_t* shapeChecks) const {
+	if (m_nodes.empty()) {
+		return;
+	}
+	switch (layout) {
+	case BVHLayout::Wide4: IntersectWideBVH(m_wideNodes4, ray, closestTriangle, tMax, boxChecks, shapeChecks); break;
+	case BVHLayout::Wide8: IntersectWideBVH(m_wideNodes8, ray, closestTriangle, tMax, boxChecks, shapeChecks); break;
+	default: IntersectBVH(ray, closestTriangle, tMax, boxChecks, shapeChecks); break;
+	}
+}
+
+void MeshBVH::IntersectTriangles(int32_t firstPacket, int32_t count, const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* shapeChecks) const {
+	(*shapeChecks) += count;
+	for (int32_t i = 0; i * TrianglePacketSize < count; i++) {
+		int32_t packetIndex = firstPacket + i;
+		int32_t laneMask = (1 << std::min(count - i * TrianglePacketSize, TrianglePacketSize)) - 1;
+		Float tHit;
+		int32_t lane = m_trianglePackets[packetIndex].Intersect(ray, tMax, laneMask, &tHit);
+		if (lane != -1) {
+			tMax = tHit;
+			closestTriangle = m_packetTriangleOffsets[packetIndex] + lane;
+		}
+	}
+}
+
+bool MeshBVH::IsTrianglesIntersected(int32_t firstPacket, int32_t count, const Ray& ray, Float tMax, int32_t* shapeChecks) const {
+	for (int32_t i = 0; i * TrianglePacketSize < count; i++) {
+		int32_t lanesCount = std::min(count - i * TrianglePacketSize, TrianglePacketSize);
+		(*shapeChecks) += lanesCount;
+		if (m_trianglePackets[firstPacket + i].IsIntersected(ray, tMax, (1 << lanesCount) - 1)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void MeshBVH::IntersectBVH(const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* boxChecks, int32_t* shapeChecks) const {
+	std::array<int32_t, 64> nodesStack;
+	int32_t nodesStackSize = 0;
+	(*boxChecks)++;
+	if (m_nodes[0].IsIntersected(ray, tMax)) {
+		nodesStack[nodesStackSize++] = 0;
+	}
+	while (nodesStackSize > 0) {
+		nodesStackSize--;
+		int32_t nodeIndex = nodesStack[nodesStackSize];
+		const BVHNode& node = m_nodes[nodeIndex];
+		if (node.nTriangles > 0) {
+			IntersectTriangles(node.childOffset, node.nTriangles, ray, closestTriangle, tMax, shapeChecks);
+			continue;
+		}
+		// First child holds primitives with smaller centroids along the split axis, push the far child first.
+		int32_t nearChild = nodeIndex + 1;
+		int32_t farChild = node.childOffset;
+		if (ray.direction[node.axis] < 0) {
+			std::swap(nearChild, farChild);
+		}
+		if (m_nodes[farChild].IsIntersected(ray, tMax)) {
+			nodesStack[nodesStackSize++] = farChild;
+		}
+		if (m_nodes[nearChild].IsIntersected(ray, tMax)) {
+			nodesStack[nodesStackSize++] = nearChild;
+		}
+		(*boxChecks) += 2;
+	}
+}
+
+template<int32_t Width>
+void MeshBVH::IntersectWideBVH(const std::vector<WideBVHNode<Width>>& wideNodes, const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* boxChecks, int32_t* shapeChecks) const {
+	struct StackEntry {
+		int32_t offset;
+		int32_t trianglesCount;
+		float tNear;
+	};
+	WideBVHRay wideRay(ray);
+	std::array<StackEntry, 64 * Width> stack;
+	int32_t stackSize = 0;
+	stack[stackSize++] = { 0, 0, 0.0f };
+	while (stackSize > 0) {
+		const StackEntry entry = stack[--stackSize];
+		// Closer hit was found after this entry had been pushed.
+		if (entry.tNear > tMax) {
+			continue;
+		}
+		if (entry.trianglesCount > 0) {
+			IntersectTriangles(entry.offset, entry.trianglesCount, ray, closestTriangle, tMax, shapeChecks);
+			continue;
+		}
+
+		const WideBVHNode<Width>& node = wideNodes[entry.offset];
+		alignas(32) float tNear[Width];
+		int32_t mask = node.Intersect(wideRay, (float)tMax, tNear);
+		(*boxChecks) += node.childrenCount;
+
+		std::array<int32_t, Width> hits;
+		int32_t hitsCount = SortWideHits<Width>(mask, node.childrenCount, tNear, hits);
+		for (int32_t i = 0; i < hitsCount; i++) {
+			int32_t child = hits[i];
+			stack[stackSize++] = { node.childOffsets[child], node.trianglesCounts[child], tNear[child] };
+		}
+	}
+}
+
+bool MeshBVH::IsIntersected(BVHLayout layout, const Ray& ray, Float tMax, int32_t* boxChecks, int32_t* shapeChecks) const {
+	if (m_nodes.empty()) {
+		return false;
+	}
+	switch (layout) {
+	case BVHLayout::Wide4: return IsWideBVHIntersected(m_wideNodes4, ray, tMax, boxChecks, shapeChecks);
+	case BVHLayout::Wide8: return IsWideBVHIntersected(m_wideNodes8, ray, tMax, boxChecks, shapeChecks);
+	default: return IsBVHIntersected(ray, tMax, boxChecks, shapeChecks);
+	}
+}
+
+bool MeshBVH::IsBVHIntersected(const Ray& ray, Float tMax, int32_t* boxChecks, int32_t* shapeChecks) const {
+	std::array<int32_t, 64> nodesStack;
+	int32_t nodesStackSize = 0;
+	(*boxChecks)++;
+	if (m_nodes[0].IsIntersected(ray, tMax)) {
+		nodesStack[nodesStackSize++] = 0;
+	}
+	while (nodesStackSize > 0) {
+		nodesStackSize--;
+		int32_t nodeIndex = nodesStack[nodesStackSize];
+		const BVHNode& node = m_nodes[nodeIndex];
+		if (node.nTriangles > 0) {
+			if (IsTrianglesIntersected(node.childOffset, node.nTriangles, ray, tMax, shapeChecks)) {
+				return true;
+			}
+			continue;
+		}
+		// First child holds primitives with smaller centroids along the split axis, push the far child first.
+		int32_t nearChild = nodeIndex + 1;
+		int32_t farChild = node.childOffset;
+		if (ray.direction[node.axis] < 0) {
+			std::swap(nearChild, farChild);
+		}
+		if (m_nodes[farChild].IsIntersected(ray, tMax)) {
+			nodesStack[nodesStackSize++] = farChild;
+		}
+		if (m_nodes[nearChild].IsIntersected(ray, tMax)) {
+			nodesStack[nodesStackSize++] = nearChild;
+		}
+		(*boxChecks) += 2;
+	}
+	return false;
+}
+
+template<int32_t Width>
+bool MeshBVH::IsWideBVHIntersected(const std::vector<WideBVHNode<Width>>& wideNodes, const Ray& ray, Float tMax, int32_t* boxChecks, int32_t* shapeChecks) const {
+	struct StackEntry {
+		int32_t offset;
+		int32_t trianglesCount;
+	};
+	WideBVHRay wideRay(ray);
+	std::array<StackEntry, 64 * Width> stack;
+	int32_t stackSize = 0;
+	stack[stackSize++] = { 0, 0 };
+	while (stackSize > 0) {
+		const StackEntry entry = stack[--stackSize];
+		if (entry.trianglesCount > 0) {
+			if (IsTrianglesIntersected(entry.offset, entry.trianglesCount, ray, tMax, shapeChecks)) {
+				return true;
+			}
+			continue;
+		}
+
+		const WideBVHNode<Width>& node = wideNodes[entry.offset];
+		alignas(32) float tNear[Width];
+		int32_t mask = node.Intersect(wideRay, (float)tMax, tNear);
+		(*boxChecks) += node.childrenCount;
+
+		std::array<int32_t, Width> hits;
+		int32_t hitsCount = SortWideHits<Width>(mask, node.childrenCount, tNear, hits);
+		for (int32_t i = 0; i < hitsCount; i++) {
+			int32_t child = hits[i];
+			stack[stackSize++] = { node.childOffsets[child], node.trianglesCounts[child] };
+		}
+	}
+	return false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "pch.h"
+#include "Mesh.h"
+#include "Math/Transform.h"
+#include "BVHNode.h"
+#include "WideBVHNode.h"
+#include "BVHBuilder.h"
+#include "RayTracing/Shapes.h"
+#include "RayTracing/TrianglePacket.h"
+
+enum class BVHLayout : int32_t {
+	Binary = 0,
+	Wide4,
+	Wide8,
+	COUNT
+};
+
+std::string to_string(BVHLayout layout);
+
+// Bottom level acceleration structure over triangles of a single mesh, in mesh local space.
+// Built once per mesh version and shared between scene snapshots, so it is never modified after construction,
+// except for wide layouts which are collapsed from the binary tree on first use.
+class MeshBVH {
+public:
+	MeshBVH(const Mesh* mesh, BVHBuildMethod buildMethod);
+
+	bool IsUpToDate(const Mesh* mesh, BVHBuildMethod buildMethod) const;
+	bool IsEmpty() const;
+	Bounds3f GetBounds() const;
+	int32_t GetTrianglesCount() const;
+	int32_t GetInvalidTrianglesCount() const;
+	int32_t GetNodesCount() const;
+	const BVHBuildStats& GetBuildStats() const;
+	const TriangleShading& GetTriangleShading(int32_t index) const;
+	Triangle GetTriangle(int32_t index, int32_t materialIndex, const Transform& transform) const;
+	// Interpolates texture coordinates at a point of the triangle given in mesh local space.
+	Vec2 GetTriangleUV(int32_t index, Vec3 localPosition) const;
+	void PrepareLayout(BVHLayout layout);
+	// Binary tree only, wide layouts are collapsed again after reading.
+	void Write(std::ostream& stream) const;
+	// Returns nullptr if stream doesn't hold a BVH over triangles of the mesh. Read BVH is bound to current mesh version.
+	static std::shared_ptr<MeshBVH> Read(std::istream& stream, const Mesh* mesh);
+
+	void Intersect(BVHLayout layout, const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* boxChecks, int32_t* shapeChecks) const;
+	// Any hit query for shadow rays, stops at the first intersected triangle.
+	bool IsIntersected(BVHLayout layout, const Ray& ray, Float tMax, int32_t* boxChecks, int32_t* shapeChecks) const;
+
+protected:
+	uint64_t m_meshVersion = 0;
+	BVHBuildMethod m_buildMethod = BVHBuildMethod::SAH;
+	BVHBuildStats m_buildStats;
+	int32_t m_invalidTrianglesCount = 0;
+	// Packets of each leaf in a row, leaf nodes store offset of their first packet.
+	std::vector<TrianglePacket> m_trianglePackets;
+	// Index of the triangle in the first lane of each packet, the other lanes hold the following triangles.
+	std::vector<int32_t> m_packetTriangleOffsets;
+	std::vector<TriangleShading> m_triangleShadings;
+	// Packet index * TrianglePacketSize + lane of each triangle.
+	std::vector<int32_t> m_triangleLanes;
+	std::vector<BVHNode> m_nodes;
+	std::vector<WideBVHNode<4>> m_wideNodes4;
+	std::vector<WideBVHNode<8>> m_wideNodes8;
+	std::once_flag m_wide4Collapsed;
+	std::once_flag m_wide8Collapsed;
+
+	MeshBVH() = default;
+
+	template<int32_t Width>
+	int32_t CollapseBVH(std::vector<WideBVHNode<Width>>& wideNodes, int32_t nodeIndex);
+	void IntersectTriangles(int32_t firstPacket, int32_t count, const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* shapeChecks) const;
+	bool IsTrianglesIntersected(int32_t firstPacket, int32_t count, const Ray& ray, Float tMax, int32_t* shapeChecks) const;
+	void IntersectBVH(const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* boxChecks, int32_t* shapeChecks) const;
+	template<int32_t Width>
+	void IntersectWideBVH(const std::vector<WideBVHNode<Width>>& wideNodes, const Ray& ray, int32_t& closestTriangle, Float& tMax, int32_t* boxChecks, int32_t* shapeChecks) const;
+	bool IsBVHIntersected(const Ray& ray, Float tMax, int32_t* boxChecks, int32_t* shapeChecks) const;
+	template<int32_t Width>
+	bool IsWideBVHIntersected(const std::vector<WideBVHNode<Width>>& wideNodes, const Ray& ray, Float tMax, int32_t* boxChecks, int32_t* shapeChecks) const;
+};
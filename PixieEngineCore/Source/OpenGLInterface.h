@@ -1,5 +1,11 @@
 #pragma once
 
+// OpenGL functions are loaded by the window that owns the context. Headless tools never load them,
+// so GPU resources are only created when this returns true.
+inline bool IsOpenGLContextLoaded() {
+	return GLVersion.major > 0;
+}
+
 inline void glUniformMatrix3(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
 	glUniformMatrix3fv(location, count, transpose, value);
 }
@@ -0,0 +1,21 @@
+#pragma once
+#include "pch.h"
+#include "Math/MathBase.h"
+
+// Splits [0, count) into contiguous ranges processed on separate threads, function receives range start and end.
+// Small counts run on calling thread.
+template<typename Function>
+inline void ParallelFor(int32_t count, Function function, int32_t minItemsPerThread = 16 * 1024) {
+	int32_t threadsCount = Clamp(count / std::max(minItemsPerThread, 1), 1, (int32_t)std::max(1u, std::thread::hardware_concurrency()));
+	if (threadsCount == 1) {
+		function(0, count);
+		return;
+	}
+	std::vector<std::thread> threads;
+	for (int32_t i = 0; i < threadsCount; i++) {
+		threads.emplace_back(function, (int32_t)((int64_t)count * i / threadsCount), (int32_t)((int64_t)count * (i + 1) / threadsCount));
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
@@ -3,8 +3,10 @@
 #include "EngineTime.h"
 #include "FrameBuffer.h"
 #include "Resources/ResourceManager.h"
+#include "Resources/TextureCache.h"
 #include "RayTracing/VolumetricRayTracer.h"
 #include "RayTracing/Film.h"
+#include "RayTracing/AOVBuffer.h"
 #include "RayTracing/Shapes.h"
 #include "ShaderGraph/ShaderGraph.h"
 #include "ShaderGraph/Nodes/Nodes.h"
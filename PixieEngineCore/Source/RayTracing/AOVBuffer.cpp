@@ -0,0 +1,173 @@
+#include "pch.h"
+#include "AOVBuffer.h"
+
+std::string to_string(AOVType type) {
+	switch (type) {
+	case AOVType::Albedo: return "Albedo";
+	case AOVType::Normal: return "Normal";
+	case AOVType::Position: return "Position";
+	case AOVType::UV: return "UV";
+	case AOVType::Depth: return "Depth";
+	case AOVType::BoxChecks: return "Box Checks";
+	case AOVType::ShapeChecks: return "Shape Checks";
+	default: return "Undefined AOV";
+	}
+}
+
+std::string GetAOVLayerName(AOVType type) {
+	switch (type) {
+	case AOVType::Albedo: return "albedo";
+	case AOVType::Normal: return "normal";
+	case AOVType::Position: return "position";
+	case AOVType::UV: return "uv";
+	case AOVType::Depth: return "depth";
+	case AOVType::BoxChecks: return "boxChecks";
+	case AOVType::ShapeChecks: return "shapeChecks";
+	default: return "undefined";
+	}
+}
+
+int32_t GetAOVChannelsCount(AOVType type) {
+	switch (type) {
+	case AOVType::Albedo:
+	case AOVType::Normal:
+	case AOVType::Position:
+		return 3;
+	case AOVType::UV:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+// Channel suffixes follow OpenEXR naming, color layers use RGB, vectors XYZ and single values Y.
+static const char* GetAOVChannelName(AOVType type, int32_t channel) {
+	static const char* colorChannels[] = { "R", "G", "B" };
+	static const char* vectorChannels[] = { "X", "Y", "Z" };
+	static const char* uvChannels[] = { "U", "V" };
+	switch (type) {
+	case AOVType::Albedo: return colorChannels[channel];
+	case AOVType::Normal:
+	case AOVType::Position:
+		return vectorChannels[channel];
+	case AOVType::UV: return uvChannels[channel];
+	case AOVType::Depth: return "Z";
+	default: return "Y";
+	}
+}
+
+AOVBuffer::AOVBuffer(glm::ivec2 resolution) :
+	m_resolution(resolution) {}
+
+void AOVBuffer::Reset() {
+	for (std::vector<Float>& layer : m_layers) {
+		std::fill(layer.begin(), layer.end(), 0.0f);
+	}
+	std::fill(m_samplesCount.begin(), m_samplesCount.end(), 0);
+}
+
+void AOVBuffer::Resize(glm::ivec2 resolution) {
+	if (m_resolution == resolution) return;
+	m_resolution = resolution;
+	AllocateLayers();
+}
+
+bool AOVBuffer::IsEnabled(AOVType type) const {
+	return m_enabledMask & (1u << (uint32_t)type);
+}
+
+void AOVBuffer::SetEnabled(AOVType type, bool enabled) {
+	if (enabled) {
+		m_enabledMask |= 1u << (uint32_t)type;
+	}
+	else {
+		m_enabledMask &= ~(1u << (uint32_t)type);
+	}
+	AllocateLayers();
+}
+
+bool AOVBuffer::HasEnabled() const {
+	return m_enabledMask != 0;
+}
+
+void AOVBuffer::AddSample(int32_t x, int32_t y, const GBufferPixel& pixel) {
+	size_t index = (size_t)y * m_resolution.x + x;
+	m_samplesCount[index]++;
+	for (uint32_t mask = m_enabledMask; mask != 0; mask &= mask - 1) {
+		AOVType type = AOVType(std::countr_zero(mask));
+		Float* values = m_layers[(size_t)type].data() + index * GetAOVChannelsCount(type);
+		switch (type) {
+		case AOVType::Albedo: {
+			Spectrum albedo = pixel.albedo;
+			Vec3 rgb = albedo.GetRGB();
+			values[0] += rgb.r; values[1] += rgb.g; values[2] += rgb.b;
+			break;
+		}
+		case AOVType::Normal:
+			values[0] += pixel.normal.x; values[1] += pixel.normal.y; values[2] += pixel.normal.z;
+			break;
+		case AOVType::Position:
+			values[0] += pixel.position.x; values[1] += pixel.position.y; values[2] += pixel.position.z;
+			break;
+		case AOVType::UV:
+			values[0] += pixel.uv.x; values[1] += pixel.uv.y;
+			break;
+		case AOVType::Depth:
+			values[0] += pixel.depth;
+			break;
+		case AOVType::BoxChecks:
+			values[0] += (Float)pixel.boxChecks;
+			break;
+		case AOVType::ShapeChecks:
+			values[0] += (Float)pixel.shapeChecks;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+Buffer2D<Vec3> AOVBuffer::GetLayer(AOVType type) const {
+	Buffer2D<Vec3> image(m_resolution);
+	if (!IsEnabled(type)) return image;
+	int32_t channelsCount = GetAOVChannelsCount(type);
+	const std::vector<Float>& layer = m_layers[(size_t)type];
+	for (size_t p = 0; p < m_samplesCount.size(); p++) {
+		if (m_samplesCount[p] == 0) continue;
+		Vec3 value(0.0f);
+		for (int32_t c = 0; c < channelsCount; c++) {
+			value[c] = layer[p * channelsCount + c] / m_samplesCount[p];
+		}
+		image.m_data[p] = value;
+	}
+	return image;
+}
+
+std::vector<ImageChannel> AOVBuffer::GetChannels() const {
+	std::vector<ImageChannel> channels;
+	for (int32_t i = 0; i < (int32_t)AOVType::COUNT; i++) {
+		AOVType type = AOVType(i);
+		if (!IsEnabled(type)) continue;
+		int32_t channelsCount = GetAOVChannelsCount(type);
+		const std::vector<Float>& layer = m_layers[i];
+		for (int32_t c = 0; c < channelsCount; c++) {
+			ImageChannel channel(GetAOVLayerName(type) + "." + GetAOVChannelName(type, c), m_resolution);
+			for (size_t p = 0; p < m_samplesCount.size(); p++) {
+				if (m_samplesCount[p] == 0) continue;
+				channel.m_data[p] = (float)(layer[p * channelsCount + c] / m_samplesCount[p]);
+			}
+			channels.push_back(std::move(channel));
+		}
+	}
+	return channels;
+}
+
+void AOVBuffer::AllocateLayers() {
+	size_t pixelsCount = (size_t)m_resolution.x * m_resolution.y;
+	for (int32_t i = 0; i < (int32_t)AOVType::COUNT; i++) {
+		AOVType type = AOVType(i);
+		size_t size = IsEnabled(type) ? pixelsCount * GetAOVChannelsCount(type) : 0;
+		m_layers[i].assign(size, 0.0f);
+	}
+	m_samplesCount.assign(HasEnabled() ? pixelsCount : 0, 0);
+}
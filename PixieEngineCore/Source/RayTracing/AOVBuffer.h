@@ -0,0 +1,46 @@
+#pragma once
+#include "pch.h"
+#include "GBufferPixel.h"
+#include "Resources/ImageWriter.h"
+
+// Arbitrary output variables, written as separate layers next to the beauty image.
+enum class AOVType : int32_t {
+	Albedo = 0,
+	Normal,
+	Position,
+	UV,
+	Depth,
+	BoxChecks,
+	ShapeChecks,
+	COUNT
+};
+
+std::string to_string(AOVType type);
+// Layer name used in multi-layer image files.
+std::string GetAOVLayerName(AOVType type);
+int32_t GetAOVChannelsCount(AOVType type);
+
+// Per pixel averages of enabled AOVs. Disabled AOVs have no storage and are skipped by AddSample.
+// Each pixel is written only by the thread rendering its tile, same as film tiles before merging.
+class AOVBuffer {
+public:
+	AOVBuffer(glm::ivec2 resolution);
+
+	void Reset();
+	void Resize(glm::ivec2 resolution);
+	bool IsEnabled(AOVType type) const;
+	void SetEnabled(AOVType type, bool enabled);
+	bool HasEnabled() const;
+	void AddSample(int32_t x, int32_t y, const GBufferPixel& pixel);
+	// Averaged values of enabled AOV, channels past its channels count are zero.
+	Buffer2D<Vec3> GetLayer(AOVType type) const;
+	std::vector<ImageChannel> GetChannels() const;
+
+protected:
+	glm::ivec2 m_resolution;
+	uint32_t m_enabledMask = 0;
+	std::array<std::vector<Float>, (size_t)AOVType::COUNT> m_layers;
+	std::vector<uint32_t> m_samplesCount;
+
+	void AllocateLayers();
+};
@@ -444,34 +444,30 @@ BSDF::BSDF(const Material& material, const RayInteraction& intr) :
 	if (material.m_transparency > 0.0f) {
 		Float alpha = TrowbridgeReitzDistribution::RoughnessToAlpha(material.m_roughness);
 		TrowbridgeReitzDistribution distrib(alpha, alpha);
-		m_bxdf = new DielectricBxDF(material.m_refraction, distrib);
+		m_bxdf.emplace(std::in_place_type<DielectricBxDF>, material.m_refraction, distrib);
 	}
 	else if (material.m_metallic > 0.0f) {
 		Float alpha = TrowbridgeReitzDistribution::RoughnessToAlpha(material.m_roughness);
 		TrowbridgeReitzDistribution distrib(alpha, alpha);
-		m_bxdf = new ConductorBxDF(distrib, Vec3(1.0f), material.m_albedo * TwoPi);
+		m_bxdf.emplace(std::in_place_type<ConductorBxDF>, distrib, Vec3(1.0f), material.GetAlbedo(intr) * TwoPi);
 	}
 	else {
-		m_bxdf = new DiffuseBxDF(material.m_albedo);
+		m_bxdf.emplace(std::in_place_type<DiffuseBxDF>, material.GetAlbedo(intr));
 	}
 }
 
-BSDF::~BSDF() {
-	delete m_bxdf;
-}
-
 BSDF::operator bool() const {
-	return m_bxdf != nullptr;
+	return m_bxdf.has_value();
 }
 
 BxDFFlags BSDF::Flags() const {
-	return m_bxdf->Flags();
+	return std::visit([](const auto& bxdf) { return bxdf.Flags(); }, *m_bxdf);
 }
 
 Spectrum BSDF::SampleDistribution(Vec3 wo, Vec3 wi, TransportMode mode) const {
 	wo = m_frame.ToLocal(wo);
 	wi = m_frame.ToLocal(wi);
-	return m_bxdf->SampleDistribution(wo, wi, mode);
+	return std::visit([&](const auto& bxdf) { return bxdf.SampleDistribution(wo, wi, mode); }, *m_bxdf);
 }
 
 std::optional<BSDFSample> BSDF::SampleDirectionAndDistribution(Vec3 wo, Float u, Vec2 u2, TransportMode mode, BxDFReflTransFlags sampleFlags) const {
@@ -479,7 +475,7 @@ std::optional<BSDFSample> BSDF::SampleDirectionAndDistribution(Vec3 wo, Float u,
 		return {};
 	}
 	wo = m_frame.ToLocal(wo);
-	std::optional<BSDFSample> sample = m_bxdf->SampleDirectionAndDistribution(wo, u, u2, mode, sampleFlags);
+	std::optional<BSDFSample> sample = std::visit([&](const auto& bxdf) { return bxdf.SampleDirectionAndDistribution(wo, u, u2, mode, sampleFlags); }, *m_bxdf);
 	if (sample) {
 		sample->wi = m_frame.FromLocal(sample->wi);
 	}
@@ -489,14 +485,14 @@ std::optional<BSDFSample> BSDF::SampleDirectionAndDistribution(Vec3 wo, Float u,
 Float BSDF::PDF(Vec3 wo, Vec3 wi, TransportMode mode, BxDFReflTransFlags sampleFlags) const {
 	wo = m_frame.ToLocal(wo);
 	wi = m_frame.ToLocal(wi);
-	return m_bxdf->PDF(wo, wi, mode, sampleFlags);
+	return std::visit([&](const auto& bxdf) { return bxdf.PDF(wo, wi, mode, sampleFlags); }, *m_bxdf);
 }
 
 Spectrum BSDF::rho(Vec3 wo, const std::vector<Float>& uc, const std::vector<Vec2>& u) const {
 	wo = m_frame.ToLocal(wo);
-	return m_bxdf->rho(wo, uc, u);
+	return std::visit([&](const auto& bxdf) { return bxdf.rho(wo, uc, u); }, *m_bxdf);
 }
 
 void BSDF::Regularize() {
-	m_bxdf->Regularize();
+	std::visit([](auto& bxdf) { bxdf.Regularize(); }, *m_bxdf);
 }
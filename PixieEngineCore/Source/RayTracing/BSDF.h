@@ -79,7 +79,7 @@ public:
 	virtual void Regularize() {};
 };
 
-class DiffuseBxDF : public BxDF {
+class DiffuseBxDF final : public BxDF {
 public:
 	DiffuseBxDF(Spectrum spectrum);
 
@@ -92,7 +92,7 @@ protected:
 	Spectrum m_spectrum;
 };
 
-class DiffuseTransmissionBxDF : public BxDF {
+class DiffuseTransmissionBxDF final : public BxDF {
 public:
 	DiffuseTransmissionBxDF(Spectrum r, Spectrum t);
 	Spectrum SampleDistribution(Vec3 wo, Vec3 wi, TransportMode mode) const override;
@@ -104,7 +104,7 @@ private:
 	Spectrum m_r, m_t;
 };
 
-class ConductorBxDF : public BxDF {
+class ConductorBxDF final : public BxDF {
 public:
 	ConductorBxDF(const TrowbridgeReitzDistribution& mfDistrib, Spectrum eta, Spectrum k);
 
@@ -120,7 +120,7 @@ protected:
 	Spectrum m_k;
 };
 
-class DielectricBxDF : public BxDF {
+class DielectricBxDF final : public BxDF {
 public:
 	DielectricBxDF(Float refraction, TrowbridgeReitzDistribution mfDistrib);
 
@@ -135,10 +135,13 @@ protected:
 	Float m_refraction;
 };
 
+// BxDF is stored inline and called through std::visit, so creating a BSDF on every bounce does not allocate
+// and the final BxDF classes are dispatched statically.
+using BxDFVariant = std::variant<DiffuseBxDF, DiffuseTransmissionBxDF, ConductorBxDF, DielectricBxDF>;
+
 class BSDF {
 public:
 	BSDF(const Material& material, const RayInteraction& intr);
-	~BSDF();
 
 	BxDFFlags Flags() const;
 	Spectrum SampleDistribution(Vec3 wo, Vec3 wi, TransportMode mode = TransportMode::Importance) const;
@@ -150,6 +153,6 @@ public:
 	operator bool() const;
 
 protected:
-	BxDF* m_bxdf = nullptr;
+	std::optional<BxDFVariant> m_bxdf;
 	Frame m_frame = Frame::FromZ(Vec3(0, 0, 1));
 };
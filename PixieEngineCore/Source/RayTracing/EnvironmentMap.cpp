@@ -0,0 +1,132 @@
+#include "pch.h"
+#include "EnvironmentMap.h"
+#include "Parallel.h"
+#include "Resources/BinaryIO.h"
+
+EnvironmentMap::EnvironmentMap() :
+	m_image(glm::ivec2(0)) {}
+
+EnvironmentMap::EnvironmentMap(Buffer2D<Spectrum> image) :
+	m_image(std::move(image)) {
+	Buffer2D<Float> d(m_image.GetResolution());
+	ParallelFor((int32_t)d.GetSize(), [&](int32_t start, int32_t end) {
+		for (int32_t i = start; i < end; i++) {
+			d.m_data[i] = m_image.m_data[i].Average();
+		}
+	});
+	Float average = std::accumulate(d.m_data.begin(), d.m_data.end(), (Float)0) / (Float)std::max<size_t>(d.GetSize(), 1);
+	Bounds2f domain = Bounds2f(Vec2(0, 0), Vec2(1, 1));
+	m_distribution = PiecewiseConstant2D(d, domain);
+	bool allZero = true;
+	for (size_t i = 0; i < d.GetSize(); i++) {
+		d.m_data[i] = std::max<Float>(d.m_data[i] - average, 0.0f);
+		allZero &= d.m_data[i] == 0;
+	}
+	if (allZero) {
+		std::fill(d.m_data.begin(), d.m_data.end(), (Float)1);
+	}
+	m_compensatedDistribution = PiecewiseConstant2D(d, domain);
+}
+
+std::shared_ptr<const EnvironmentMap> EnvironmentMap::FromTexture(const Buffer2DTexture<Vec3>& texture) {
+	glm::ivec2 resolution = texture.GetResolution();
+	Buffer2D<Spectrum> image(resolution);
+	ParallelFor(resolution.y, [&](int32_t start, int32_t end) {
+		for (int32_t y = start; y < end; y++) {
+			for (int32_t x = 0; x < resolution.x; x++) {
+				image.SetValue(x, y, Spectrum(texture.GetPixel({ x, y })));
+			}
+		}
+	}, 16);
+	return std::make_shared<const EnvironmentMap>(std::move(image));
+}
+
+std::shared_ptr<const EnvironmentMap> EnvironmentMap::FromBuffer(const Buffer2D<Vec3>& buffer) {
+	glm::ivec2 resolution = buffer.m_resolution;
+	Buffer2D<Spectrum> image(resolution);
+	ParallelFor(resolution.y, [&](int32_t start, int32_t end) {
+		for (int32_t y = start; y < end; y++) {
+			for (int32_t x = 0; x < resolution.x; x++) {
+				image.SetValue(x, y, Spectrum(buffer.GetValue(x, y)));
+			}
+		}
+	}, 16);
+	return std::make_shared<const EnvironmentMap>(std::move(image));
+}
+
+std::shared_ptr<const EnvironmentMap> EnvironmentMap::LoadCached(const Buffer2D<Vec3>& buffer, uint64_t sourceHash, const std::filesystem::path& cacheDirectory) {
+	std::stringstream fileName;
+	fileName << std::hex << sourceHash << ".envmap";
+	std::filesystem::path path = cacheDirectory / fileName.str();
+	if (std::shared_ptr<const EnvironmentMap> environmentMap = Read(path, sourceHash)) {
+		return environmentMap;
+	}
+	std::shared_ptr<const EnvironmentMap> environmentMap = FromBuffer(buffer);
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory, error);
+	if (!environmentMap->Write(path, sourceHash)) {
+		std::cout << "Warning: Failed to write environment map cache: " << path << "\n";
+	}
+	return environmentMap;
+}
+
+const Buffer2D<Spectrum>& EnvironmentMap::GetImage() const {
+	return m_image;
+}
+
+const PiecewiseConstant2D& EnvironmentMap::GetDistribution() const {
+	return m_distribution;
+}
+
+const PiecewiseConstant2D& EnvironmentMap::GetCompensatedDistribution() const {
+	return m_compensatedDistribution;
+}
+
+bool EnvironmentMap::Write(const std::filesystem::path& path, uint64_t sourceHash) const {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	WriteBinary(file, c_fileMagic);
+	WriteBinary(file, c_fileVersion);
+	WriteBinary(file, (uint32_t)sizeof(Float));
+	WriteBinary(file, sourceHash);
+	WriteBinary(file, m_image.GetResolution());
+	std::vector<Vec3> pixels(m_image.GetSize());
+	for (size_t i = 0; i < pixels.size(); i++) {
+		pixels[i] = Spectrum(m_image.m_data[i]).GetRGB();
+	}
+	WriteBinary(file, pixels);
+	m_distribution.Write(file);
+	m_compensatedDistribution.Write(file);
+	return (bool)file;
+}
+
+std::shared_ptr<const EnvironmentMap> EnvironmentMap::Read(const std::filesystem::path& path, uint64_t sourceHash) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return nullptr;
+	}
+	uint32_t magic = 0, version = 0, floatSize = 0;
+	uint64_t hash = 0;
+	glm::ivec2 resolution;
+	if (!ReadBinary(file, magic) || !ReadBinary(file, version) || !ReadBinary(file, floatSize) || !ReadBinary(file, hash) || !ReadBinary(file, resolution)) {
+		return nullptr;
+	}
+	if (magic != c_fileMagic || version != c_fileVersion || floatSize != sizeof(Float) || hash != sourceHash) {
+		return nullptr;
+	}
+	std::vector<Vec3> pixels;
+	if (!ReadBinary(file, pixels) || pixels.size() != (size_t)resolution.x * resolution.y) {
+		return nullptr;
+	}
+	std::shared_ptr<EnvironmentMap> environmentMap(new EnvironmentMap());
+	environmentMap->m_image.Resize(resolution);
+	for (size_t i = 0; i < pixels.size(); i++) {
+		environmentMap->m_image.m_data[i] = Spectrum(pixels[i]);
+	}
+	if (!environmentMap->m_distribution.Read(file) || !environmentMap->m_compensatedDistribution.Read(file)) {
+		return nullptr;
+	}
+	return environmentMap;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "pch.h"
+#include "Spectrum.h"
+#include "Buffer2D.h"
+#include "Math/PiecewiseConstant.h"
+#include "Resources/Buffer2DTexture.h"
+
+// Radiance image of an image infinite light together with its sampling distributions. Built once per skybox and
+// shared read only by lights of all snapshots, so it is never modified after construction.
+class EnvironmentMap {
+public:
+	EnvironmentMap(Buffer2D<Spectrum> image);
+
+	static std::shared_ptr<const EnvironmentMap> FromTexture(const Buffer2DTexture<Vec3>& texture);
+	// Uses no OpenGL resources, so it can run on any thread.
+	static std::shared_ptr<const EnvironmentMap> FromBuffer(const Buffer2D<Vec3>& buffer);
+	// Reads map built from source with given content hash from cache directory, builds and stores it on a miss.
+	static std::shared_ptr<const EnvironmentMap> LoadCached(const Buffer2D<Vec3>& buffer, uint64_t sourceHash, const std::filesystem::path& cacheDirectory);
+
+	const Buffer2D<Spectrum>& GetImage() const;
+	const PiecewiseConstant2D& GetDistribution() const;
+	// Distribution of radiance above average, used when BSDF sampling already covers dim parts of the sky.
+	const PiecewiseConstant2D& GetCompensatedDistribution() const;
+
+	bool Write(const std::filesystem::path& path, uint64_t sourceHash) const;
+	static std::shared_ptr<const EnvironmentMap> Read(const std::filesystem::path& path, uint64_t sourceHash);
+
+protected:
+	static constexpr uint32_t c_fileMagic = 0x50454e56; // "PENV"
+	static constexpr uint32_t c_fileVersion = 1;
+
+	Buffer2D<Spectrum> m_image;
+	PiecewiseConstant2D m_distribution;
+	PiecewiseConstant2D m_compensatedDistribution;
+
+	EnvironmentMap();
+};
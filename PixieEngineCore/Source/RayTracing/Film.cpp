@@ -2,36 +2,74 @@
 #include "Film.h"
 
 Film::Film(glm::ivec2 resolution) :
-	m_resolution(resolution), m_pixelSize(Vec2(1.0f) / (Vec2)resolution), m_texture(resolution) {
+	m_resolution(resolution), m_pixelSize(Vec2(1.0f) / (Vec2)resolution), m_texture(resolution), m_halfBuffer(resolution) {
 	m_filter = new GaussianFilter(Vec2(4.0), 0.85f);
 }
 
 void Film::Reset() {
 	m_texture.Clear();
+	m_halfBuffer.Clear();
 }
 
 void Film::Resize(glm::ivec2 resolution) {
 	m_resolution = resolution;
 	m_pixelSize = Vec2(1.0f) / (Vec2)resolution;
 	m_texture.Resize(resolution);
+	m_halfBuffer.Resize(resolution);
 }
 
 void Film::SetSample(int32_t x, int32_t y, Spectrum L, Float weight) {
-	Vec3 rgb = L.GetRGB();
-	Float max = MaxComponent(rgb);
-	if (max > m_maxSampleBrightness) {
-		rgb *= m_maxSampleBrightness / max;
-	}
+	Vec3 rgb = ClampSample(L);
 	m_texture.SetPixel({ x, y }, glm::fvec4(rgb * weight, weight));
 }
 
-void Film::AddSample(int32_t x, int32_t y, Spectrum L, Float weight) {
-	Vec3 rgb = L.GetRGB();
-	Float max = MaxComponent(rgb);
-	if (max > m_maxSampleBrightness) {
-		rgb *= m_maxSampleBrightness / max;
-	}
+void Film::AddSample(int32_t x, int32_t y, Spectrum L, Float weight, int32_t sampleIndex) {
+	Vec3 rgb = ClampSample(L);
 	m_texture.AddPixel({ x, y }, glm::fvec4(rgb * weight, weight));
+	if (sampleIndex & 1) {
+		m_halfBuffer.SetValue(x, y, m_halfBuffer.GetValue(x, y) + Vec4(rgb * weight, weight));
+	}
+}
+
+FilmFilterSample Film::SampleFilter(Vec2 u) const {
+	if (m_splatSamples) {
+		return FilmFilterSample(u - Vec2(0.5f), 1.0f);
+	}
+	return m_filter->Sample(u);
+}
+
+void Film::StartTile(FilmTile& tile, const Bounds2i& tileBounds) const {
+	if (!m_splatSamples) {
+		tile.Reset(tileBounds);
+		return;
+	}
+	glm::ivec2 radius = glm::ivec2(glm::ceil(m_filter->Radius()));
+	tile.Reset(Bounds2i(glm::max(tileBounds.min - radius, glm::ivec2(0)), glm::min(tileBounds.max + radius, m_resolution)));
+}
+
+void Film::AddSample(FilmTile& tile, glm::ivec2 pPixel, Vec2 pFilm, Spectrum L, Float weight, int32_t sampleIndex) const {
+	Vec3 rgb = ClampSample(L);
+	if (m_splatSamples) {
+		tile.AddSplat(pFilm, rgb, m_filter, sampleIndex);
+	}
+	else {
+		tile.AddSample(pPixel, rgb, weight, sampleIndex);
+	}
+}
+
+void Film::MergeTile(const FilmTile& tile) {
+	const Bounds2i& bounds = tile.GetPixelBounds();
+	for (int32_t y = bounds.min.y; y < bounds.max.y; y++) {
+		for (int32_t x = bounds.min.x; x < bounds.max.x; x++) {
+			Vec4 pixel = tile.GetPixel({ x, y });
+			if (pixel.w == 0.0f) continue;
+			m_texture.AtomicAddPixel({ x, y }, pixel);
+			Vec4 halfPixel = tile.GetHalfPixel({ x, y });
+			if (halfPixel.w != 0.0f) {
+				m_halfBuffer.AtomicAddValue(x, y, halfPixel);
+			}
+		}
+	}
 }
 
 Vec2 Film::GetUV(int32_t x, int32_t y) const {
@@ -50,6 +88,41 @@ Vec2 Film::GetUV(Vec2 p, const Vec2& u) const {
 	return Vec2(p.x / m_resolution.x, p.y / m_resolution.y) + m_pixelSize * u;
 }
 
+Vec3 Film::GetPixelColor(int32_t x, int32_t y) const {
+	Vec4 pixel = m_texture.GetPixel({ x, y });
+	if (pixel.w == 0.0f) return Vec3(0.0f);
+	return Vec3(pixel) / pixel.w;
+}
+
+Float Film::GetPixelError(int32_t x, int32_t y) const {
+	Vec4 pixel = m_texture.GetPixel({ x, y });
+	Vec4 halfPixel = m_halfBuffer.GetValue(x, y);
+	if (halfPixel.w == 0.0f || pixel.w == halfPixel.w) return Infinity;
+	Vec3 color = Vec3(pixel) / pixel.w;
+	Vec3 halfColor = Vec3(halfPixel) / halfPixel.w;
+	Vec3 difference = glm::abs(color - halfColor);
+	return (difference.x + difference.y + difference.z) / (0.0001f + std::sqrt(color.x + color.y + color.z));
+}
+
+Buffer2D<Vec3> Film::GetImage() const {
+	Buffer2D<Vec3> image(m_resolution);
+	for (int32_t y = 0; y < m_resolution.y; y++) {
+		for (int32_t x = 0; x < m_resolution.x; x++) {
+			image.SetValue(x, y, GetPixelColor(x, y));
+		}
+	}
+	return image;
+}
+
 FilmFilter* Film::GetFilter() {
 	return m_filter;
 }
+
+Vec3 Film::ClampSample(Spectrum L) const {
+	Vec3 rgb = L.GetRGB();
+	Float max = MaxComponent(rgb);
+	if (max > m_maxSampleBrightness) {
+		rgb *= m_maxSampleBrightness / max;
+	}
+	return rgb;
+}
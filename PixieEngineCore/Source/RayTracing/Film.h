@@ -1,26 +1,44 @@
 #pragma once
 #include "Resources/Buffer2DTexture.h"
 #include "FilmFilters.h"
+#include "FilmTile.h"
 
 class Film {
 public:
 	Buffer2DTexture<Vec4> m_texture;
+	// Accumulates odd samples only, difference between it and the full estimate is used as pixel error.
+	Buffer2D<Vec4> m_halfBuffer;
 	glm::ivec2 m_resolution;
 	Vec2 m_pixelSize;
 	FilmFilter* m_filter;
 	Float m_maxSampleBrightness = 128.0f;
+	// Samples are splatted to all pixels within filter radius instead of importance sampling filter offsets.
+	bool m_splatSamples = false;
 
 	Film(glm::ivec2 resolution);
 
 	void Reset();
 	void Resize(glm::ivec2 resolution);
 	void SetSample(int32_t x, int32_t y, Spectrum L, Float weight);
-	void AddSample(int32_t x, int32_t y, Spectrum L, Float weight);
+	void AddSample(int32_t x, int32_t y, Spectrum L, Float weight, int32_t sampleIndex = 0);
+	// Offset from pixel center, uniform over the pixel in splat mode since the filter is applied when splatting.
+	FilmFilterSample SampleFilter(Vec2 u) const;
+	void StartTile(FilmTile& tile, const Bounds2i& tileBounds) const;
+	void AddSample(FilmTile& tile, glm::ivec2 pPixel, Vec2 pFilm, Spectrum L, Float weight, int32_t sampleIndex) const;
+	// Tiles may overlap in splat mode or be rendered by several threads, so merging uses atomic adds.
+	void MergeTile(const FilmTile& tile);
 
 	Vec2 GetUV(int32_t x, int32_t y) const;
 	Vec2 GetUV(int32_t x, int32_t y, const Vec2& u) const;
 	Vec2 GetUV(Vec2 p) const;
 	Vec2 GetUV(Vec2 p, const Vec2& u) const;
+	Vec3 GetPixelColor(int32_t x, int32_t y) const;
+	// Relative error estimate from both halves of samples, infinite until each half has a sample.
+	Float GetPixelError(int32_t x, int32_t y) const;
+	Buffer2D<Vec3> GetImage() const;
 
 	FilmFilter* GetFilter();
+
+protected:
+	Vec3 ClampSample(Spectrum L) const;
 };
@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "FilmTile.h"
+
+void FilmTile::Reset(const Bounds2i& pixelBounds) {
+	m_pixelBounds = pixelBounds;
+	glm::ivec2 size = pixelBounds.Diagonal();
+	size_t pixelsCount = (size_t)std::max(size.x, 0) * std::max(size.y, 0);
+	m_pixels.assign(pixelsCount, Vec4(0.0f));
+	m_halfPixels.assign(pixelsCount, Vec4(0.0f));
+}
+
+void FilmTile::AddSample(glm::ivec2 p, Vec3 rgb, Float weight, int32_t sampleIndex) {
+	int32_t index = GetIndex(p);
+	m_pixels[index] += Vec4(rgb * weight, weight);
+	if (sampleIndex & 1) {
+		m_halfPixels[index] += Vec4(rgb * weight, weight);
+	}
+}
+
+void FilmTile::AddSplat(Vec2 pFilm, Vec3 rgb, const FilmFilter* filter, int32_t sampleIndex) {
+	Vec2 radius = filter->Radius();
+	// Pixel centers are at half integer coordinates.
+	Vec2 pDiscrete = pFilm - Vec2(0.5f);
+	glm::ivec2 p0 = glm::max(glm::ivec2(glm::ceil(pDiscrete - radius)), m_pixelBounds.min);
+	glm::ivec2 p1 = glm::min(glm::ivec2(glm::floor(pDiscrete + radius)) + glm::ivec2(1), m_pixelBounds.max);
+	for (int32_t y = p0.y; y < p1.y; y++) {
+		for (int32_t x = p0.x; x < p1.x; x++) {
+			Float weight = filter->Evaluate(Vec2(x, y) - pDiscrete);
+			if (weight == 0.0f) continue;
+			AddSample(glm::ivec2(x, y), rgb, weight, sampleIndex);
+		}
+	}
+}
+
+const Bounds2i& FilmTile::GetPixelBounds() const {
+	return m_pixelBounds;
+}
+
+Vec4 FilmTile::GetPixel(glm::ivec2 p) const {
+	return m_pixels[GetIndex(p)];
+}
+
+Vec4 FilmTile::GetHalfPixel(glm::ivec2 p) const {
+	return m_halfPixels[GetIndex(p)];
+}
+
+int32_t FilmTile::GetIndex(glm::ivec2 p) const {
+	return (p.y - m_pixelBounds.min.y) * (m_pixelBounds.max.x - m_pixelBounds.min.x) + (p.x - m_pixelBounds.min.x);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "pch.h"
+#include "Math/Bounds.h"
+#include "FilmFilters.h"
+
+// Thread private accumulation buffer of one tile, merged into the film once the tile is finished.
+// In splat mode samples contribute to every pixel within filter radius, so pixel bounds extend past the tile.
+class FilmTile {
+public:
+	FilmTile() = default;
+
+	void Reset(const Bounds2i& pixelBounds);
+	void AddSample(glm::ivec2 p, Vec3 rgb, Float weight, int32_t sampleIndex);
+	void AddSplat(Vec2 pFilm, Vec3 rgb, const FilmFilter* filter, int32_t sampleIndex);
+	const Bounds2i& GetPixelBounds() const;
+	Vec4 GetPixel(glm::ivec2 p) const;
+	Vec4 GetHalfPixel(glm::ivec2 p) const;
+
+protected:
+	Bounds2i m_pixelBounds;
+	std::vector<Vec4> m_pixels;
+	// Odd samples only, same as Film::m_halfBuffer.
+	std::vector<Vec4> m_halfPixels;
+
+	int32_t GetIndex(glm::ivec2 p) const;
+};
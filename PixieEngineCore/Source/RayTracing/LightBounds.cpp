@@ -1,15 +1,59 @@
 #include "pch.h"
 #include "LightBounds.h"
 
-LightBounds::LightBounds(const Bounds3f& b, Vec3 w, Float phi, Float cosTheta_o, Float cosTheta_e) :
-    bounds(b), w(w), phi(phi), cosTheta_o(cosTheta_o), cosTheta_e(cosTheta_e) {}
+LightBounds::LightBounds(const Bounds3f& b, Vec3 w, Float phi, Float cosTheta_o, Float cosTheta_e, bool twoSided) :
+    bounds(b), w(w), phi(phi), cosTheta_o(cosTheta_o), cosTheta_e(cosTheta_e), twoSided(twoSided) {}
 
 Vec3 LightBounds::Centroid() const { 
 	return (bounds.min + bounds.max) / (Float)2;
 }
 
+// cos(max(0, a - b)) and sin(max(0, a - b)) from sines and cosines of both angles.
+static inline Float CosSubClamped(Float sinTheta_a, Float cosTheta_a, Float sinTheta_b, Float cosTheta_b) {
+    if (cosTheta_a > cosTheta_b) {
+        return 1;
+    }
+    return cosTheta_a * cosTheta_b + sinTheta_a * sinTheta_b;
+}
+
+static inline Float SinSubClamped(Float sinTheta_a, Float cosTheta_a, Float sinTheta_b, Float cosTheta_b) {
+    if (cosTheta_a > cosTheta_b) {
+        return 0;
+    }
+    return sinTheta_a * cosTheta_b - cosTheta_a * sinTheta_b;
+}
+
 Float LightBounds::Importance(Vec3 p, Vec3 n) const {
-    return 0;
+    Vec3 pc = Centroid();
+    Float d2 = glm::length2(p - pc);
+    d2 = std::max(d2, glm::length(bounds.Diagonal()) / 2);
+
+    Vec3 wi = glm::normalize(p - pc);
+    Float cosTheta_w = glm::dot(w, wi);
+    if (twoSided) {
+        cosTheta_w = std::abs(cosTheta_w);
+    }
+    Float sinTheta_w = SafeSqrt(1 - Sqr(cosTheta_w));
+
+    Float cosTheta_b = BoundSubtendedDirections(bounds, p).cosTheta;
+    Float sinTheta_b = SafeSqrt(1 - Sqr(cosTheta_b));
+
+    // Minimal angle between emitter normal and direction to p, reduced by normal cone and bounds extent.
+    Float sinTheta_o = SafeSqrt(1 - Sqr(cosTheta_o));
+    Float cosTheta_x = CosSubClamped(sinTheta_w, cosTheta_w, sinTheta_o, cosTheta_o);
+    Float sinTheta_x = SinSubClamped(sinTheta_w, cosTheta_w, sinTheta_o, cosTheta_o);
+    Float cosThetap = CosSubClamped(sinTheta_x, cosTheta_x, sinTheta_b, cosTheta_b);
+    if (cosThetap <= cosTheta_e) {
+        return 0;
+    }
+
+    Float importance = phi * cosThetap / d2;
+    if (n != Vec3(0.0f)) {
+        Float cosTheta_i = AbsDot(wi, n);
+        Float sinTheta_i = SafeSqrt(1 - Sqr(cosTheta_i));
+        importance *= CosSubClamped(sinTheta_i, cosTheta_i, sinTheta_b, cosTheta_b);
+    }
+    return std::max<Float>(importance, 0);
 }
 
 LightBounds Union(const LightBounds& a, const LightBounds& b) {
@@ -20,5 +64,5 @@ LightBounds Union(const LightBounds& a, const LightBounds& b) {
     Float cosTheta_o = cone.cosTheta;
     Float cosTheta_e = std::min(a.cosTheta_e, b.cosTheta_e);
 
-    return LightBounds(Union(a.bounds, b.bounds), cone.w, a.phi + b.phi, cosTheta_o, cosTheta_e);
+    return LightBounds(Union(a.bounds, b.bounds), cone.w, a.phi + b.phi, cosTheta_o, cosTheta_e, a.twoSided || b.twoSided);
 }
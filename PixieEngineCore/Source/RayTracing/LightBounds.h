@@ -9,10 +9,12 @@ struct LightBounds {
     Float phi = 0.0f;
     Float cosTheta_o = 0.0f;
     Float cosTheta_e = 0.0f;
+    bool twoSided = false;
 
-    LightBounds(const Bounds3f& b, Vec3 w, Float phi, Float cosTheta_o,  Float cosTheta_e);
+    LightBounds(const Bounds3f& b, Vec3 w, Float phi, Float cosTheta_o,  Float cosTheta_e, bool twoSided);
 
     Vec3 Centroid() const;
+    // Conservative estimate of light arriving at point p with normal n, zero normal means no orientation.
     Float Importance(Vec3 p, Vec3 n) const;
 };
 
@@ -1,6 +1,15 @@
 #include "pch.h"
 #include "LightSamplers.h"
 
+std::string to_string(LightSamplerType type) {
+    switch (type) {
+    case LightSamplerType::Uniform: return "Uniform";
+    case LightSamplerType::Power: return "Power";
+    case LightSamplerType::BVH: return "BVH";
+    default: return "Undefined Light Sampler";
+    }
+}
+
 /*
     Sampled Light
 */
@@ -91,3 +100,206 @@ int32_t PowerLightSampler::LightToIndex(const Light* light) const {
     }
     return -1;
 }
+
+/*
+    BVH Light Sampler
+*/
+
+// Below this depth nodes are split in the middle, so bit trails never exceed 64 levels.
+constexpr int32_t MaxLightBVHSAHDepth = 32;
+
+BVHLightSampler::LightBVHNode::LightBVHNode(const LightBounds& lightBounds, int32_t childOrLightIndex, bool isLeaf) :
+    lightBounds(lightBounds), childOrLightIndex(childOrLightIndex), isLeaf(isLeaf) {}
+
+BVHLightSampler::BVHLightSampler(const std::vector<Light*>& lights) :
+    m_lights(lights) {
+    std::vector<std::pair<int32_t, LightBounds>> bvhLights;
+    for (size_t i = 0; i < lights.size(); i++) {
+        std::optional<LightBounds> lightBounds = lights[i]->GetLightBounds();
+        if (!lightBounds) {
+            m_infiniteLights.push_back(lights[i]);
+        }
+        else if (lightBounds->phi > 0) {
+            bvhLights.push_back({ (int32_t)i, *lightBounds });
+        }
+    }
+    if (!bvhLights.empty()) {
+        BuildBVH(bvhLights, 0, (int32_t)bvhLights.size(), 0, 0);
+    }
+}
+
+std::optional<SampledLight> BVHLightSampler::Sample(const LightSampleContext& context, Float u) const {
+    Float pInfinite = GetInfiniteLightsProbability();
+    if (u < pInfinite) {
+        u /= pInfinite;
+        int32_t index = std::min((int32_t)(u * m_infiniteLights.size()), (int32_t)m_infiniteLights.size() - 1);
+        return SampledLight(m_infiniteLights[index], pInfinite / m_infiniteLights.size());
+    }
+    if (m_nodes.empty()) {
+        return {};
+    }
+
+    u = std::min((u - pInfinite) / (1 - pInfinite), OneMinusEpsilon);
+    Float pmf = 1 - pInfinite;
+    int32_t nodeIndex = 0;
+    while (true) {
+        const LightBVHNode& node = m_nodes[nodeIndex];
+        if (node.isLeaf) {
+            if (nodeIndex > 0 || node.lightBounds.Importance(context.position, context.normal) > 0) {
+                return SampledLight(m_lights[node.childOrLightIndex], pmf);
+            }
+            return {};
+        }
+
+        int32_t children[2] = { nodeIndex + 1, node.childOrLightIndex };
+        Float importance0 = m_nodes[children[0]].lightBounds.Importance(context.position, context.normal);
+        Float importance1 = m_nodes[children[1]].lightBounds.Importance(context.position, context.normal);
+        if (importance0 == 0 && importance1 == 0) {
+            return {};
+        }
+        Float p0 = importance0 / (importance0 + importance1);
+        if (u < p0) {
+            u = std::min(u / p0, OneMinusEpsilon);
+            pmf *= p0;
+            nodeIndex = children[0];
+        }
+        else {
+            u = std::min((u - p0) / (1 - p0), OneMinusEpsilon);
+            pmf *= 1 - p0;
+            nodeIndex = children[1];
+        }
+    }
+}
+
+std::optional<SampledLight> BVHLightSampler::Sample(Float u) const {
+    if (m_lights.empty()) {
+        return {};
+    }
+    int32_t lightIndex = std::min<int32_t>((int32_t)(u * m_lights.size()), (int32_t)m_lights.size() - 1);
+    return SampledLight(m_lights[lightIndex], 1.0f / m_lights.size());
+}
+
+Float BVHLightSampler::PMF(const LightSampleContext& context, const Light* light) const {
+    auto it = m_lightToBitTrail.find(light);
+    if (it == m_lightToBitTrail.end()) {
+        if (std::find(m_infiniteLights.begin(), m_infiniteLights.end(), light) == m_infiniteLights.end()) {
+            return 0;
+        }
+        return GetInfiniteLightsProbability() / m_infiniteLights.size();
+    }
+
+    uint64_t bitTrail = it->second;
+    Float pmf = 1 - GetInfiniteLightsProbability();
+    int32_t nodeIndex = 0;
+    while (true) {
+        const LightBVHNode& node = m_nodes[nodeIndex];
+        if (node.isLeaf) {
+            return pmf;
+        }
+        int32_t children[2] = { nodeIndex + 1, node.childOrLightIndex };
+        Float importance0 = m_nodes[children[0]].lightBounds.Importance(context.position, context.normal);
+        Float importance1 = m_nodes[children[1]].lightBounds.Importance(context.position, context.normal);
+        if (importance0 == 0 && importance1 == 0) {
+            return 0;
+        }
+        int32_t child = bitTrail & 1;
+        pmf *= (child ? importance1 : importance0) / (importance0 + importance1);
+        nodeIndex = children[child];
+        bitTrail >>= 1;
+    }
+}
+
+Float BVHLightSampler::PMF(const Light* light) const {
+    if (m_lights.empty()) {
+        return 0;
+    }
+    return 1.0f / m_lights.size();
+}
+
+int32_t BVHLightSampler::BuildBVH(std::vector<std::pair<int32_t, LightBounds>>& bvhLights, int32_t start, int32_t end, uint64_t bitTrail, int32_t depth) {
+    if (end - start == 1) {
+        int32_t nodeIndex = (int32_t)m_nodes.size();
+        m_nodes.emplace_back(bvhLights[start].second, bvhLights[start].first, true);
+        m_lightToBitTrail[m_lights[bvhLights[start].first]] = bitTrail;
+        return nodeIndex;
+    }
+
+    Bounds3f bounds, centroidBounds;
+    for (int32_t i = start; i < end; i++) {
+        const LightBounds& lightBounds = bvhLights[i].second;
+        bounds = Union(bounds, lightBounds.bounds);
+        centroidBounds = Union(centroidBounds, lightBounds.Centroid());
+    }
+
+    Float minCost = Infinity;
+    int32_t minCostSplitBucket = -1, minCostSplitDimension = -1;
+    for (int32_t dimension = 0; dimension < 3 && depth < MaxLightBVHSAHDepth; dimension++) {
+        if (centroidBounds.max[dimension] == centroidBounds.min[dimension]) {
+            continue;
+        }
+        std::vector<std::optional<LightBounds>> buckets(c_bucketsCount);
+        for (int32_t i = start; i < end; i++) {
+            const LightBounds& lightBounds = bvhLights[i].second;
+            int32_t b = (int32_t)(c_bucketsCount * centroidBounds.Offset(lightBounds.Centroid())[dimension]);
+            b = std::clamp(b, 0, c_bucketsCount - 1);
+            buckets[b] = buckets[b] ? Union(*buckets[b], lightBounds) : lightBounds;
+        }
+
+        for (int32_t split = 0; split < c_bucketsCount - 1; split++) {
+            std::optional<LightBounds> below, above;
+            for (int32_t i = 0; i <= split; i++) {
+                if (buckets[i]) below = below ? Union(*below, *buckets[i]) : *buckets[i];
+            }
+            for (int32_t i = split + 1; i < c_bucketsCount; i++) {
+                if (buckets[i]) above = above ? Union(*above, *buckets[i]) : *buckets[i];
+            }
+            Float cost = (below ? EvaluateCost(*below, bounds, dimension) : 0) + (above ? EvaluateCost(*above, bounds, dimension) : 0);
+            if (cost > 0 && cost < minCost) {
+                minCost = cost;
+                minCostSplitBucket = split;
+                minCostSplitDimension = dimension;
+            }
+        }
+    }
+
+    int32_t mid;
+    if (minCostSplitDimension == -1) {
+        mid = (start + end) / 2;
+    }
+    else {
+        auto midIter = std::partition(bvhLights.begin() + start, bvhLights.begin() + end, [&](const std::pair<int32_t, LightBounds>& light) {
+            int32_t b = (int32_t)(c_bucketsCount * centroidBounds.Offset(light.second.Centroid())[minCostSplitDimension]);
+            return std::clamp(b, 0, c_bucketsCount - 1) <= minCostSplitBucket;
+            });
+        mid = (int32_t)(midIter - bvhLights.begin());
+        if (mid == start || mid == end) {
+            mid = (start + end) / 2;
+        }
+    }
+
+    int32_t nodeIndex = (int32_t)m_nodes.size();
+    m_nodes.emplace_back(bvhLights[start].second, 0, false);
+    BuildBVH(bvhLights, start, mid, bitTrail, depth + 1);
+    int32_t secondChild = BuildBVH(bvhLights, mid, end, bitTrail | (1ull << depth), depth + 1);
+    m_nodes[nodeIndex].lightBounds = Union(m_nodes[nodeIndex + 1].lightBounds, m_nodes[secondChild].lightBounds);
+    m_nodes[nodeIndex].childOrLightIndex = secondChild;
+    return nodeIndex;
+}
+
+// Surface area heuristic extended with the solid angle of emission directions and box aspect ratio.
+Float BVHLightSampler::EvaluateCost(const LightBounds& b, const Bounds3f& bounds, int32_t dimension) const {
+    Float theta_o = SafeACos(b.cosTheta_o), theta_e = SafeACos(b.cosTheta_e);
+    Float theta_w = std::min(theta_o + theta_e, Pi);
+    Float sinTheta_o = SafeSqrt(1 - Sqr(b.cosTheta_o));
+    Float M_omega = 2 * Pi * (1 - b.cosTheta_o) + Pi / 2 * (2 * theta_w * sinTheta_o - std::cos(theta_o - 2 * theta_w) - 2 * theta_o * sinTheta_o + b.cosTheta_o);
+    Vec3 diagonal = bounds.Diagonal();
+    Float Kr = MaxComponent(diagonal) / diagonal[dimension];
+    return b.phi * M_omega * Kr * b.bounds.Area();
+}
+
+Float BVHLightSampler::GetInfiniteLightsProbability() const {
+    if (m_infiniteLights.empty()) {
+        return 0;
+    }
+    return (Float)m_infiniteLights.size() / (m_infiniteLights.size() + (m_nodes.empty() ? 0 : 1));
+}
@@ -1,8 +1,18 @@
 #pragma once
 #include "pch.h"
 #include "Lights.h"
+#include "LightBounds.h"
 #include "Math/AliasTable.h"
 
+enum class LightSamplerType : int32_t {
+	Uniform = 0,
+	Power,
+	BVH,
+	COUNT
+};
+
+std::string to_string(LightSamplerType type);
+
 struct SampledLight {
 	Light* light = nullptr; // Sampled light source.
 	Float p = 0.0f; // Probability to sample light source.
@@ -13,6 +23,8 @@ struct SampledLight {
 
 class LightSampler {
 public:
+	virtual ~LightSampler() = default;
+
 	virtual std::optional<SampledLight> Sample(const LightSampleContext& context, Float u) const = 0;
 	virtual std::optional<SampledLight> Sample(Float u) const = 0;
 	virtual Float PMF(const LightSampleContext& context, const Light* light) const = 0;
@@ -49,3 +61,37 @@ protected:
 
 	int32_t LightToIndex(const Light* light) const;
 };
+
+// Samples lights with bounds by descending a BVH over their LightBounds, choosing children proportionally to their importance
+// for the shading point. Lights without bounds are sampled uniformly, with the whole BVH counted as a single extra light.
+class BVHLightSampler : public LightSampler {
+public:
+	BVHLightSampler(const std::vector<Light*>& lights);
+
+	std::optional<SampledLight> Sample(const LightSampleContext& context, Float u) const override;
+	std::optional<SampledLight> Sample(Float u) const override;
+	Float PMF(const LightSampleContext& context, const Light* light) const override;
+	Float PMF(const Light* light) const override;
+
+protected:
+	// Interior node second child follows its subtree, the first one is the next node.
+	struct LightBVHNode {
+		LightBounds lightBounds;
+		int32_t childOrLightIndex = 0;
+		bool isLeaf = false;
+
+		LightBVHNode(const LightBounds& lightBounds, int32_t childOrLightIndex, bool isLeaf);
+	};
+
+	static constexpr int32_t c_bucketsCount = 12;
+
+	const std::vector<Light*>& m_lights;
+	std::vector<Light*> m_infiniteLights;
+	std::vector<LightBVHNode> m_nodes;
+	// Path from the root to the light leaf, bit per level set when the second child is taken.
+	std::unordered_map<const Light*, uint64_t> m_lightToBitTrail;
+
+	int32_t BuildBVH(std::vector<std::pair<int32_t, LightBounds>>& bvhLights, int32_t start, int32_t end, uint64_t bitTrail, int32_t depth);
+	Float EvaluateCost(const LightBounds& b, const Bounds3f& bounds, int32_t dimension) const;
+	Float GetInfiniteLightsProbability() const;
+};
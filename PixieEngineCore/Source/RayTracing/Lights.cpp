@@ -47,6 +47,10 @@ Spectrum Light::Le(const Ray& ray) const {
 	return Spectrum();
 }
 
+std::optional<LightBounds> Light::GetLightBounds() const {
+	return {};
+}
+
 LightType Light::Type() const {
 	return m_type;
 }
@@ -98,6 +102,12 @@ Bounds3f PointLight::Bounds() const {
 	return Bounds3f();
 }
 
+std::optional<LightBounds> PointLight::GetLightBounds() const {
+	Vec3 p = m_transform.ApplyPoint(Vec3(0.0f));
+	Float phi = 4 * Pi * m_scale * m_spectrum.MaxComponent();
+	return LightBounds(Bounds3f(p), Vec3(0, 0, 1), phi, -1.0f, 0.0f, false);
+}
+
 /*
 	Spot Light
 */
@@ -269,6 +279,13 @@ Bounds3f DiffuseAreaLight::Bounds() const {
 	return m_shape->Bounds();
 }
 
+std::optional<LightBounds> DiffuseAreaLight::GetLightBounds() const {
+	// Radiant flux of two sided emission, L * Area * Pi per side as in pbrt.
+	Float phi = 2.0f * Pi * m_shape->Area() * L(Vec3(0.0f), Vec3(0.0f), Vec2(0.0f), Vec3(0.0f)).MaxComponent();
+	DirectionCone normalBounds = m_shape->NormalBounds();
+	return LightBounds(m_transform.ApplyBounds(m_shape->Bounds()), normalBounds.w, phi, normalBounds.cosTheta, 0.0f, true);
+}
+
 /*
 	Uniform Infinite Lights
 */
@@ -398,33 +415,10 @@ Spectrum GradientInfiniteLight::GetSpectrum(Vec3 direction) const {
 */
 
 ImageInfiniteLight::ImageInfiniteLight(Transform renderFromLight, Buffer2D<Spectrum> image, Float scale) :
-	Light(LightType::Infinite, renderFromLight), image(image), scale(scale) {
-	Buffer2D<Float> d(image.GetResolution());
-	Float average = 0.0f;
-	for (size_t i = 0; i < image.GetSize(); i++) {
-		d.m_data[i] = image.m_data[i].Average();
-		average += d.m_data[i];
-	}
-	average /= (Float)image.GetSize();
-	Bounds2f domain = Bounds2f(Vec2(0, 0), Vec2(1, 1));
-	distribution = PiecewiseConstant2D(d, domain);
-	for (size_t i = 0; i < d.GetSize(); i++) {
-		d.m_data[i] = glm::max(d.m_data[i] - average, 0.0f);
-	}
-	bool allZero = true;
-	for (size_t i = 0; i < d.GetSize(); i++) {
-		if (d.m_data[i] > 0) {
-			allZero = false;
-			break;
-		}
-	}
-	if (allZero) {
-		for (size_t i = 0; i < d.GetSize(); i++) {
-			d.m_data[i] = 1.0f;
-		}
-	}
-	compensatedDistribution = PiecewiseConstant2D(d, domain);
-}
+	ImageInfiniteLight(renderFromLight, std::make_shared<const EnvironmentMap>(std::move(image)), scale) {}
+
+ImageInfiniteLight::ImageInfiniteLight(Transform renderFromLight, std::shared_ptr<const EnvironmentMap> environmentMap, Float scale) :
+	Light(LightType::Infinite, renderFromLight), environmentMap(environmentMap), scale(scale) {}
 
 void ImageInfiniteLight::Preprocess(const Bounds3f& sceneBounds) {
 	sceneBounds.BoundingSphere(&sceneCenter, &sceneRadius);
@@ -432,6 +426,7 @@ void ImageInfiniteLight::Preprocess(const Bounds3f& sceneBounds) {
 
 Spectrum ImageInfiniteLight::Phi() const {
 	Spectrum sumL(0.0f);
+	const Buffer2D<Spectrum>& image = environmentMap->GetImage();
 	int32_t width = image.GetResolution().x;
 	int32_t height = image.GetResolution().y;
 	for (int32_t v = 0; v < height; v++) {
@@ -448,10 +443,10 @@ Float ImageInfiniteLight::SampleLiPDF(LightSampleContext, Vec3 w, bool allowInco
 	Vec2 uv = EqualAreaSphereToSquare(wLight);
 	Float pdf = 0;
 	if (allowIncompletePDF) {
-		pdf = compensatedDistribution.PDF(uv);
+		pdf = environmentMap->GetCompensatedDistribution().PDF(uv);
 	}
 	else {
-		pdf = distribution.PDF(uv);
+		pdf = environmentMap->GetDistribution().PDF(uv);
 	}
 	return pdf / (4.0f * Pi);
 }
@@ -459,7 +454,7 @@ Float ImageInfiniteLight::SampleLiPDF(LightSampleContext, Vec3 w, bool allowInco
 
 std::optional<LightLeSample> ImageInfiniteLight::SampleLe(Vec2 u1, Vec2 u2) const {
 	Float mapPDF;
-	std::optional<Vec2> uv = distribution.Sample(u1, &mapPDF);
+	std::optional<Vec2> uv = environmentMap->GetDistribution().Sample(u1, &mapPDF);
 	if (!uv) {
 		return {};
 	}
@@ -479,7 +474,7 @@ std::optional<LightLeSample> ImageInfiniteLight::SampleLe(Vec2 u1, Vec2 u2) cons
 
 void ImageInfiniteLight::SampleLePDF(const Ray& ray, Float* pdfPos, Float* pdfDir) const {
 	Vec3 wl = -m_transform.ApplyInverseVector(ray.direction);
-	Float mapPDF = distribution.PDF(EqualAreaSphereToSquare(wl));
+	Float mapPDF = environmentMap->GetDistribution().PDF(EqualAreaSphereToSquare(wl));
 	*pdfDir = mapPDF / (4.0f * Pi);
 	*pdfPos = 1.0f / (Pi * Sqr(sceneRadius));
 }
@@ -498,10 +493,10 @@ std::optional<LightLiSample> ImageInfiniteLight::SampleLi(LightSampleContext ctx
 	Float mapPDF = 0;
 	Vec2 uv;
 	if (allowIncompletePDF) {
-		uv = compensatedDistribution.Sample(u, &mapPDF);
+		uv = environmentMap->GetCompensatedDistribution().Sample(u, &mapPDF);
 	}
 	else {
-		uv = distribution.Sample(u, &mapPDF);
+		uv = environmentMap->GetDistribution().Sample(u, &mapPDF);
 	}
 	if (mapPDF == 0) {
 		return {};
@@ -520,6 +515,7 @@ Bounds3f ImageInfiniteLight::Bounds() const {
 }
 
 Spectrum ImageInfiniteLight::ImageLe(Vec2 uv) const {
+	const Buffer2D<Spectrum>& image = environmentMap->GetImage();
 	Spectrum rgb = image.GetValue(glm::ivec2(uv * Vec2(image.GetResolution() - glm::ivec2(1, 1))));
 	return scale * rgb;
 }
\ No newline at end of file
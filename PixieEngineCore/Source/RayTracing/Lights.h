@@ -4,6 +4,8 @@
 #include "Ray.h"
 #include "RayInteraction.h"
 #include "Shapes.h"
+#include "LightBounds.h"
+#include "EnvironmentMap.h"
 #include "Math/Bounds.h"
 #include "Math/Transform.h"
 #include "Math/PiecewiseConstant.h"
@@ -68,6 +70,8 @@ public:
 	// Sample infinite area light.
 	virtual Spectrum Le(const Ray& ray) const;
 	virtual Bounds3f Bounds() const = 0;
+	// Spatial and directional emission bounds used by light BVH, lights without them are sampled as infinite.
+	virtual std::optional<LightBounds> GetLightBounds() const;
 	virtual LightType Type() const;
 	virtual void Preprocess(const Bounds3f& sceneBounds);
 
@@ -89,6 +93,7 @@ public:
 	void SampleLePDF(const Ray& ray, Float* pdfPos, Float* pdfDir) const override;
 	void SampleLePDF(const RayInteraction& intr, Vec3 w, Float* pdfPos, Float* pdfDir) const override;
 	Bounds3f Bounds() const;
+	std::optional<LightBounds> GetLightBounds() const override;
 
 protected:
 	Spectrum m_spectrum;
@@ -145,6 +150,7 @@ public:
 	void SampleLePDF(const Ray& ray, Float* pdfPos, Float* pdfDir) const override;
 	void SampleLePDF(const RayInteraction& intr, Vec3 w, Float* pdfPos, Float* pdfDir) const override;
 	Bounds3f Bounds() const override;
+	std::optional<LightBounds> GetLightBounds() const override;
 
 protected:
 	const Shape* m_shape;
@@ -199,6 +205,7 @@ protected:
 class ImageInfiniteLight : public Light {
 public:
 	ImageInfiniteLight(Transform renderFromLight, Buffer2D<Spectrum> image, Float scale);
+	ImageInfiniteLight(Transform renderFromLight, std::shared_ptr<const EnvironmentMap> environmentMap, Float scale);
 
 	void Preprocess(const Bounds3f& sceneBounds) override;
 	Spectrum Phi() const override;
@@ -212,12 +219,10 @@ public:
 	Bounds3f Bounds() const override;
 
 private:
-	Buffer2D<Spectrum> image;
+	std::shared_ptr<const EnvironmentMap> environmentMap;
 	Float scale;
 	Vec3 sceneCenter;
 	Float sceneRadius;
-	PiecewiseConstant2D distribution;
-	PiecewiseConstant2D compensatedDistribution;
 
 	Spectrum ImageLe(Vec2 uv) const;
 };
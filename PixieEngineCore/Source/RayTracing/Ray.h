@@ -6,6 +6,9 @@ struct Ray {
 	Vec3 origin;
 	Vec3 direction;
 	Vec3 inverseDirection;
+	// Ray cone used to estimate texture footprint: width at origin and spread angle per unit of distance.
+	Float coneWidth = 0.0f;
+	Float coneSpread = 0.0f;
 
 	Ray(const Vec3& origin, const Vec3& direction) :
 		origin(origin), direction(direction), inverseDirection(1.0f / direction) {
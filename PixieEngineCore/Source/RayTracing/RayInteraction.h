@@ -5,6 +5,8 @@ struct RayInteraction {
 	Vec3 position = Vec3(0.0f);
 	Vec3 normal = Vec3(0.0f);
 	Vec2 uv = Vec2(0.0f);
+	// Width of ray cone footprint in uv space, selects MIP level of texture lookups.
+	Float uvFootprint = 0.0f;
 	Vec3 wo = Vec3(0.0f);
 	int32_t materialIndex = 0;
 	int32_t lightIndex = -1;
@@ -1,6 +1,32 @@
 #include "pch.h"
 #include "Samplers.h"
 
+std::string to_string(SamplerType type) {
+    switch (type) {
+    case SamplerType::Independent: return "Independent";
+    case SamplerType::Stratified: return "Stratified";
+    case SamplerType::PaddedSobol: return "Padded Sobol";
+    case SamplerType::ZSobol: return "Z Sobol";
+    default: return "Undefined Sampler";
+    }
+}
+
+static int32_t Log2Int(uint64_t v) {
+    int32_t result = 0;
+    while (v >>= 1) {
+        result++;
+    }
+    return result;
+}
+
+static uint64_t RoundUpPow2(uint64_t v) {
+    uint64_t result = 1;
+    while (result < v) {
+        result <<= 1;
+    }
+    return result;
+}
+
 /*
     Independent Sampler
 */
@@ -76,4 +102,128 @@ Vec2 StratifiedSampler::Get2D() {
 
 Vec2 StratifiedSampler::GetPixel2D() {
     return Get2D();
-}
\ No newline at end of file
+}
+
+/*
+    Padded Sobol Sampler
+*/
+
+PaddedSobolSampler::PaddedSobolSampler(int32_t samplesPerPixel, int32_t seed) :
+    m_samplesPerPixel((int32_t)RoundUpPow2(std::max(samplesPerPixel, 1))), m_seed(seed) {}
+
+Sampler* PaddedSobolSampler::Clone() const {
+    return new PaddedSobolSampler(m_samplesPerPixel, m_seed);
+}
+
+int32_t PaddedSobolSampler::SamplesPerPixel() const {
+    return m_samplesPerPixel;
+}
+
+void PaddedSobolSampler::StartPixelSample(glm::ivec2 p, int32_t index, int32_t dim) {
+    m_pixel = p;
+    m_sampleIndex = index;
+    m_dimension = dim;
+}
+
+Float PaddedSobolSampler::Get1D() {
+    uint64_t hash = Hash(m_pixel, m_dimension, m_seed);
+    int32_t index = PermutationElement(m_sampleIndex, m_samplesPerPixel, (uint32_t)hash);
+    m_dimension++;
+    return SobolSample(index, 0, FastOwenScrambler((uint32_t)(hash >> 32)));
+}
+
+Vec2 PaddedSobolSampler::Get2D() {
+    uint64_t hash = Hash(m_pixel, m_dimension, m_seed);
+    int32_t index = PermutationElement(m_sampleIndex, m_samplesPerPixel, (uint32_t)hash);
+    m_dimension += 2;
+    uint64_t scrambleHash = MixBits(hash);
+    return Vec2(SobolSample(index, 0, FastOwenScrambler((uint32_t)scrambleHash)), SobolSample(index, 1, FastOwenScrambler((uint32_t)(scrambleHash >> 32))));
+}
+
+Vec2 PaddedSobolSampler::GetPixel2D() {
+    return Get2D();
+}
+
+/*
+    Z Sobol Sampler
+*/
+
+ZSobolSampler::ZSobolSampler(int32_t samplesPerPixel, glm::ivec2 resolution, int32_t seed) :
+    m_seed(seed), m_resolution(resolution) {
+    m_log2SamplesPerPixel = Log2Int(RoundUpPow2(std::max(samplesPerPixel, 1)));
+    int32_t resolutionPow2 = (int32_t)RoundUpPow2(std::max(std::max(resolution.x, resolution.y), 1));
+    int32_t log4SamplesPerPixel = (m_log2SamplesPerPixel + 1) / 2;
+    m_base4DigitsCount = Log2Int(resolutionPow2) + log4SamplesPerPixel;
+}
+
+Sampler* ZSobolSampler::Clone() const {
+    return new ZSobolSampler(1 << m_log2SamplesPerPixel, m_resolution, m_seed);
+}
+
+int32_t ZSobolSampler::SamplesPerPixel() const {
+    return 1 << m_log2SamplesPerPixel;
+}
+
+void ZSobolSampler::StartPixelSample(glm::ivec2 p, int32_t index, int32_t dim) {
+    m_dimension = dim;
+    m_mortonIndex = (EncodeMorton2(p.x, p.y) << m_log2SamplesPerPixel) | (uint64_t)index;
+}
+
+Float ZSobolSampler::Get1D() {
+    uint64_t sampleIndex = GetSampleIndex();
+    m_dimension++;
+    uint64_t sampleHash = Hash(m_dimension, m_seed);
+    return SobolSample(sampleIndex, 0, FastOwenScrambler((uint32_t)sampleHash));
+}
+
+Vec2 ZSobolSampler::Get2D() {
+    uint64_t sampleIndex = GetSampleIndex();
+    m_dimension += 2;
+    uint64_t sampleHash = Hash(m_dimension, m_seed);
+    return Vec2(SobolSample(sampleIndex, 0, FastOwenScrambler((uint32_t)sampleHash)), SobolSample(sampleIndex, 1, FastOwenScrambler((uint32_t)(sampleHash >> 32))));
+}
+
+Vec2 ZSobolSampler::GetPixel2D() {
+    return Get2D();
+}
+
+// Shuffles base 4 digits of the Morton index, the permutation of each digit depends on the digits above it and on the dimension.
+uint64_t ZSobolSampler::GetSampleIndex() const {
+    static const uint8_t permutations[24][4] = {
+        {0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1}, {0, 3, 2, 1}, {0, 3, 1, 2},
+        {1, 0, 2, 3}, {1, 0, 3, 2}, {1, 2, 0, 3}, {1, 2, 3, 0}, {1, 3, 2, 0}, {1, 3, 0, 2},
+        {2, 1, 0, 3}, {2, 1, 3, 0}, {2, 0, 1, 3}, {2, 0, 3, 1}, {2, 3, 0, 1}, {2, 3, 1, 0},
+        {3, 1, 2, 0}, {3, 1, 0, 2}, {3, 2, 1, 0}, {3, 2, 0, 1}, {3, 0, 2, 1}, {3, 0, 1, 2}
+    };
+
+    uint64_t sampleIndex = 0;
+    // Odd power of two samples count leaves an extra base 2 digit at the bottom.
+    bool pow2Samples = m_log2SamplesPerPixel & 1;
+    int32_t lastDigit = pow2Samples ? 1 : 0;
+    for (int32_t i = m_base4DigitsCount - 1; i >= lastDigit; i--) {
+        int32_t digitShift = 2 * i - (pow2Samples ? 1 : 0);
+        int32_t digit = (m_mortonIndex >> digitShift) & 3;
+        uint64_t higherDigits = m_mortonIndex >> (digitShift + 2);
+        int32_t p = (MixBits(higherDigits ^ (0x55555555u * (uint32_t)m_dimension)) >> 24) % 24;
+        digit = permutations[p][digit];
+        sampleIndex |= (uint64_t)digit << digitShift;
+    }
+    if (pow2Samples) {
+        int32_t digit = m_mortonIndex & 1;
+        sampleIndex |= digit ^ (MixBits((m_mortonIndex >> 1) ^ (0x55555555u * (uint32_t)m_dimension)) & 1);
+    }
+    return sampleIndex;
+}
+
+Sampler* CreateSampler(SamplerType type, int32_t samplesPerPixel, glm::ivec2 resolution, int32_t seed) {
+    switch (type) {
+    case SamplerType::Stratified: {
+        int32_t xPixelSamples = std::max((int32_t)std::sqrt((Float)samplesPerPixel), 1);
+        int32_t yPixelSamples = std::max(samplesPerPixel / xPixelSamples, 1);
+        return new StratifiedSampler(xPixelSamples, yPixelSamples, true, seed);
+    }
+    case SamplerType::PaddedSobol: return new PaddedSobolSampler(samplesPerPixel, seed);
+    case SamplerType::ZSobol: return new ZSobolSampler(samplesPerPixel, resolution, seed);
+    default: return new IndependentSampler(samplesPerPixel, seed);
+    }
+}
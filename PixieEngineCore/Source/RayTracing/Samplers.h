@@ -2,9 +2,22 @@
 #include "pch.h"
 #include "Math/Random.h"
 #include "Math/Hash.h"
+#include "Math/LowDiscrepancy.h"
+
+enum class SamplerType : int32_t {
+	Independent = 0,
+	Stratified,
+	PaddedSobol,
+	ZSobol,
+	COUNT
+};
+
+std::string to_string(SamplerType type);
 
 class Sampler {
 public:
+	virtual ~Sampler() = default;
+
 	virtual Sampler* Clone() const = 0;
 	virtual int32_t SamplesPerPixel() const = 0;
 	virtual void StartPixelSample(glm::ivec2 p, int32_t sampleIndex, int32_t dimension = 0) = 0;
@@ -50,3 +63,50 @@ protected:
     int32_t m_sampleIndex = 0;
     int32_t m_dimension = 0;
 };
+
+// Sobol points of first two dimensions with every dimension of the sample padded by independently
+// permuted sample indices and Owen scrambling. Samples per pixel count is rounded up to a power of two.
+class PaddedSobolSampler : public Sampler {
+public:
+	PaddedSobolSampler(int32_t samplesPerPixel, int32_t seed = 0);
+
+	Sampler* Clone() const override;
+	int32_t SamplesPerPixel() const override;
+	void StartPixelSample(glm::ivec2 p, int32_t index, int32_t dim) override;
+	Float Get1D() override;
+	Vec2 Get2D() override;
+	Vec2 GetPixel2D() override;
+
+protected:
+	int32_t m_samplesPerPixel;
+	int32_t m_seed;
+	glm::ivec2 m_pixel = glm::ivec2(0);
+	int32_t m_sampleIndex = 0;
+	int32_t m_dimension = 0;
+};
+
+// Sobol sampler over the whole image, pixels are visited in Morton order with randomly permuted base 4 digits,
+// so error is distributed as blue noise between neighbouring pixels.
+class ZSobolSampler : public Sampler {
+public:
+	ZSobolSampler(int32_t samplesPerPixel, glm::ivec2 resolution, int32_t seed = 0);
+
+	Sampler* Clone() const override;
+	int32_t SamplesPerPixel() const override;
+	void StartPixelSample(glm::ivec2 p, int32_t index, int32_t dim) override;
+	Float Get1D() override;
+	Vec2 Get2D() override;
+	Vec2 GetPixel2D() override;
+
+protected:
+	int32_t m_log2SamplesPerPixel;
+	int32_t m_base4DigitsCount;
+	int32_t m_seed;
+	glm::ivec2 m_resolution;
+	uint64_t m_mortonIndex = 0;
+	int32_t m_dimension = 0;
+
+	uint64_t GetSampleIndex() const;
+};
+
+Sampler* CreateSampler(SamplerType type, int32_t samplesPerPixel, glm::ivec2 resolution, int32_t seed = 0);
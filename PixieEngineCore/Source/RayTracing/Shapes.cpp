@@ -55,6 +55,10 @@ Bounds3f Sphere::Bounds() const {
 	return m_transform.ApplyBounds(Bounds3f(Vec3(-m_radius), Vec3(m_radius)));
 }
 
+DirectionCone Sphere::NormalBounds() const {
+	return DirectionCone::EntireSphere();
+}
+
 std::optional<ShapeSample> Sphere::Sample(Vec2 u) const {
 	Vec3 pObj = m_radius * glm::normalize(SampleUniformSphere(u));
 	Vec3 nObj(pObj.x, pObj.y, pObj.z);
@@ -240,6 +244,10 @@ Bounds3f Triangle::Bounds() const {
 	return Bounds3f(glm::min(p0, p1, p2), glm::max(p0, p1, p2));
 }
 
+DirectionCone Triangle::NormalBounds() const {
+	return DirectionCone(normal, 1.0f);
+}
+
 std::optional<ShapeSample> Triangle::Sample(Vec2 u) const {
 	RayInteraction intr;
 	Vec3 b = SampleUniformTriangle(u);
@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "Math/Transform.h"
 #include "Math/Frame.h"
+#include "Math/DirectionCone.h"
 #include "RayInteraction.h"
 #include "Resources/Mesh.h"
 
@@ -44,6 +45,8 @@ public:
 	virtual std::optional<ShapeIntersection> Intersect(const Ray& ray, Float tMax = Infinity) const = 0;
 	virtual bool IsIntersected(const Ray& ray, Float tMax = Infinity) const = 0;
 	virtual Bounds3f Bounds() const = 0;
+	// Cone containing all surface normals of the shape.
+	virtual DirectionCone NormalBounds() const = 0;
 	virtual std::optional<ShapeSample> Sample(Vec2 u) const = 0;
 	virtual std::optional<ShapeSample> Sample(const ShapeSampleContext& ctx, Vec2 u) const = 0;
 	virtual Float SamplePDF(const RayInteraction&) const = 0;
@@ -58,6 +61,7 @@ public:
 	std::optional<ShapeIntersection> Intersect(const Ray& ray, Float tMax = Infinity) const override;
 	bool IsIntersected(const Ray& ray, Float tMax = Infinity) const override;
 	Bounds3f Bounds() const override;
+	DirectionCone NormalBounds() const override;
 	std::optional<ShapeSample> Sample(Vec2 u) const override;
 	std::optional<ShapeSample> Sample(const ShapeSampleContext& ctx, Vec2 u) const override;
 	Float SamplePDF(const RayInteraction&) const override;
@@ -80,6 +84,7 @@ public:
 	std::optional<ShapeIntersection> Intersect(const Ray& ray, Float tMax = Infinity) const override;
 	bool IsIntersected(const Ray& ray, Float tMax = Infinity) const override;
 	Bounds3f Bounds() const override;
+	DirectionCone NormalBounds() const override;
 	std::optional<ShapeSample> Sample(Vec2 u) const override;
 	std::optional<ShapeSample> Sample(const ShapeSampleContext& ctx, Vec2 u) const override;
 	Float SamplePDF(const RayInteraction&) const override;
@@ -0,0 +1,114 @@
+#include "pch.h"
+#include "TrianglePacket.h"
+
+void TrianglePacket::SetTriangle(int32_t lane, Vec3 v0, Vec3 v1, Vec3 v2) {
+	Vec3 e1 = v1 - v0;
+	Vec3 e2 = v2 - v0;
+	for (int32_t i = 0; i < 3; i++) {
+		p0[i][lane] = v0[i];
+		edge1[i][lane] = e1[i];
+		edge2[i][lane] = e2[i];
+	}
+	normalLength[lane] = glm::length(glm::cross(e1, e2));
+}
+
+#if defined(PIXIE_ENGINE_SSE) && !defined(PIXIE_ENGINE_DOUBLE_PRECISION)
+// Möller-Trumbore test of all 4 lanes, returns mask of intersected lanes.
+// Determinant is |d| * |n| * cos of the angle between ray and triangle normal, so rays are rejected as parallel by the
+// angle alone. Instance space rays are not normalized and their triangles may be scaled arbitrarily.
+static int32_t IntersectLanes(const TrianglePacket& packet, const Ray& ray, Float tMax, __m128* t) {
+	__m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+	__m128 e1x = _mm_load_ps(packet.edge1[0]), e1y = _mm_load_ps(packet.edge1[1]), e1z = _mm_load_ps(packet.edge1[2]);
+	__m128 e2x = _mm_load_ps(packet.edge2[0]), e2y = _mm_load_ps(packet.edge2[1]), e2z = _mm_load_ps(packet.edge2[2]);
+
+	__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+	__m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+	__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+	__m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(packet.p0[0]));
+	__m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(packet.p0[1]));
+	__m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(packet.p0[2]));
+	__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+	__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+	__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+	__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+	__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+	*t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+	__m128 zero = _mm_setzero_ps();
+	__m128 epsilon = _mm_set1_ps(ShadowEpsilon);
+	__m128 parallelThreshold = _mm_mul_ps(_mm_load_ps(packet.normalLength), _mm_set1_ps(ShadowEpsilon * glm::length(ray.direction)));
+	__m128 valid = _mm_cmpge_ps(absDet, parallelThreshold);
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+	valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(*t, epsilon));
+	valid = _mm_and_ps(valid, _mm_cmple_ps(*t, _mm_set1_ps(tMax)));
+	return _mm_movemask_ps(valid);
+}
+#else
+static int32_t IntersectLanes(const TrianglePacket& packet, const Ray& ray, Float tMax, Float* t) {
+	int32_t mask = 0;
+	Float parallelEpsilon = ShadowEpsilon * glm::length(ray.direction);
+	for (int32_t lane = 0; lane < TrianglePacketSize; lane++) {
+		Vec3 edge1 = Vec3(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+		Vec3 edge2 = Vec3(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+		Vec3 rayCrossEdge2 = glm::cross(ray.direction, edge2);
+		Float det = glm::dot(edge1, rayCrossEdge2);
+		if (glm::abs(det) < parallelEpsilon * packet.normalLength[lane]) {
+			continue;
+		}
+		Float invDet = 1.0f / det;
+		Vec3 s = ray.origin - Vec3(packet.p0[0][lane], packet.p0[1][lane], packet.p0[2][lane]);
+		Float u = invDet * glm::dot(s, rayCrossEdge2);
+		Vec3 sCrossEdge1 = glm::cross(s, edge1);
+		Float v = invDet * glm::dot(ray.direction, sCrossEdge1);
+		t[lane] = invDet * glm::dot(edge2, sCrossEdge1);
+		if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t[lane] >= ShadowEpsilon && t[lane] <= tMax) {
+			mask |= 1 << lane;
+		}
+	}
+	return mask;
+}
+#endif
+
+int32_t TrianglePacket::Intersect(const Ray& ray, Float tMax, int32_t laneMask, Float* tHit) const {
+#if defined(PIXIE_ENGINE_SSE) && !defined(PIXIE_ENGINE_DOUBLE_PRECISION)
+	__m128 tLanes;
+	int32_t mask = IntersectLanes(*this, ray, tMax, &tLanes) & laneMask;
+	if (!mask) {
+		return -1;
+	}
+	alignas(16) Float t[TrianglePacketSize];
+	_mm_store_ps(t, tLanes);
+#else
+	Float t[TrianglePacketSize];
+	int32_t mask = IntersectLanes(*this, ray, tMax, t) & laneMask;
+	if (!mask) {
+		return -1;
+	}
+#endif
+	int32_t closestLane = -1;
+	for (int32_t lane = 0; lane < TrianglePacketSize; lane++) {
+		if ((mask & (1 << lane)) && t[lane] <= tMax) {
+			tMax = t[lane];
+			closestLane = lane;
+		}
+	}
+	*tHit = tMax;
+	return closestLane;
+}
+
+bool TrianglePacket::IsIntersected(const Ray& ray, Float tMax, int32_t laneMask) const {
+#if defined(PIXIE_ENGINE_SSE) && !defined(PIXIE_ENGINE_DOUBLE_PRECISION)
+	__m128 t;
+	return (IntersectLanes(*this, ray, tMax, &t) & laneMask) != 0;
+#else
+	Float t[TrianglePacketSize];
+	return (IntersectLanes(*this, ray, tMax, t) & laneMask) != 0;
+#endif
+}
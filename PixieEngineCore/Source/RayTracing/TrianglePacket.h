@@ -0,0 +1,29 @@
+#pragma once
+#include "pch.h"
+#include "Math/SIMD.h"
+#include "Ray.h"
+
+constexpr int32_t TrianglePacketSize = 4;
+
+// Hit test data of up to 4 triangles of one BVH leaf in SoA layout: first vertex and two edges.
+// Unused lanes of the last packet of a leaf are left empty and masked out.
+struct alignas(16) TrianglePacket {
+	Float p0[3][TrianglePacketSize] = {};
+	Float edge1[3][TrianglePacketSize] = {};
+	Float edge2[3][TrianglePacketSize] = {};
+	// Length of edge1 x edge2, makes the parallel ray test independent of triangle and instance scale.
+	Float normalLength[TrianglePacketSize] = {};
+
+	void SetTriangle(int32_t lane, Vec3 p0, Vec3 p1, Vec3 p2);
+	// Returns closest intersected lane among lanes in mask, or -1.
+	int32_t Intersect(const Ray& ray, Float tMax, int32_t laneMask, Float* tHit) const;
+	bool IsIntersected(const Ray& ray, Float tMax, int32_t laneMask) const;
+};
+
+// Attributes needed only once the closest hit is known. Material and light come from the mesh instance.
+struct TriangleShading {
+	Vec3 normal;
+	Vec2 uv0, uv1, uv2;
+	// Square root of uv area to triangle area ratio, converts footprint width from local space to uv space.
+	Float uvScale;
+};
@@ -4,6 +4,15 @@
 #include "SceneSnapshot.h"
 
 constexpr int32_t MaxRayBounces = 4096;
+// Spread of ray cones after non specular bounce, textures seen through rough reflections are filtered heavily anyway.
+constexpr Float RoughConeSpread = 0.1f;
+
+static Ray SpawnBounceRay(const Ray& ray, const ShapeIntersection& si, const BSDFSample& bs) {
+    Ray bounce(si.intr.position, bs.wi);
+    bounce.coneWidth = ray.coneWidth + ray.coneSpread * si.tHit;
+    bounce.coneSpread = bs.IsSpecular() ? ray.coneSpread : std::max<Float>(ray.coneSpread, RoughConeSpread);
+    return bounce;
+}
 
 std::string to_string(RayTracingVisualization mode) {
 	switch (mode) {
@@ -16,6 +25,14 @@ std::string to_string(RayTracingVisualization mode) {
 	}
 }
 
+std::string to_string(IntegratorMode mode) {
+    switch (mode) {
+    case IntegratorMode::Recursive: return "Recursive";
+    case IntegratorMode::Wavefront: return "Wavefront";
+    default: return "Undefined Integrator Mode";
+    }
+}
+
 bool VolumetricRayTracer::Unoccluded(const RayInteraction& p0, const RayInteraction& p1, GBufferPixel& pixel) {
     return Unoccluded(p0.position, p1.position, pixel);
 }
@@ -99,14 +116,23 @@ class Medium {
     float dencity = 0;
 };
 
-void VolumetricRayTracer::SetSceneSnapshot(SceneSnapshot* sceneSnapshot) {
+void VolumetricRayTracer::SetSceneSnapshot(SceneSnapshot* sceneSnapshot, LightSamplerType lightSamplerType) {
     m_sceneSnapshot = sceneSnapshot;
     if (m_lightSampler) delete m_lightSampler;
-    if (sceneSnapshot) {
-        m_lightSampler = new UniformLightSampler((std::vector<Light*>*) & sceneSnapshot->GetLights());
-    }
-    else {
+    if (!sceneSnapshot) {
         m_lightSampler = new UniformLightSampler({});
+        return;
+    }
+    switch (lightSamplerType) {
+    case LightSamplerType::Power:
+        m_lightSampler = new PowerLightSampler(sceneSnapshot->GetLights());
+        break;
+    case LightSamplerType::BVH:
+        m_lightSampler = new BVHLightSampler(sceneSnapshot->GetLights());
+        break;
+    default:
+        m_lightSampler = new UniformLightSampler(&sceneSnapshot->GetLights());
+        break;
     }
 }
 
@@ -244,7 +270,7 @@ GBufferPixel VolumetricRayTracer::SampleLightRay(Ray ray, Sampler* sampler) {
             }
         }
     
-        BSDF bsdf = ResourceManager::GetMaterial(isect.materialIndex)->GetBSDF(isect);
+        BSDF bsdf = m_sceneSnapshot->GetMaterial(isect.materialIndex).GetBSDF(isect);
 
         if (!bsdf) {
             ray.SkipIntersection(isect.position);
@@ -291,7 +317,7 @@ GBufferPixel VolumetricRayTracer::SampleLightRay(Ray ray, Sampler* sampler) {
             etaScale *= Sqr(bs->eta);
         }
     
-        ray = Ray(isect.position, bs->wi);
+        ray = SpawnBounceRay(ray, *si, *bs);
 
         //BSSRDF bssrdf = isect.GetBSSRDF(ray);
         //if (bssrdf && bs->IsTransmission()) {
@@ -372,7 +398,171 @@ GBufferPixel VolumetricRayTracer::SampleLightRay(Ray ray, Sampler* sampler) {
     return pixel;
 }
 
+void VolumetricRayTracer::SampleLightRays(const std::vector<Ray>& rays, const std::vector<Sampler*>& samplers, std::vector<GBufferPixel>& pixels) {
+    std::vector<WavefrontPath> paths;
+    paths.reserve(rays.size());
+    for (size_t i = 0; i < rays.size(); i++) {
+        paths.emplace_back(rays[i], samplers[i]);
+    }
+
+    std::vector<std::optional<ShapeIntersection>> hits(paths.size());
+    std::vector<int32_t> activeQueue(paths.size()), shadeQueue, continuationQueue;
+    std::vector<ShadowRay> shadowQueue;
+    std::iota(activeQueue.begin(), activeQueue.end(), 0);
+    shadeQueue.reserve(paths.size());
+    continuationQueue.reserve(paths.size());
+    shadowQueue.reserve(paths.size());
+
+    while (!activeQueue.empty()) {
+        // Intersect every active ray before any shading, so traversal runs over the whole stream at once.
+        for (int32_t index : activeQueue) {
+            WavefrontPath& path = paths[index];
+            hits[index] = m_sceneSnapshot->Intersect(path.ray, &path.pixel.boxChecks, &path.pixel.shapeChecks);
+        }
+
+        // Escaped rays and emitters are resolved here, the rest is queued for shading.
+        shadeQueue.clear();
+        for (int32_t index : activeQueue) {
+            WavefrontPath& path = paths[index];
+            const std::optional<ShapeIntersection>& si = hits[index];
+            if (!si) {
+                for (const Light* light : m_sceneSnapshot->GetInfiniteLights()) {
+                    if (Spectrum Le = light->Le(path.ray); Le) {
+                        AddEmittedLight(path, light, Le);
+                    }
+                }
+                continue;
+            }
+            if (si->intr.lightIndex >= 0) {
+                Light* areaLight = m_sceneSnapshot->GetAreaLight(si->intr.lightIndex);
+                AddEmittedLight(path, areaLight, areaLight->Le(path.ray));
+            }
+            shadeQueue.push_back(index);
+        }
+
+        // Paths hitting the same material are shaded next to each other.
+        std::stable_sort(shadeQueue.begin(), shadeQueue.end(), [&hits](int32_t a, int32_t b) {
+            return hits[a]->intr.materialIndex < hits[b]->intr.materialIndex;
+            });
+
+        continuationQueue.clear();
+        shadowQueue.clear();
+        int32_t materialIndex = -1;
+        Material* material = nullptr;
+        for (int32_t index : shadeQueue) {
+            WavefrontPath& path = paths[index];
+            ShapeIntersection& si = *hits[index];
+            RayInteraction& isect = si.intr;
+            if (isect.materialIndex != materialIndex) {
+                materialIndex = isect.materialIndex;
+                material = &m_sceneSnapshot->GetMaterial(materialIndex);
+            }
+            BSDF bsdf = material->GetBSDF(isect);
+
+            if (!bsdf) {
+                path.ray.SkipIntersection(isect.position);
+                continuationQueue.push_back(index);
+                continue;
+            }
+
+            if (path.depth++ >= MaxRayBounces) {
+                continue;
+            }
+
+            if (m_regularize && path.anyNonSpecularBounces) {
+                bsdf.Regularize();
+            }
+
+            if (IsNonSpecular(bsdf.Flags())) {
+                if (std::optional<ShadowRay> shadowRay = SampleLdShadowRay(isect, &bsdf, path.sampler, path.beta, path.r_u)) {
+                    shadowRay->pathIndex = index;
+                    shadowQueue.push_back(*shadowRay);
+                }
+            }
+            path.prevIntrContext = LightSampleContext(isect);
+
+            Vec3 wo = isect.wo;
+            Float u = path.sampler->Get1D();
+            std::optional<BSDFSample> bs = bsdf.SampleDirectionAndDistribution(wo, u, path.sampler->Get2D());
+            if (!bs) {
+                continue;
+            }
+            if (path.depth == 1) {
+                path.pixel.albedo = bs->f;
+                path.pixel.depth = si.tHit;
+                path.pixel.normal = isect.normal;
+                path.pixel.position = isect.position;
+                path.pixel.uv = isect.uv;
+            }
+            path.beta *= bs->f * AbsDot(bs->wi, isect.normal) / bs->pdf;
+            if (bs->pdfIsProportional) {
+                path.r_l = path.r_u / bsdf.PDF(wo, bs->wi);
+            }
+            else {
+                path.r_l = path.r_u / bs->pdf;
+            }
+
+            path.specularBounce = bs->IsSpecular();
+            path.anyNonSpecularBounces |= !bs->IsSpecular();
+            if (bs->IsTransmission()) {
+                path.etaScale *= Sqr(bs->eta);
+            }
+
+            path.ray = SpawnBounceRay(path.ray, si, *bs);
+
+            if (!path.beta) {
+                continue;
+            }
+            Spectrum rrBeta = path.beta * path.etaScale / path.r_u.Average();
+            Float uRR = path.sampler->Get1D();
+            if (MaxComponent(rrBeta.GetRGB()) < 1.0f && path.depth > 1) {
+                Float q = std::max<Float>(0, 1 - MaxComponent(rrBeta.GetRGB()));
+                if (uRR < q) {
+                    continue;
+                }
+                path.beta /= 1.0f - q;
+            }
+            continuationQueue.push_back(index);
+        }
+
+        for (const ShadowRay& shadowRay : shadowQueue) {
+            WavefrontPath& path = paths[shadowRay.pathIndex];
+            if (Unoccluded(shadowRay.origin, shadowRay.target, path.pixel)) {
+                path.L += shadowRay.Ld;
+            }
+        }
+
+        std::swap(activeQueue, continuationQueue);
+    }
+
+    pixels.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        pixels[i] = paths[i].pixel;
+        pixels[i].light = paths[i].L;
+    }
+}
+
+void VolumetricRayTracer::AddEmittedLight(WavefrontPath& path, const Light* light, Spectrum Le) {
+    if (path.depth == 0 || path.specularBounce) {
+        path.L += path.beta * Le / path.r_u.Average();
+    }
+    else {
+        Float p_l = m_lightSampler->PMF(path.prevIntrContext, light) * light->SampleLiPDF(path.prevIntrContext, path.ray.direction, true);
+        path.r_l *= p_l;
+        path.L += path.beta * Le / (path.r_u + path.r_l).Average();
+    }
+}
+
 Spectrum VolumetricRayTracer::SampleLd(const RayInteraction& intr, const BSDF* bsdf, Sampler* sampler, Spectrum beta, Spectrum r_p, GBufferPixel& pixel) {
+    std::optional<ShadowRay> shadowRay = SampleLdShadowRay(intr, bsdf, sampler, beta, r_p);
+    // Shadow rays only need an any hit occlusion query, transmittance through media is not traced.
+    if (!shadowRay || !Unoccluded(shadowRay->origin, shadowRay->target, pixel)) {
+        return Spectrum(0.0f);
+    }
+    return shadowRay->Ld;
+}
+
+std::optional<ShadowRay> VolumetricRayTracer::SampleLdShadowRay(const RayInteraction& intr, const BSDF* bsdf, Sampler* sampler, Spectrum beta, Spectrum r_p) {
     LightSampleContext ctx;
     if (bsdf) {
         ctx = LightSampleContext(intr);
@@ -392,13 +582,13 @@ Spectrum VolumetricRayTracer::SampleLd(const RayInteraction& intr, const BSDF* b
     std::optional<SampledLight> sampledLight = m_lightSampler->Sample(ctx, u);
     Vec2 uLight = sampler->Get2D();
     if (!sampledLight) {
-        return Spectrum(0.0f);
+        return {};
     }
     Light* light = sampledLight->light;
     
     std::optional<LightLiSample> ls = light->SampleLi(ctx, uLight, true);
     if (!ls || !ls->L || ls->pdf == 0) {
-        return Spectrum(0.0f);
+        return {};
     }
     Float p_l = sampledLight->p * ls->pdf;
     
@@ -415,69 +605,21 @@ Spectrum VolumetricRayTracer::SampleLd(const RayInteraction& intr, const BSDF* b
         //scatterPDF = phase->PDF(wo, wi);
     }
     if (!f_hat) {
-        return Spectrum(0.0f);
+        return {};
     }
     
-    Ray lightRay = Ray(intr.position, glm::normalize(ls->pLight.position - intr.position));
     Spectrum T_ray(1.f), r_l(1.f), r_u(1.f);
-    RNG rng(Hash(lightRay.origin), Hash(lightRay.direction));
-    
-    while (lightRay.direction != Vec3(0, 0, 0)) {
-        std::optional<ShapeIntersection> si = m_sceneSnapshot->Intersect(lightRay, &pixel.boxChecks, &pixel.shapeChecks, 1.0f - ShadowEpsilon);
-        if (si) {
-            return Spectrum(0.0f);
-        }
-    
-        //if (lightRay.medium) {
-        //    Float tMax = si ? si->tHit : (1 - ShadowEpsilon);
-        //    Float u = rng.Uniform<Float>();
-        //    Spectrum T_maj =
-        //        SampleT_maj(lightRay, tMax, u, rng,
-        //            [&](Vec3 p, MediumProperties mp, Spectrum sigma_maj, Spectrum T_maj) {
-        //                    Spectrum sigma_n = ClampZero(sigma_maj - mp.sigma_a - mp.sigma_s);
-        //                    Float pdf = T_maj.Average() * sigma_maj.Average();
-        //                    T_ray *= T_maj * sigma_n / pdf;
-        //                    r_l *= T_maj * sigma_maj / pdf;
-        //                    r_u *= T_maj * sigma_n / pdf;
-        //
-        //                    Spectrum Tr = T_ray / (r_l + r_u).Average();
-        //                    if (MaxComponent(Tr.GetRGB()) < 0.05f) {
-        //                        Float q = 0.75f;
-        //                        if (rng.Uniform<Float>() < q) {
-        //                            T_ray = Spectrum(0.0f);
-        //                        }
-        //                        else {
-        //                            T_ray /= 1 - q;
-        //                        }
-        //                    }
-        //
-        //                    if (!T_ray) {
-        //                        return false;
-        //                    }
-        //                    return true;
-        //            });
-        //    T_ray *= T_maj / T_maj.Average();
-        //    r_l *= T_maj / T_maj.Average();
-        //    r_u *= T_maj / T_maj.Average();
-        //}
-    
-        if (!T_ray) {
-            return Spectrum(0.0f);
-        }
-        if (!si) {
-            break;
-        }
-        lightRay = Ray(si->intr.position, glm::normalize(ls->pLight.position - si->intr.position));
-    }
     
     r_l *= r_p * p_l;
     r_u *= r_p * scatterPDF;
+    ShadowRay shadowRay;
+    shadowRay.origin = intr.position;
+    shadowRay.target = ls->pLight.position;
     if (IsDeltaLight(light->Type())) {
-        return beta * f_hat * T_ray * ls->L / r_l.Average();
+        shadowRay.Ld = beta * f_hat * T_ray * ls->L / r_l.Average();
     }
     else {
-        return beta * f_hat * T_ray * ls->L / (r_l + r_u).Average();
+        shadowRay.Ld = beta * f_hat * T_ray * ls->L / (r_l + r_u).Average();
     }
-
-    return Spectrum(0.0f);
+    return shadowRay;
 }
@@ -19,12 +19,46 @@ enum class RayTracingVisualization : uint32_t {
 
 std::string to_string(RayTracingVisualization mode);
 
+enum class IntegratorMode : int32_t {
+	Recursive = 0,
+	Wavefront,
+	COUNT
+};
+
+std::string to_string(IntegratorMode mode);
+
+// Direct lighting sample, its contribution is added to the path only if the segment from origin to target is unoccluded.
+struct ShadowRay {
+	Vec3 origin;
+	Vec3 target;
+	Spectrum Ld;
+	int32_t pathIndex = -1;
+};
+
 class VolumetricRayTracer {
 public:
-	void SetSceneSnapshot(SceneSnapshot* sceneSnapshot);
+	void SetSceneSnapshot(SceneSnapshot* sceneSnapshot, LightSamplerType lightSamplerType = LightSamplerType::BVH);
 	GBufferPixel SampleLightRay(Ray ray, Sampler* sampler);
+	// Wavefront version of SampleLightRay for a batch of rays, every ray uses its own sampler.
+	// Each bounce is split into stages: all rays are intersected, hits are sorted by material and shaded together,
+	// then shadow rays and continuation rays are traced as separate queues.
+	void SampleLightRays(const std::vector<Ray>& rays, const std::vector<Sampler*>& samplers, std::vector<GBufferPixel>& pixels);
 
 protected:
+	// State of a single path between wavefront stages, the same values SampleLightRay keeps in locals.
+	struct WavefrontPath {
+		Ray ray;
+		Sampler* sampler;
+		GBufferPixel pixel;
+		Spectrum L = Spectrum(0.0f), beta = Spectrum(1.0f), r_u = Spectrum(1.0f), r_l = Spectrum(1.0f);
+		LightSampleContext prevIntrContext;
+		Float etaScale = 1;
+		int32_t depth = 0;
+		bool specularBounce = false, anyNonSpecularBounces = false;
+
+		WavefrontPath(const Ray& ray, Sampler* sampler) : ray(ray), sampler(sampler) {}
+	};
+
 	SceneSnapshot* m_sceneSnapshot = nullptr;
 	LightSampler* m_lightSampler = nullptr;
 	bool m_regularize = true;
@@ -32,4 +66,6 @@ protected:
 	bool Unoccluded(const RayInteraction& p0, const RayInteraction& p1, GBufferPixel& pixel);
 	bool Unoccluded(Vec3 p0, Vec3 p1, GBufferPixel& pixel);
 	Spectrum SampleLd(const RayInteraction& intr, const BSDF* bsdf, Sampler* sampler, Spectrum beta, Spectrum r_p, GBufferPixel& pixel);
+	std::optional<ShadowRay> SampleLdShadowRay(const RayInteraction& intr, const BSDF* bsdf, Sampler* sampler, Spectrum beta, Spectrum r_p);
+	void AddEmittedLight(WavefrontPath& path, const Light* light, Spectrum Le);
 };
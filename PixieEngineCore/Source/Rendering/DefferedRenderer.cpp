@@ -14,6 +14,7 @@ DefferedRenderer::DefferedRenderer() :
 }
 
 void DefferedRenderer::DrawFrame(Scene* scene, Camera* camera) {
+	scene->UpdateTransforms();
 	// Store Original Viewport
 	GLint originalViewport[4];
 	glGetIntegerv(GL_VIEWPORT, originalViewport);
@@ -79,10 +80,10 @@ void DefferedRenderer::DrawFrame(Scene* scene, Camera* camera) {
 	glViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
 }
 
-void DefferedRenderer::DrawObject(SceneObject* object, Mat4 parentTransform) {
+void DefferedRenderer::DrawObject(SceneObject* object) {
 	if (!object) return;
 
-	Mat4 objectTransform = parentTransform * object->GetTransform().GetMatrix();
+	const Mat4& objectTransform = object->GetWorldTransform().GetMatrix();
 	if (const MeshAnimatorComponent* animatorComponent = object->GetComponent<MeshAnimatorComponent>()) {
 		std::array<Mat4, MaxBonesPerModel> boneMatricesBuffer;
 		animatorComponent->GetBoneMatrices(0.0f, boneMatricesBuffer);
@@ -107,7 +108,7 @@ void DefferedRenderer::DrawObject(SceneObject* object, Mat4 parentTransform) {
 		sphere->Draw();
 	}
 	for (size_t i = 0; i < object->GetChildren().size(); i++) {
-		DrawObject(object->GetChild((int32_t)i), objectTransform);
+		DrawObject(object->GetChild((int32_t)i));
 	}
 }
 
@@ -115,10 +116,10 @@ void DefferedRenderer::SetupLights(Scene* scene) {
 	// Point lights
 	const size_t MaxPointLights = 32;
 	int32_t nPointLights = 0;
-	const std::vector<PointLightComponent*>& pointLights = scene->GetPointLights();
+	ComponentView<PointLightComponent> pointLights = scene->GetPointLights();
 	for (size_t i = 0; i < pointLights.size() && i < MaxPointLights; i++) {
 		const std::string base = std::string("pointLights[") + std::to_string(nPointLights) + std::string("].");
-		m_lightingShader.SetUniform3f(base + std::string("position"), pointLights[i]->GetParent()->GetTransform().GetPosition());
+		m_lightingShader.SetUniform3f(base + std::string("position"), pointLights[i]->GetParent()->GetWorldTransform().GetPosition());
 		m_lightingShader.SetUniform3f(base + std::string("emission"), pointLights[i]->GetEmission());
 		nPointLights++;
 	}
@@ -127,7 +128,7 @@ void DefferedRenderer::SetupLights(Scene* scene) {
 	// Area lights
 	const size_t MaxAreaLights = 32;
 	int32_t nAreaLights = 0;
-	const std::vector<AreaLightComponent*>& areaLights = scene->GetAreaLights();
+	ComponentView<AreaLightComponent> areaLights = scene->GetAreaLights();
 	for (size_t i = 0; i < areaLights.size(); i++) {
 		MeshComponent* meshComponent = areaLights[i]->GetParent()->GetComponent<MeshComponent>();
 		if (!meshComponent) continue;
@@ -151,5 +152,5 @@ void DefferedRenderer::SetupMaterial(Material* material) {
 	m_shader.SetUniform3f("albedo", material->m_albedo.GetRGB());
 	m_shader.SetUniform1f("metallic", material->m_metallic);
 	m_shader.SetUniform1f("roughness", material->m_roughness);
-	m_shader.SetTexture("albedoTexture", material->m_albedoTexture.GetID(), 4);
+	m_shader.SetTexture("albedoTexture", material->GetAlbedoTextureID(), 4);
 }
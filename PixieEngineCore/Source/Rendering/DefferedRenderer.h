@@ -32,7 +32,7 @@ protected:
 	Texture m_noiseTexture;
 	SSAOKernel<64> m_ssaoKernel;
 
-	void DrawObject(SceneObject* object, Mat4 parentTransform = Mat4(1.0f));
+	void DrawObject(SceneObject* object);
 	void SetupMaterial(Material* material);
 	void SetupLights(Scene* scene);
 };
@@ -0,0 +1,182 @@
+#include "pch.h"
+#include "Denoiser.h"
+
+Denoiser::Denoiser() :
+	m_thread([this]() { Run(); }) {}
+
+Denoiser::~Denoiser() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isRunning = false;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+bool Denoiser::Submit(DenoiserFrame&& frame) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_hasFrame || m_isBusy) return false;
+		m_frame = std::move(frame);
+		m_hasFrame = true;
+	}
+	m_condition.notify_one();
+	return true;
+}
+
+bool Denoiser::FetchResult(Buffer2D<Vec3>& image, int32_t& pass) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_hasResult) return false;
+	image = std::move(m_result);
+	pass = m_resultPass;
+	m_hasResult = false;
+	return true;
+}
+
+void Denoiser::Discard() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_generation++;
+	m_hasFrame = false;
+	m_hasResult = false;
+}
+
+bool Denoiser::IsBusy() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hasFrame || m_isBusy;
+}
+
+Float Denoiser::GetLastDenoiseTime() const {
+	return m_lastDenoiseTime;
+}
+
+void Denoiser::Run() {
+	while (true) {
+		DenoiserFrame frame;
+		uint64_t generation;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_hasFrame || !m_isRunning; });
+			if (!m_isRunning) return;
+			frame = std::move(m_frame);
+			generation = m_generation;
+			m_hasFrame = false;
+			m_isBusy = true;
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		Buffer2D<Vec3> result = Denoise(frame);
+		m_lastDenoiseTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count() / 1000.0f;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (generation == m_generation) {
+			m_result = std::move(result);
+			m_resultPass = frame.pass;
+			m_hasResult = true;
+		}
+		m_isBusy = false;
+	}
+}
+
+// Filtering works on planar float arrays and iterates over kernel taps in the outer loop,
+// so inner loops run over contiguous pixels of a row without bounds checks and vectorize.
+Buffer2D<Vec3> Denoiser::Denoise(const DenoiserFrame& frame) {
+	const glm::ivec2 resolution = frame.color.GetResolution();
+	const int32_t width = resolution.x, height = resolution.y;
+	const size_t pixelsCount = (size_t)width * height;
+	const float albedoEpsilon = 0.01f;
+
+	std::array<std::vector<float>, 3> color, filtered, normal;
+	std::vector<float> depth(pixelsCount), depthScale(pixelsCount);
+	for (int32_t c = 0; c < 3; c++) {
+		color[c].resize(pixelsCount);
+		filtered[c].resize(pixelsCount);
+		normal[c].resize(pixelsCount);
+	}
+	for (size_t i = 0; i < pixelsCount; i++) {
+		Vec3 albedo = frame.albedo.GetValue((uint32_t)i);
+		Vec3 value = frame.color.GetValue((uint32_t)i);
+		Vec3 n = frame.normal.GetValue((uint32_t)i);
+		for (int32_t c = 0; c < 3; c++) {
+			color[c][i] = (float)(value[c] / std::max<Float>(albedo[c], albedoEpsilon));
+			normal[c][i] = (float)n[c];
+		}
+		depth[i] = (float)frame.depth.GetValue((uint32_t)i);
+		depthScale[i] = 1.0f / (c_depthSigma * std::abs(depth[i]) + 1e-3f);
+	}
+
+	const float kernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+	const float invNormalSigma2 = 1.0f / (c_normalSigma * c_normalSigma);
+	std::vector<float> weightSum(width);
+	for (int32_t iteration = 0; iteration < c_iterations; iteration++) {
+		const int32_t step = 1 << iteration;
+		// Color sigma is halved every iteration, so coarse levels only smooth remaining noise.
+		const float colorSigma = c_colorSigma / (float)step;
+		const float invColorSigma2 = 1.0f / (colorSigma * colorSigma);
+		for (int32_t y = 0; y < height; y++) {
+			const size_t row = (size_t)y * width;
+			float* outR = filtered[0].data() + row;
+			float* outG = filtered[1].data() + row;
+			float* outB = filtered[2].data() + row;
+			std::fill(outR, outR + width, 0.0f);
+			std::fill(outG, outG + width, 0.0f);
+			std::fill(outB, outB + width, 0.0f);
+			std::fill(weightSum.begin(), weightSum.end(), 0.0f);
+			const float* pR = color[0].data() + row;
+			const float* pG = color[1].data() + row;
+			const float* pB = color[2].data() + row;
+			const float* pNX = normal[0].data() + row;
+			const float* pNY = normal[1].data() + row;
+			const float* pNZ = normal[2].data() + row;
+			const float* pZ = depth.data() + row;
+			const float* pZScale = depthScale.data() + row;
+
+			for (int32_t j = -2; j <= 2; j++) {
+				const int32_t qy = y + j * step;
+				if (qy < 0 || qy >= height) continue;
+				for (int32_t k = -2; k <= 2; k++) {
+					const int32_t dx = k * step;
+					const int32_t xStart = std::max(0, -dx), xEnd = std::min(width, width - dx);
+					const float h = kernel[j + 2] * kernel[k + 2];
+					const size_t qRow = (size_t)qy * width;
+					const float* qR = color[0].data() + qRow;
+					const float* qG = color[1].data() + qRow;
+					const float* qB = color[2].data() + qRow;
+					const float* qNX = normal[0].data() + qRow;
+					const float* qNY = normal[1].data() + qRow;
+					const float* qNZ = normal[2].data() + qRow;
+					const float* qZ = depth.data() + qRow;
+					float* sum = weightSum.data();
+					for (int32_t x = xStart; x < xEnd; x++) {
+						const int32_t qx = x + dx;
+						const float dr = qR[qx] - pR[x], dg = qG[qx] - pG[x], db = qB[qx] - pB[x];
+						const float dnx = qNX[qx] - pNX[x], dny = qNY[qx] - pNY[x], dnz = qNZ[qx] - pNZ[x];
+						const float dz = (qZ[qx] - pZ[x]) * pZScale[x];
+						const float exponent = (dr * dr + dg * dg + db * db) * invColorSigma2 + (dnx * dnx + dny * dny + dnz * dnz) * invNormalSigma2 + dz * dz;
+						const float weight = h * std::exp(-exponent);
+						outR[x] += weight * qR[qx];
+						outG[x] += weight * qG[qx];
+						outB[x] += weight * qB[qx];
+						sum[x] += weight;
+					}
+				}
+			}
+
+			// Center tap always has a positive weight, so the sum is never zero.
+			for (int32_t x = 0; x < width; x++) {
+				const float invSum = 1.0f / weightSum[x];
+				outR[x] *= invSum;
+				outG[x] *= invSum;
+				outB[x] *= invSum;
+			}
+		}
+		std::swap(color, filtered);
+	}
+
+	Buffer2D<Vec3> image(resolution);
+	for (size_t i = 0; i < pixelsCount; i++) {
+		Vec3 albedo = frame.albedo.GetValue((uint32_t)i);
+		Vec3 value(color[0][i], color[1][i], color[2][i]);
+		image.SetValue((uint32_t)(i % width), (uint32_t)(i / width), value * glm::max(albedo, Vec3(albedoEpsilon)));
+	}
+	return image;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.h"
+#include "Buffer2D.h"
+
+// Noisy render with first hit features used as edge stopping guides.
+struct DenoiserFrame {
+	Buffer2D<Vec3> color = Buffer2D<Vec3>({ 0, 0 });
+	Buffer2D<Vec3> albedo = Buffer2D<Vec3>({ 0, 0 });
+	Buffer2D<Vec3> normal = Buffer2D<Vec3>({ 0, 0 });
+	Buffer2D<Float> depth = Buffer2D<Float>({ 0, 0 });
+	int32_t pass = 0;
+};
+
+// Edge-avoiding a-trous wavelet filter on CPU (Dammertz et al. 2010). Color is demodulated by albedo,
+// filtered with a 5x5 B3 spline kernel of growing step guided by color, normal and depth, then remodulated.
+// Frames are filtered on a separate thread, a new frame is accepted only when the previous one is done.
+class Denoiser {
+public:
+	Denoiser();
+	~Denoiser();
+
+	// Returns false if previous frame is still being denoised.
+	bool Submit(DenoiserFrame&& frame);
+	// Moves out the latest denoised image, if one has been finished since last fetch.
+	bool FetchResult(Buffer2D<Vec3>& image, int32_t& pass);
+	// Drops frame in progress and any finished result, used when the render restarts.
+	void Discard();
+	bool IsBusy() const;
+	Float GetLastDenoiseTime() const;
+
+	static Buffer2D<Vec3> Denoise(const DenoiserFrame& frame);
+
+protected:
+	static constexpr int32_t c_iterations = 5;
+	static constexpr float c_colorSigma = 1.0f;
+	static constexpr float c_normalSigma = 0.3f;
+	static constexpr float c_depthSigma = 0.05f; // relative to pixel depth
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_condition;
+	DenoiserFrame m_frame;
+	bool m_hasFrame = false;
+	bool m_isBusy = false;
+	bool m_isRunning = true;
+	uint64_t m_generation = 0;
+	Buffer2D<Vec3> m_result = Buffer2D<Vec3>({ 0, 0 });
+	int32_t m_resultPass = 0;
+	bool m_hasResult = false;
+	std::atomic<Float> m_lastDenoiseTime = 0.0f;
+	std::thread m_thread;
+
+	void Run();
+};
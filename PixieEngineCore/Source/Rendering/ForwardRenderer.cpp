@@ -10,6 +10,7 @@ ForwardRenderer::ForwardRenderer() :
 }
 
 void ForwardRenderer::DrawFrame(Scene* scene, Camera* camera) {
+	scene->UpdateTransforms();
 	GLint originalViewport[4];
 	glGetIntegerv(GL_VIEWPORT, originalViewport);
 
@@ -29,10 +30,10 @@ void ForwardRenderer::DrawFrame(Scene* scene, Camera* camera) {
 	glViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
 }
 
-void ForwardRenderer::DrawObject(SceneObject* object, Mat4 parentTransform) {
+void ForwardRenderer::DrawObject(SceneObject* object) {
 	if (!object) return;
 
-	Mat4 objectTransform = parentTransform * object->GetTransform().GetMatrix();
+	const Mat4& objectTransform = object->GetWorldTransform().GetMatrix();
 	if (const MeshAnimatorComponent* animatorComponent = object->GetComponent<MeshAnimatorComponent>()) {
 		std::array<Mat4, MaxBonesPerModel> boneMatricesBuffer;
 		animatorComponent->GetBoneMatrices(0.0f, boneMatricesBuffer);
@@ -57,7 +58,7 @@ void ForwardRenderer::DrawObject(SceneObject* object, Mat4 parentTransform) {
 		sphere->Draw();
 	}
 	for (size_t i = 0; i < object->GetChildren().size(); i++) {
-		DrawObject(object->GetChild((int32_t)i), objectTransform);
+		DrawObject(object->GetChild((int32_t)i));
 	}
 }
 
@@ -71,10 +72,10 @@ void ForwardRenderer::SetupLights(Scene* scene) {
 	// Point lights
 	const size_t MaxPointLights = 32;
 	int32_t nPointLights = 0;
-	const std::vector<PointLightComponent*>& pointLights = scene->GetPointLights();
+	ComponentView<PointLightComponent> pointLights = scene->GetPointLights();
 	for (size_t i = 0; i < pointLights.size() && i < MaxPointLights; i++) {
 		const std::string base = std::string("pointLights[") + std::to_string(nPointLights) + std::string("].");
-		m_defaultShader.SetUniform3f(base + std::string("position"), pointLights[i]->GetParent()->GetTransform().GetPosition());
+		m_defaultShader.SetUniform3f(base + std::string("position"), pointLights[i]->GetParent()->GetWorldTransform().GetPosition());
 		m_defaultShader.SetUniform3f(base + std::string("emission"), pointLights[i]->GetEmission());
 		nPointLights++;
 	}
@@ -83,7 +84,7 @@ void ForwardRenderer::SetupLights(Scene* scene) {
 	// Area lights
 	const size_t MaxAreaLights = 32;
 	int32_t nAreaLights = 0;
-	const std::vector<AreaLightComponent*>& areaLights = scene->GetAreaLights();
+	ComponentView<AreaLightComponent> areaLights = scene->GetAreaLights();
 	for (size_t i = 0; i < areaLights.size(); i++) {
 		MeshComponent* meshComponent = areaLights[i]->GetParent()->GetComponent<MeshComponent>();
 		if (!meshComponent) continue;
@@ -110,7 +111,7 @@ void ForwardRenderer::SetupLights(Scene* scene) {
 }
 
 void ForwardRenderer::SetupMaterial(Material* material) {
-	m_defaultShader.SetTexture("albedoMap", material->m_albedoTexture.GetID(), 0);
+	m_defaultShader.SetTexture("albedoMap", material->GetAlbedoTextureID(), 0);
 	m_defaultShader.SetTexture("normalMap", material->m_normalTexture.GetID(), 1);
 	m_defaultShader.SetTexture("metallicMap", material->m_metallicTexture.GetID(), 2);
 	m_defaultShader.SetTexture("roughnessMap", material->m_roughnessTexture.GetID(), 3);
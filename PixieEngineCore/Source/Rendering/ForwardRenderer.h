@@ -20,7 +20,7 @@ protected:
 	Texture m_LTC1Texture;
 	Texture m_LTC2Texture;
 
-	void DrawObject(SceneObject* object, Mat4 parentTransform = Mat4(1.0f));
+	void DrawObject(SceneObject* object);
 	void SetupCamera(Camera* camera);
 	void SetupLights(Scene* scene);
 	void SetupMaterial(Material* material);
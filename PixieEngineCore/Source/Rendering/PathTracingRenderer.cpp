@@ -3,8 +3,7 @@
 
 PathTracingRenderer::PathTracingRenderer() :
 	m_frameBuffer({1280, 720}), m_camera(Vec3(-10, 0, 0), Vec3(0, 0, 0), Vec3(0, 1, 0), glm::radians(39.6f), { 1280, 720 }, 0, 10),
-	m_film({ 1280, 720 }), m_boxTestsTexture({ 1280, 720 }), m_shapeTestsTexture({ 1280, 720 }),
-	m_normalTexture({ 1280, 720 }), m_depthTexture({ 1280, 720 }) {}
+	m_film({ 1280, 720 }), m_aovs({ 1280, 720 }) {}
 
 PathTracingRenderer::~PathTracingRenderer() {
 	StopRender();
@@ -17,8 +16,18 @@ void PathTracingRenderer::DrawFrame() {
 	m_frameBuffer.Bind();
 	m_frameBuffer.ResizeViewport();
 	m_frameBuffer.Clear();
-	m_film.m_texture.Upload();
-	GlobalRenderer::DrawAccumulatorTextureFitted(m_film.m_texture.GetID(), m_samples, m_film.m_texture.GetResolution(), m_frameBuffer.m_resolution);
+	if (m_denoise) {
+		UpdateDenoiser();
+	}
+	if (m_denoise && m_hasDenoisedImage) {
+		GlobalRenderer::DrawAccumulatorTextureFitted(m_denoisedTexture.GetID(), 1, m_denoisedTexture.GetResolution(), m_frameBuffer.m_resolution);
+	}
+	else {
+		m_film.m_texture.Upload();
+		// Adaptive sampling and splatting leave pixels with different sample weights, so they are normalized by accumulated weight instead.
+		bool normalizeByWeight = m_adaptiveSampling || m_film.m_splatSamples;
+		GlobalRenderer::DrawAccumulatorTextureFitted(m_film.m_texture.GetID(), normalizeByWeight ? 0 : GetSamplesCount(), m_film.m_texture.GetResolution(), m_frameBuffer.m_resolution);
+	}
 	m_frameBuffer.Unbind();
 
 	glViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
@@ -28,7 +37,7 @@ void PathTracingRenderer::Reset() {
 	bool wasRendering = m_isRendering;
 	StopRender();
 	m_film.Reset();
-	m_samples = 1;
+	m_aovs.Reset();
 	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
 }
 
@@ -39,45 +48,48 @@ void PathTracingRenderer::StartRender(std::shared_ptr<SceneSnapshot> sceneSnapsh
 	m_camera = camera;
 	m_frameBuffer.Resize(m_camera.GetResolution());
 	m_film.Resize(m_camera.GetResolution());
-	m_samples = 1;
+	m_aovs.Resize(m_camera.GetResolution());
 	m_isRendering = true;
 
 	m_renderStartTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch());
-	m_sampleStartTime = m_renderStartTime;
 
-	m_rayTracer.SetSceneSnapshot(m_sceneSnapshot.get());
+	m_sceneSnapshot->SetBVHLayout(m_bvhLayout);
+	m_rayTracer.SetSceneSnapshot(m_sceneSnapshot.get(), m_lightSamplerType);
 
-	GenerateTiles();
-	ResetTileQueue();
+	m_denoiser.Discard();
+	m_lastDenoisePass = 0;
+	m_hasDenoisedImage = false;
 
-	m_threadsCount = std::min(m_maxThreads, (int32_t)m_tiles.size());
+	m_convergedPixels.assign((size_t)m_film.m_resolution.x * m_film.m_resolution.y, 0);
+	m_tileScheduler.SetErrorTarget(m_adaptiveSampling ? m_errorTarget : 0.0f);
+	m_tileScheduler.Start(m_film.m_resolution, m_maxThreads, 1, m_samplesPerPixel);
+	m_threadsCount = std::min(m_maxThreads, m_tileScheduler.GetTilesCount());
 
 	for (int32_t i = 0; i < m_threadsCount; i++) {
-		m_renderThreads.push_back(new std::thread([&]() {
-			std::shared_ptr<Sampler> sampler = std::make_shared<IndependentSampler>(m_samplesPerPixel);
-			while (m_isRendering && m_samples < m_samplesPerPixel) {
-				m_tileQueueMutex.lock();
-				if (m_tileQueue.empty()) {
-					std::chrono::microseconds currrentTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch());
-					m_lastSampleTime = currrentTime - m_sampleStartTime;
-					m_sampleStartTime = currrentTime;
-					m_samples++;
-					for (size_t i = 0; i < m_tiles.size(); i++) {
-						m_tileQueue.push((int32_t)i);
-					}
+		m_renderThreads.push_back(new std::thread([this, i]() {
+			std::shared_ptr<Sampler> sampler(CreateSampler(m_samplerType, m_samplesPerPixel, m_film.m_resolution));
+			std::vector<std::shared_ptr<Sampler>> tileSamplers;
+			FilmTile filmTile;
+			int32_t index, pass;
+			while (m_isRendering && m_tileScheduler.GetNextTile(i, index, pass)) {
+				Bounds2i quad = m_tileScheduler.GetTile(index);
+				m_film.StartTile(filmTile, quad);
+				if (m_integratorMode == IntegratorMode::Wavefront) {
+					PerTile(quad, pass, sampler.get(), tileSamplers, filmTile);
+					if (!m_isRendering) return;
 				}
-				int32_t index = m_tileQueue.front();
-				m_tileQueue.pop();
-				m_tileQueueMutex.unlock();
-
-				Bounds2i quad = m_tiles[index];
-				for (int32_t y = quad.min.y; y < quad.max.y; y++) {
-					for (int32_t x = quad.min.x; x < quad.max.x; x++) {
-						sampler->StartPixelSample(glm::ivec2(x, y), m_samples);
-						PerPixel(x, y, sampler.get());
-						if (!m_isRendering) return;
+				else {
+					for (int32_t y = quad.min.y; y < quad.max.y; y++) {
+						for (int32_t x = quad.min.x; x < quad.max.x; x++) {
+							if (IsPixelConverged(x, y)) continue;
+							sampler->StartPixelSample(glm::ivec2(x, y), pass);
+							PerPixel(x, y, pass, sampler.get(), filmTile);
+							if (!m_isRendering) return;
+						}
 					}
 				}
+				m_film.MergeTile(filmTile);
+				m_tileScheduler.FinishTile(i, EvaluateTile(quad, pass));
 			}
 			})
 		);
@@ -92,6 +104,7 @@ void PathTracingRenderer::PauseRender() {
 void PathTracingRenderer::StopRender() {
 	if (!m_isRendering) return;
 	m_isRendering = false;
+	m_tileScheduler.Stop();
 	for (int32_t i = 0; i < m_renderThreads.size(); i++) {
 		m_renderThreads[i]->join();
 	}
@@ -102,7 +115,7 @@ void PathTracingRenderer::StopRender() {
 }
 
 uint32_t PathTracingRenderer::GetSamplesCount() const {
-	return m_samples;
+	return std::max(m_tileScheduler.GetPass(), 1);
 }
 
 int32_t PathTracingRenderer::GetMaxRenderThreads() {
@@ -123,45 +136,284 @@ Float PathTracingRenderer::GetRenderTime() const {
 }
 
 Float PathTracingRenderer::GetLastSampleTime() const {
-	return m_lastSampleTime.count() / 1000.0f;
+	return m_tileScheduler.GetLastPassTime();
+}
+
+int32_t PathTracingRenderer::GetTileSize() const {
+	return m_tileScheduler.GetTileSize();
+}
+
+void PathTracingRenderer::SetTileSize(int32_t size) {
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_tileScheduler.SetTileSize(size);
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+std::vector<RenderThreadStats> PathTracingRenderer::GetThreadStats() const {
+	return m_tileScheduler.GetThreadStats();
+}
+
+BVHLayout PathTracingRenderer::GetBVHLayout() const {
+	return m_bvhLayout;
+}
+
+void PathTracingRenderer::SetBVHLayout(BVHLayout layout) {
+	if (m_bvhLayout == layout) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_bvhLayout = layout;
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+IntegratorMode PathTracingRenderer::GetIntegratorMode() const {
+	return m_integratorMode;
+}
+
+void PathTracingRenderer::SetIntegratorMode(IntegratorMode mode) {
+	if (m_integratorMode == mode) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_integratorMode = mode;
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+LightSamplerType PathTracingRenderer::GetLightSamplerType() const {
+	return m_lightSamplerType;
+}
+
+void PathTracingRenderer::SetLightSamplerType(LightSamplerType type) {
+	if (m_lightSamplerType == type) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_lightSamplerType = type;
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+SamplerType PathTracingRenderer::GetSamplerType() const {
+	return m_samplerType;
+}
+
+void PathTracingRenderer::SetSamplerType(SamplerType type) {
+	if (m_samplerType == type) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_samplerType = type;
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+bool PathTracingRenderer::GetAdaptiveSampling() const {
+	return m_adaptiveSampling;
+}
+
+void PathTracingRenderer::SetAdaptiveSampling(bool adaptiveSampling) {
+	if (m_adaptiveSampling == adaptiveSampling) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_adaptiveSampling = adaptiveSampling;
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+bool PathTracingRenderer::GetSplatSamples() const {
+	return m_film.m_splatSamples;
+}
+
+void PathTracingRenderer::SetSplatSamples(bool splatSamples) {
+	if (m_film.m_splatSamples == splatSamples) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_film.m_splatSamples = splatSamples;
+	m_film.Reset();
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
+}
+
+Float PathTracingRenderer::GetPixelErrorThreshold() const {
+	return m_pixelErrorThreshold;
+}
+
+void PathTracingRenderer::SetPixelErrorThreshold(Float threshold) {
+	m_pixelErrorThreshold = threshold;
+}
+
+Float PathTracingRenderer::GetErrorTarget() const {
+	return m_errorTarget;
+}
+
+void PathTracingRenderer::SetErrorTarget(Float errorTarget) {
+	m_errorTarget = errorTarget;
+	if (m_adaptiveSampling) {
+		m_tileScheduler.SetErrorTarget(errorTarget);
+	}
+}
+
+bool PathTracingRenderer::IsAOVEnabled(AOVType type) const {
+	return m_aovs.IsEnabled(type);
+}
+
+void PathTracingRenderer::SetAOVEnabled(AOVType type, bool enabled) {
+	if (m_aovs.IsEnabled(type) == enabled) return;
+	bool wasRendering = m_isRendering;
+	StopRender();
+	m_aovs.SetEnabled(type, enabled);
+	if (wasRendering) StartRender(m_sceneSnapshot, m_camera);
 }
 
-void PathTracingRenderer::PerPixel(uint32_t x, uint32_t y, Sampler* sampler) {
-	FilmFilter* filter = m_film.GetFilter();
-	CameraSample cameraSample = GetCameraSample(x, y, filter, sampler);
+bool PathTracingRenderer::SaveRender(const std::filesystem::path& filePath) const {
+	if (filePath.extension() == ".exr") {
+		return ImageWriter::WriteEXR(filePath, m_film.GetImage(), m_aovs.GetChannels());
+	}
+	return ImageWriter::Write(filePath, m_film.GetImage());
+}
+
+bool PathTracingRenderer::GetDenoise() const {
+	return m_denoise;
+}
+
+void PathTracingRenderer::SetDenoise(bool denoise) {
+	if (m_denoise == denoise) return;
+	if (denoise) {
+		SetAOVEnabled(AOVType::Albedo, true);
+		SetAOVEnabled(AOVType::Normal, true);
+		SetAOVEnabled(AOVType::Depth, true);
+	}
+	else {
+		m_denoiser.Discard();
+		m_lastDenoisePass = 0;
+		m_hasDenoisedImage = false;
+	}
+	m_denoise = denoise;
+}
+
+int32_t PathTracingRenderer::GetDenoiseInterval() const {
+	return m_denoiseInterval;
+}
+
+void PathTracingRenderer::SetDenoiseInterval(int32_t interval) {
+	m_denoiseInterval = std::max(interval, 1);
+}
+
+Float PathTracingRenderer::GetLastDenoiseTime() const {
+	return m_denoiser.GetLastDenoiseTime();
+}
+
+int64_t PathTracingRenderer::GetActivePixelsCount() const {
+	return m_tileScheduler.GetLastPassActivePixels();
+}
+
+Float PathTracingRenderer::GetError() const {
+	return m_tileScheduler.GetError();
+}
+
+void PathTracingRenderer::PerPixel(uint32_t x, uint32_t y, int32_t pass, Sampler* sampler, FilmTile& filmTile) {
+	CameraSample cameraSample = GetCameraSample(x, y, sampler);
 	Vec2 uv = m_film.GetUV(cameraSample.pFilm);
 	Ray ray = m_camera.GetRay(uv);
 	GBufferPixel pixel = m_rayTracer.SampleLightRay(ray, sampler);
-	m_boxTestsTexture.SetPixel({ x, y }, (Float)pixel.boxChecks);
-	m_shapeTestsTexture.SetPixel({ x, y }, (Float)pixel.shapeChecks);
-	m_normalTexture.SetPixel({ x, y }, glm::abs(pixel.normal));
-	m_depthTexture.SetPixel({ x, y }, pixel.depth);
-	m_film.AddSample(x, y, pixel.light, cameraSample.filterWeight);
+	if (m_aovs.HasEnabled()) {
+		m_aovs.AddSample(x, y, pixel);
+	}
+	m_film.AddSample(filmTile, { x, y }, cameraSample.pFilm, pixel.light, cameraSample.filterWeight, pass);
 }
 
-CameraSample PathTracingRenderer::GetCameraSample(uint32_t x, uint32_t y, const FilmFilter* filter, Sampler* sampler) {
-	FilmFilterSample fs = filter->Sample(sampler->GetPixel2D());
-	return CameraSample(Vec2(x, y) + fs.p + Vec2(0.5f, 0.5f), fs.weight);
+// Picks up finished denoised frame and submits a new one every denoise interval passes and after the last pass.
+void PathTracingRenderer::UpdateDenoiser() {
+	Buffer2D<Vec3> image({ 0, 0 });
+	int32_t denoisedPass;
+	if (m_denoiser.FetchResult(image, denoisedPass)) {
+		m_denoisedTexture.SetBuffer(image);
+		m_denoisedTexture.Upload();
+		m_hasDenoisedImage = true;
+	}
+
+	int32_t finishedPasses = m_tileScheduler.GetPass() - 1;
+	bool isFinished = m_tileScheduler.IsConverged() || m_tileScheduler.GetPass() >= m_samplesPerPixel;
+	if (!m_isRendering || finishedPasses < 1 || finishedPasses == m_lastDenoisePass) return;
+	if (m_lastDenoisePass > 0 && finishedPasses < m_lastDenoisePass + m_denoiseInterval && !isFinished) return;
+	if (m_denoiser.IsBusy()) return;
+
+	DenoiserFrame frame;
+	frame.color = m_film.GetImage();
+	frame.albedo = m_aovs.GetLayer(AOVType::Albedo);
+	frame.normal = m_aovs.GetLayer(AOVType::Normal);
+	Buffer2D<Vec3> depth = m_aovs.GetLayer(AOVType::Depth);
+	frame.depth = Buffer2D<Float>(depth.GetResolution());
+	for (size_t i = 0; i < depth.GetSize(); i++) {
+		frame.depth.m_data[i] = depth.m_data[i].x;
+	}
+	frame.pass = finishedPasses;
+	if (m_denoiser.Submit(std::move(frame))) {
+		m_lastDenoisePass = finishedPasses;
+	}
+}
+
+bool PathTracingRenderer::IsPixelConverged(int32_t x, int32_t y) const {
+	return m_adaptiveSampling && m_convergedPixels[(size_t)y * m_film.m_resolution.x + x];
 }
 
-void PathTracingRenderer::GenerateTiles() {
-	m_tiles.clear();
-	glm::ivec2 resolution = m_film.m_resolution;
-	glm::ivec2 tileGridSize = glm::ceil(Vec2(resolution) / Vec2(m_tileSize));
-	for (int32_t yTile = 0; yTile < tileGridSize.y; yTile++) {
-		for (int32_t xTile = 0; xTile < tileGridSize.x; xTile++) {
-			int32_t xMax = glm::min(resolution.x, (xTile + 1) * m_tileSize.x);
-			int32_t yMax = glm::min(resolution.y, (yTile + 1) * m_tileSize.y);
-			glm::ivec2 min = glm::ivec2(xTile * m_tileSize.x, yTile * m_tileSize.y);
-			glm::ivec2 max = glm::ivec2(xMax, yMax);
-			m_tiles.push_back(Bounds2i(min, max));
+// Sums pixel errors of the tile and, after enough passes, excludes pixels below the error threshold from sampling.
+TilePassStats PathTracingRenderer::EvaluateTile(const Bounds2i& quad, int32_t pass) {
+	TilePassStats stats;
+	bool canConverge = m_adaptiveSampling && pass >= c_adaptiveMinPasses;
+	stats.isConverged = canConverge;
+	for (int32_t y = quad.min.y; y < quad.max.y; y++) {
+		for (int32_t x = quad.min.x; x < quad.max.x; x++) {
+			Float error = m_film.GetPixelError(x, y);
+			stats.errorSum += error;
+			if (IsPixelConverged(x, y)) continue;
+			stats.activePixels++;
+			if (canConverge && error <= m_pixelErrorThreshold) {
+				m_convergedPixels[(size_t)y * m_film.m_resolution.x + x] = 1;
+			}
+			else {
+				stats.isConverged = false;
+			}
 		}
 	}
+	return stats;
 }
 
-void PathTracingRenderer::ResetTileQueue() {
-	m_tileQueue = std::queue<int32_t>();
-	for (size_t i = 0; i < m_tiles.size(); i++) {
-		m_tileQueue.push((int32_t)i);
+CameraSample PathTracingRenderer::GetCameraSample(uint32_t x, uint32_t y, Sampler* sampler) {
+	FilmFilterSample fs = m_film.SampleFilter(sampler->GetPixel2D());
+	return CameraSample(Vec2(x, y) + fs.p + Vec2(0.5f, 0.5f), fs.weight);
+}
+
+void PathTracingRenderer::PerTile(const Bounds2i& quad, int32_t pass, const Sampler* prototype, std::vector<std::shared_ptr<Sampler>>& samplers, FilmTile& filmTile) {
+	std::vector<glm::ivec2> pixelCoords;
+	for (int32_t y = quad.min.y; y < quad.max.y; y++) {
+		for (int32_t x = quad.min.x; x < quad.max.x; x++) {
+			if (!IsPixelConverged(x, y)) {
+				pixelCoords.push_back(glm::ivec2(x, y));
+			}
+		}
+	}
+	int32_t pixelsCount = (int32_t)pixelCoords.size();
+	while ((int32_t)samplers.size() < pixelsCount) {
+		samplers.push_back(std::shared_ptr<Sampler>(prototype->Clone()));
+	}
+
+	std::vector<CameraSample> cameraSamples;
+	std::vector<Ray> rays;
+	std::vector<Sampler*> raySamplers;
+	std::vector<GBufferPixel> pixels;
+	cameraSamples.reserve(pixelsCount);
+	rays.reserve(pixelsCount);
+	raySamplers.reserve(pixelsCount);
+	for (int32_t i = 0; i < pixelsCount; i++) {
+		Sampler* sampler = samplers[i].get();
+		sampler->StartPixelSample(pixelCoords[i], pass);
+		cameraSamples.push_back(GetCameraSample(pixelCoords[i].x, pixelCoords[i].y, sampler));
+		rays.push_back(m_camera.GetRay(m_film.GetUV(cameraSamples.back().pFilm)));
+		raySamplers.push_back(sampler);
+	}
+
+	m_rayTracer.SampleLightRays(rays, raySamplers, pixels);
+
+	for (int32_t i = 0; i < pixelsCount; i++) {
+		uint32_t x = pixelCoords[i].x, y = pixelCoords[i].y;
+		const GBufferPixel& pixel = pixels[i];
+		if (m_aovs.HasEnabled()) {
+			m_aovs.AddSample(x, y, pixel);
+		}
+		m_film.AddSample(filmTile, pixelCoords[i], cameraSamples[i].pFilm, pixel.light, cameraSamples[i].filterWeight, pass);
 	}
 }
@@ -3,8 +3,11 @@
 #include "FrameBuffer.h"
 #include "RayTracing/VolumetricRayTracer.h"
 #include "RayTracing/Film.h"
+#include "RayTracing/AOVBuffer.h"
 #include "Scene/SceneManager.h"
 #include "GlobalRenderer.h"
+#include "TileScheduler.h"
+#include "Denoiser.h"
 
 class PathTracingRenderer {
 public:
@@ -26,31 +29,71 @@ public:
 	uint32_t GetSamplesCount() const;
 	Float GetRenderTime() const;
 	Float GetLastSampleTime() const;
+	int32_t GetTileSize() const;
+	void SetTileSize(int32_t size);
+	std::vector<RenderThreadStats> GetThreadStats() const;
+	BVHLayout GetBVHLayout() const;
+	void SetBVHLayout(BVHLayout layout);
+	IntegratorMode GetIntegratorMode() const;
+	void SetIntegratorMode(IntegratorMode mode);
+	LightSamplerType GetLightSamplerType() const;
+	void SetLightSamplerType(LightSamplerType type);
+	SamplerType GetSamplerType() const;
+	void SetSamplerType(SamplerType type);
+	bool GetAdaptiveSampling() const;
+	void SetAdaptiveSampling(bool adaptiveSampling);
+	bool GetSplatSamples() const;
+	void SetSplatSamples(bool splatSamples);
+	Float GetPixelErrorThreshold() const;
+	void SetPixelErrorThreshold(Float threshold);
+	Float GetErrorTarget() const;
+	void SetErrorTarget(Float errorTarget);
+	bool IsAOVEnabled(AOVType type) const;
+	void SetAOVEnabled(AOVType type, bool enabled);
+	// Writes beauty image, EXR files also get all enabled AOVs as separate layers.
+	bool SaveRender(const std::filesystem::path& filePath) const;
+	bool GetDenoise() const;
+	void SetDenoise(bool denoise);
+	int32_t GetDenoiseInterval() const;
+	void SetDenoiseInterval(int32_t interval);
+	Float GetLastDenoiseTime() const;
+	int64_t GetActivePixelsCount() const;
+	Float GetError() const;
 
 protected:
-	const glm::ivec2 m_tileSize = glm::ivec2(32, 32);
 	VolumetricRayTracer m_rayTracer;
 	Film m_film;
 	bool m_isRendering = false;
 	bool m_isPaused = false;
-	int32_t m_samples = 1;
 	int32_t m_maxThreads = 1;
 	int32_t m_samplesPerPixel = 8192;
 	int32_t m_threadsCount = 0;
+	BVHLayout m_bvhLayout = BVHLayout::Binary;
+	IntegratorMode m_integratorMode = IntegratorMode::Recursive;
+	LightSamplerType m_lightSamplerType = LightSamplerType::BVH;
+	SamplerType m_samplerType = SamplerType::ZSobol;
+	bool m_adaptiveSampling = false;
+	Float m_pixelErrorThreshold = 0.01f;
+	Float m_errorTarget = 0.002f;
+	// Pixels excluded from adaptive sampling, each one is written only by the thread rendering its tile.
+	std::vector<uint8_t> m_convergedPixels;
 	std::vector<std::thread*> m_renderThreads;
-	std::vector<Bounds2i> m_tiles;
-	std::queue<int32_t> m_tileQueue;
-	std::mutex m_tileQueueMutex;
+	TileScheduler m_tileScheduler;
 	std::chrono::microseconds m_renderStartTime = std::chrono::microseconds(0);
-	std::chrono::microseconds m_sampleStartTime = std::chrono::microseconds(0);
-	std::chrono::microseconds m_lastSampleTime = std::chrono::microseconds(0);
-	Buffer2DTexture<Float> m_boxTestsTexture;
-	Buffer2DTexture<Float> m_shapeTestsTexture;
-	Buffer2DTexture<Vec3> m_normalTexture;
-	Buffer2DTexture<Float> m_depthTexture;
+	AOVBuffer m_aovs;
+	bool m_denoise = false;
+	int32_t m_denoiseInterval = 8; // passes between denoised frames
+	int32_t m_lastDenoisePass = 0;
+	bool m_hasDenoisedImage = false;
+	Buffer2DTexture<Vec3> m_denoisedTexture;
+	Denoiser m_denoiser;
 
-	void GenerateTiles();
-	void ResetTileQueue();
-	void PerPixel(uint32_t x, uint32_t y, Sampler* sampler);
-	CameraSample GetCameraSample(uint32_t x, uint32_t y, const FilmFilter* filter, Sampler* sampler);
+	static constexpr int32_t c_adaptiveMinPasses = 16;
+
+	void PerPixel(uint32_t x, uint32_t y, int32_t pass, Sampler* sampler, FilmTile& filmTile);
+	void PerTile(const Bounds2i& quad, int32_t pass, const Sampler* prototype, std::vector<std::shared_ptr<Sampler>>& samplers, FilmTile& filmTile);
+	void UpdateDenoiser();
+	bool IsPixelConverged(int32_t x, int32_t y) const;
+	TilePassStats EvaluateTile(const Bounds2i& quad, int32_t pass);
+	CameraSample GetCameraSample(uint32_t x, uint32_t y, Sampler* sampler);
 };
\ No newline at end of file
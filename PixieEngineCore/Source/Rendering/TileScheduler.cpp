@@ -0,0 +1,207 @@
+#include "pch.h"
+#include "TileScheduler.h"
+
+static int64_t GetTimeMicroseconds() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+	Render Thread Stats
+*/
+
+Float RenderThreadStats::GetUtilization() const {
+	Float total = busyTime + idleTime;
+	return total > 0.0f ? busyTime / total : 0.0f;
+}
+
+/*
+	Tile Scheduler
+*/
+
+void TileScheduler::Start(glm::ivec2 resolution, int32_t threadsCount, int32_t firstPass, int32_t maxPasses) {
+	GenerateTiles(resolution, threadsCount);
+	threadsCount = std::min(threadsCount, (int32_t)m_tiles.size());
+
+	m_threads.clear();
+	for (int32_t i = 0; i < threadsCount; i++) {
+		std::unique_ptr<ThreadState> state = std::make_unique<ThreadState>();
+		state->tilesStart = (int32_t)((int64_t)m_tiles.size() * i / threadsCount);
+		state->tilesEnd = (int32_t)((int64_t)m_tiles.size() * (i + 1) / threadsCount);
+		state->deque.Reset((int32_t)m_tiles.size());
+		state->pass = firstPass - 1;
+		m_threads.push_back(std::move(state));
+	}
+
+	m_maxPasses = maxPasses;
+	m_activeTiles.assign(m_tiles.size(), 1);
+	m_tileErrors.assign(m_tiles.size(), Infinity);
+	m_activeTilesCount = (int32_t)m_tiles.size();
+	m_passActivePixels = 0;
+	m_lastPassActivePixels = 0;
+	m_error = Infinity;
+	m_isConverged = false;
+	m_remainingTiles = (int32_t)m_tiles.size();
+	m_passStartTime = GetTimeMicroseconds();
+	m_lastPassTime = 0;
+	m_pass = firstPass;
+	m_isRunning = true;
+}
+
+void TileScheduler::Stop() {
+	m_isRunning = false;
+}
+
+bool TileScheduler::GetNextTile(int32_t threadIndex, int32_t& tileIndex, int32_t& pass) {
+	ThreadState& state = *m_threads[threadIndex];
+	int32_t threadsCount = (int32_t)m_threads.size();
+	int64_t idleStart = GetTimeMicroseconds();
+	while (m_isRunning && !m_isConverged) {
+		int32_t currentPass = m_pass.load(std::memory_order_acquire);
+		if (currentPass >= m_maxPasses) break;
+		if (state.pass < currentPass) {
+			RefillDeque(state, currentPass);
+		}
+
+		int64_t item;
+		bool found = state.deque.Pop(item);
+		for (int32_t i = 1; !found && i < threadsCount; i++) {
+			found = m_threads[(threadIndex + i) % threadsCount]->deque.Steal(item);
+			if (found) state.tilesStolen.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (found) {
+			tileIndex = (int32_t)(item & 0xffffffff);
+			pass = (int32_t)(item >> 32);
+			state.tileIndex = tileIndex;
+			state.tileStartTime = std::chrono::steady_clock::now();
+			state.idleTime.fetch_add(GetTimeMicroseconds() - idleStart, std::memory_order_relaxed);
+			return true;
+		}
+		// Remaining tiles of the pass are being rendered by other threads.
+		std::this_thread::yield();
+	}
+	state.idleTime.fetch_add(GetTimeMicroseconds() - idleStart, std::memory_order_relaxed);
+	return false;
+}
+
+void TileScheduler::FinishTile(int32_t threadIndex, const TilePassStats& stats) {
+	ThreadState& state = *m_threads[threadIndex];
+	std::chrono::microseconds busyTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - state.tileStartTime);
+	state.busyTime.fetch_add(busyTime.count(), std::memory_order_relaxed);
+	state.tilesRendered.fetch_add(1, std::memory_order_relaxed);
+	m_tileErrors[state.tileIndex] = stats.errorSum;
+	if (stats.isConverged) {
+		m_activeTiles[state.tileIndex] = 0;
+	}
+	m_passActivePixels.fetch_add(stats.activePixels, std::memory_order_relaxed);
+
+	if (m_remainingTiles.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		int64_t currentTime = GetTimeMicroseconds();
+		m_lastPassTime = currentTime - m_passStartTime;
+		m_passStartTime = currentTime;
+		m_lastPassActivePixels = m_passActivePixels.exchange(0, std::memory_order_relaxed);
+
+		int32_t activeTilesCount = (int32_t)std::count(m_activeTiles.begin(), m_activeTiles.end(), 1);
+		int64_t pixelsCount = 0;
+		for (const Bounds2i& tile : m_tiles) {
+			pixelsCount += (int64_t)tile.Area();
+		}
+		m_activeTilesCount = activeTilesCount;
+		m_error = std::accumulate(m_tileErrors.begin(), m_tileErrors.end(), (Float)0) / std::max<int64_t>(pixelsCount, 1);
+		if (activeTilesCount == 0 || (m_errorTarget > 0.0f && m_error <= m_errorTarget)) {
+			m_isConverged = true;
+		}
+
+		m_remainingTiles.store(activeTilesCount, std::memory_order_relaxed);
+		m_pass.fetch_add(1, std::memory_order_release);
+	}
+}
+
+const Bounds2i& TileScheduler::GetTile(int32_t index) const {
+	return m_tiles[index];
+}
+
+int32_t TileScheduler::GetTilesCount() const {
+	return (int32_t)m_tiles.size();
+}
+
+int32_t TileScheduler::GetTileSize() const {
+	return m_tileSize;
+}
+
+void TileScheduler::SetTileSize(int32_t size) {
+	m_fixedTileSize = size;
+}
+
+void TileScheduler::SetErrorTarget(Float errorTarget) {
+	m_errorTarget = errorTarget;
+}
+
+bool TileScheduler::IsConverged() const {
+	return m_isConverged;
+}
+
+int32_t TileScheduler::GetActiveTilesCount() const {
+	return m_activeTilesCount;
+}
+
+int64_t TileScheduler::GetLastPassActivePixels() const {
+	return m_lastPassActivePixels;
+}
+
+Float TileScheduler::GetError() const {
+	return m_error;
+}
+
+int32_t TileScheduler::GetPass() const {
+	return m_pass;
+}
+
+Float TileScheduler::GetLastPassTime() const {
+	return m_lastPassTime / 1000.0f;
+}
+
+std::vector<RenderThreadStats> TileScheduler::GetThreadStats() const {
+	std::vector<RenderThreadStats> stats(m_threads.size());
+	for (size_t i = 0; i < m_threads.size(); i++) {
+		stats[i].tilesRendered = m_threads[i]->tilesRendered;
+		stats[i].tilesStolen = m_threads[i]->tilesStolen;
+		stats[i].busyTime = m_threads[i]->busyTime / 1000000.0f;
+		stats[i].idleTime = m_threads[i]->idleTime / 1000000.0f;
+	}
+	return stats;
+}
+
+void TileScheduler::GenerateTiles(glm::ivec2 resolution, int32_t threadsCount) {
+	// Pick the largest tile size that still gives every thread enough tiles to balance load.
+	m_tileSize = m_fixedTileSize > 0 ? m_fixedTileSize : c_maxTileSize;
+	if (m_fixedTileSize <= 0) {
+		while (m_tileSize > c_minTileSize) {
+			glm::ivec2 tileGridSize = (resolution + m_tileSize - 1) / m_tileSize;
+			if (tileGridSize.x * tileGridSize.y >= threadsCount * c_targetTilesPerThread) break;
+			m_tileSize /= 2;
+		}
+	}
+
+	m_tiles.clear();
+	glm::ivec2 tileGridSize = (resolution + m_tileSize - 1) / m_tileSize;
+	for (int32_t yTile = 0; yTile < tileGridSize.y; yTile++) {
+		for (int32_t xTile = 0; xTile < tileGridSize.x; xTile++) {
+			int32_t xMax = glm::min(resolution.x, (xTile + 1) * m_tileSize);
+			int32_t yMax = glm::min(resolution.y, (yTile + 1) * m_tileSize);
+			glm::ivec2 min = glm::ivec2(xTile * m_tileSize, yTile * m_tileSize);
+			glm::ivec2 max = glm::ivec2(xMax, yMax);
+			m_tiles.push_back(Bounds2i(min, max));
+		}
+	}
+}
+
+void TileScheduler::RefillDeque(ThreadState& state, int32_t pass) {
+	// Pushed in reverse, so owner pops tiles in order and thieves take them from the end of the range.
+	for (int32_t i = state.tilesEnd - 1; i >= state.tilesStart; i--) {
+		if (m_activeTiles[i]) {
+			state.deque.Push(((int64_t)pass << 32) | (uint32_t)i);
+		}
+	}
+	state.pass = pass;
+}
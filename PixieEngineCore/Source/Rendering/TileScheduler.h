@@ -0,0 +1,85 @@
+#pragma once
+#include "pch.h"
+#include "Math/Bounds.h"
+#include "WorkStealingDeque.h"
+
+struct RenderThreadStats {
+	uint64_t tilesRendered = 0;
+	uint64_t tilesStolen = 0;
+	Float busyTime = 0.0f;
+	Float idleTime = 0.0f;
+
+	Float GetUtilization() const;
+};
+
+// Result of rendering one tile in a pass, reported back for adaptive sampling.
+struct TilePassStats {
+	int32_t activePixels = 0; // pixels that received a sample in this pass
+	Float errorSum = 0.0f; // sum of error estimates of all tile pixels
+	bool isConverged = false; // tile is not scheduled in following passes
+};
+
+// Lock-free tile distribution for progressive rendering. Each pass renders every tile once,
+// threads start with their own contiguous range of tiles and steal from others when it runs out.
+class TileScheduler {
+public:
+	void Start(glm::ivec2 resolution, int32_t threadsCount, int32_t firstPass, int32_t maxPasses);
+	void Stop();
+	bool GetNextTile(int32_t threadIndex, int32_t& tileIndex, int32_t& pass);
+	void FinishTile(int32_t threadIndex, const TilePassStats& stats);
+
+	const Bounds2i& GetTile(int32_t index) const;
+	int32_t GetTilesCount() const;
+	int32_t GetTileSize() const;
+	void SetTileSize(int32_t size);
+	// Mean pixel error at which rendering stops, zero renders all passes.
+	void SetErrorTarget(Float errorTarget);
+	bool IsConverged() const;
+	int32_t GetActiveTilesCount() const;
+	int64_t GetLastPassActivePixels() const;
+	Float GetError() const;
+	int32_t GetPass() const;
+	Float GetLastPassTime() const;
+	std::vector<RenderThreadStats> GetThreadStats() const;
+
+protected:
+	struct alignas(64) ThreadState {
+		WorkStealingDeque deque;
+		int32_t pass = 0;
+		int32_t tilesStart = 0;
+		int32_t tilesEnd = 0;
+		int32_t tileIndex = 0;
+		std::chrono::steady_clock::time_point tileStartTime;
+		std::atomic<uint64_t> tilesRendered = 0;
+		std::atomic<uint64_t> tilesStolen = 0;
+		std::atomic<uint64_t> busyTime = 0;
+		std::atomic<uint64_t> idleTime = 0;
+	};
+
+	static constexpr int32_t c_minTileSize = 8;
+	static constexpr int32_t c_maxTileSize = 64;
+	static constexpr int32_t c_targetTilesPerThread = 16;
+
+	int32_t m_fixedTileSize = 0;
+	int32_t m_tileSize = c_maxTileSize;
+	int32_t m_maxPasses = 0;
+	std::atomic<Float> m_errorTarget = 0.0f;
+	std::vector<Bounds2i> m_tiles;
+	// Written only by the thread finishing the tile, read after the pass is complete.
+	std::vector<uint8_t> m_activeTiles;
+	std::vector<Float> m_tileErrors;
+	std::vector<std::unique_ptr<ThreadState>> m_threads;
+	std::atomic<bool> m_isRunning = false;
+	std::atomic<int32_t> m_pass = 0;
+	std::atomic<int32_t> m_remainingTiles = 0;
+	std::atomic<int64_t> m_passStartTime = 0;
+	std::atomic<int64_t> m_lastPassTime = 0;
+	std::atomic<int64_t> m_passActivePixels = 0;
+	std::atomic<int64_t> m_lastPassActivePixels = 0;
+	std::atomic<int32_t> m_activeTilesCount = 0;
+	std::atomic<Float> m_error = Infinity;
+	std::atomic<bool> m_isConverged = false;
+
+	void GenerateTiles(glm::ivec2 resolution, int32_t threadsCount);
+	void RefillDeque(ThreadState& state, int32_t pass);
+};
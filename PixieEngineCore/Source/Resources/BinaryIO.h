@@ -0,0 +1,66 @@
+#pragma once
+#include "pch.h"
+
+// Raw binary serialization of trivially copyable values in native byte order, used for caches which are read back
+// by the same build only. Read functions return false once stream fails.
+template<typename T>
+inline void WriteBinary(std::ostream& stream, const T& value) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	stream.write((const char*)&value, sizeof(T));
+}
+
+template<typename T>
+inline bool ReadBinary(std::istream& stream, T& value) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	stream.read((char*)&value, sizeof(T));
+	return (bool)stream;
+}
+
+// Checks that count elements of elementSize bytes can still be read, so a size read from a truncated or corrupt file
+// fails the read instead of requesting a huge allocation. Small reads skip seeking to keep the stream buffer.
+inline bool HasBytesLeft(std::istream& stream, uint64_t count, uint64_t elementSize) {
+	if (count <= 4096 / elementSize) {
+		return true;
+	}
+	std::streampos position = stream.tellg();
+	if (position == std::streampos(-1) || !stream.seekg(0, std::ios::end)) {
+		return false;
+	}
+	std::streampos end = stream.tellg();
+	stream.seekg(position);
+	return (bool)stream && count <= (uint64_t)(end - position) / elementSize;
+}
+
+template<typename T>
+inline void WriteBinary(std::ostream& stream, const std::vector<T>& values) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	WriteBinary(stream, (uint64_t)values.size());
+	stream.write((const char*)values.data(), values.size() * sizeof(T));
+}
+
+template<typename T>
+inline bool ReadBinary(std::istream& stream, std::vector<T>& values) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	uint64_t size = 0;
+	if (!ReadBinary(stream, size) || !HasBytesLeft(stream, size, sizeof(T))) {
+		return false;
+	}
+	values.resize(size);
+	stream.read((char*)values.data(), size * sizeof(T));
+	return (bool)stream;
+}
+
+inline void WriteBinary(std::ostream& stream, const std::string& value) {
+	WriteBinary(stream, (uint64_t)value.size());
+	stream.write(value.data(), value.size());
+}
+
+inline bool ReadBinary(std::istream& stream, std::string& value) {
+	uint64_t size = 0;
+	if (!ReadBinary(stream, size) || !HasBytesLeft(stream, size, 1)) {
+		return false;
+	}
+	value.resize(size);
+	stream.read(value.data(), size);
+	return (bool)stream;
+}
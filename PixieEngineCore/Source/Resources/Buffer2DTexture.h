@@ -1,6 +1,7 @@
 #pragma once
 #include "Texture.h"
 #include "Buffer2D.h"
+#include "MIPMap.h"
 
 template<class T>
 class Buffer2DTexture {
@@ -11,19 +12,32 @@ public:
 	GLuint GetID() const;
 	glm::ivec2 GetResolution() const;
 	void Resize(glm::ivec2 resolution);
+	void SetBuffer(const Buffer2D<T>& buffer);
 	void Clear();
 	void SetPixel(uint32_t index, T value);
 	void SetPixel(glm::ivec2 coords, T value);
 	void AddPixel(uint32_t index, T value);
 	void AddPixel(glm::ivec2 coords, T value);
+	void AtomicAddPixel(glm::ivec2 coords, T value);
 	T GetPixel(uint32_t index) const;
 	T GetPixel(glm::ivec2 coords) const;
 	void Upload();
+	// Filtered lookup, uses MIP map if it was generated and nearest texel of base image otherwise.
 	T Sample(Vec2 coords) const;
+	T Sample(Vec2 coords, Float width) const;
+	// Pyramid is built from current pixels, it has to be generated again after they are modified.
+	void GenerateMIPMap();
+	WrapMode GetWrapMode() const;
+	void SetWrapMode(WrapMode mode);
+	TextureFilter GetFilter() const;
+	void SetFilter(TextureFilter filter);
 
 protected:
 	Buffer2D<T> m_buffer;
 	Texture m_texture;
+	WrapMode m_wrapMode = WrapMode::Repeat;
+	TextureFilter m_filter = TextureFilter::Trilinear;
+	std::shared_ptr<const MIPMap<T>> m_mipMap;
 };
 
 template<class T>
@@ -52,6 +66,14 @@ template<class T>
 inline void Buffer2DTexture<T>::Resize(glm::ivec2 resolution) {
 	m_texture.m_resolution = resolution;
 	m_buffer.Resize(resolution);
+	m_mipMap.reset();
+}
+
+template<class T>
+inline void Buffer2DTexture<T>::SetBuffer(const Buffer2D<T>& buffer) {
+	m_texture.m_resolution = buffer.m_resolution;
+	m_buffer = buffer;
+	m_mipMap.reset();
 }
 
 template<class T>
@@ -89,6 +111,14 @@ inline void Buffer2DTexture<T>::AddPixel(glm::ivec2 coords, T value) {
 	m_buffer.m_data[index] += value;
 }
 
+template<class T>
+inline void Buffer2DTexture<T>::AtomicAddPixel(glm::ivec2 coords, T value) {
+	if (coords.x < 0 || coords.x >= m_buffer.m_resolution.x || coords.y < 0 || coords.y >= m_buffer.m_resolution.y) {
+		return;
+	}
+	m_buffer.AtomicAddValue(coords.x, coords.y, value);
+}
+
 template<class T>
 inline T Buffer2DTexture<T>::GetPixel(uint32_t index) const {
 	if (index >= m_buffer.m_data.size()) return T();
@@ -110,6 +140,7 @@ inline void Buffer2DTexture<Float>::Upload() {
 	m_texture.m_internalFormat = GL_R32F;
 	m_texture.m_format = GL_RED;
 	m_texture.m_type = GL_FLOAT;
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_texture.m_id);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_texture.m_resolution.x, m_texture.m_resolution.y, 0, GL_RED, GL_FLOAT, m_buffer.Data());
 	glBindTexture(GL_TEXTURE_2D, 0);
@@ -121,6 +152,7 @@ inline void Buffer2DTexture<Vec3>::Upload() {
 	m_texture.m_internalFormat = GL_RGB32F;
 	m_texture.m_format = GL_RGBA;
 	m_texture.m_type = GL_FLOAT;
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_texture.m_id);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, m_texture.m_resolution.x, m_texture.m_resolution.y, 0, GL_RGB, GL_FLOAT, m_buffer.Data());
 	glBindTexture(GL_TEXTURE_2D, 0);
@@ -132,6 +164,7 @@ inline void Buffer2DTexture<Vec4>::Upload() {
 	m_texture.m_internalFormat = GL_RGBA32F;
 	m_texture.m_format = GL_RGBA;
 	m_texture.m_type = GL_FLOAT;
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_texture.m_id);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, m_texture.m_resolution.x, m_texture.m_resolution.y, 0, GL_RGBA, GL_FLOAT, m_buffer.Data());
 	glBindTexture(GL_TEXTURE_2D, 0);
@@ -139,6 +172,44 @@ inline void Buffer2DTexture<Vec4>::Upload() {
 
 template<class T>
 inline T Buffer2DTexture<T>::Sample(Vec2 coords) const {
-	glm::ivec2 c = Vec2(m_buffer.m_resolution) * coords;
-	return GetPixel(c);
+	return Sample(coords, 0.0f);
+}
+
+template<class T>
+inline T Buffer2DTexture<T>::Sample(Vec2 coords, Float width) const {
+	if (m_mipMap) {
+		return m_mipMap->Filter(coords, width, m_filter);
+	}
+	if (m_buffer.m_data.empty()) return T();
+	glm::ivec2 c = glm::ivec2(glm::floor(Vec2(m_buffer.m_resolution) * coords));
+	return GetPixel(WrapTexel(c, m_buffer.m_resolution, m_wrapMode));
+}
+
+template<class T>
+inline void Buffer2DTexture<T>::GenerateMIPMap() {
+	m_mipMap = std::make_shared<const MIPMap<T>>(m_buffer, m_wrapMode);
+}
+
+template<class T>
+inline WrapMode Buffer2DTexture<T>::GetWrapMode() const {
+	return m_wrapMode;
+}
+
+template<class T>
+inline void Buffer2DTexture<T>::SetWrapMode(WrapMode mode) {
+	if (m_wrapMode == mode) return;
+	m_wrapMode = mode;
+	if (m_mipMap) {
+		GenerateMIPMap();
+	}
+}
+
+template<class T>
+inline TextureFilter Buffer2DTexture<T>::GetFilter() const {
+	return m_filter;
+}
+
+template<class T>
+inline void Buffer2DTexture<T>::SetFilter(TextureFilter filter) {
+	m_filter = filter;
 }
@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "ImageWriter.h"
+
+template<typename T>
+inline void WriteBinary(std::vector<uint8_t>& buffer, T value) {
+	const uint8_t* bytes = (const uint8_t*)&value;
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+inline void WriteBinaryBigEndian(std::vector<uint8_t>& buffer, uint32_t value) {
+	buffer.push_back((uint8_t)(value >> 24));
+	buffer.push_back((uint8_t)(value >> 16));
+	buffer.push_back((uint8_t)(value >> 8));
+	buffer.push_back((uint8_t)(value));
+}
+
+inline void WriteString(std::vector<uint8_t>& buffer, const std::string& str) {
+	buffer.insert(buffer.end(), str.begin(), str.end());
+	buffer.push_back(0);
+}
+
+static bool SaveFile(const std::filesystem::path& filePath, const std::vector<uint8_t>& buffer) {
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file) {
+		std::cout << "Error: Failed to open file for writing: " << filePath << "\n";
+		return false;
+	}
+	file.write((const char*)buffer.data(), buffer.size());
+	return (bool)file;
+}
+
+static uint32_t CRC32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+	static const std::array<uint32_t, 256> table = []() {
+		std::array<uint32_t, 256> t;
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int32_t k = 0; k < 8; k++) {
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			t[i] = c;
+		}
+		return t;
+	}();
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) {
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static uint32_t Adler32(const std::vector<uint8_t>& data) {
+	uint32_t a = 1, b = 0;
+	for (size_t i = 0; i < data.size(); i++) {
+		a = (a + data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
+}
+
+static void WritePNGChunk(std::vector<uint8_t>& buffer, const char* type, const std::vector<uint8_t>& data) {
+	WriteBinaryBigEndian(buffer, (uint32_t)data.size());
+	size_t typeStart = buffer.size();
+	buffer.insert(buffer.end(), type, type + 4);
+	buffer.insert(buffer.end(), data.begin(), data.end());
+	WriteBinaryBigEndian(buffer, CRC32(buffer.data() + typeStart, buffer.size() - typeStart));
+}
+
+static uint8_t LinearToSRGB8(Float value) {
+	value = Clamp(value, 0.0f, 1.0f);
+	value = value <= 0.0031308f ? 12.92f * value : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	return (uint8_t)Clamp((int32_t)(value * 255.0f + 0.5f), 0, 255);
+}
+
+ImageChannel::ImageChannel(const std::string& name, glm::ivec2 resolution) :
+	m_name(name), m_data(resolution.x * resolution.y, 0.0f) {}
+
+bool ImageWriter::Write(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image) {
+	std::string extension = filePath.extension().string();
+	if (extension == ".pfm") {
+		return WritePFM(filePath, image);
+	}
+	else if (extension == ".png") {
+		return WritePNG(filePath, image);
+	}
+	else if (extension == ".exr") {
+		return WriteEXR(filePath, image);
+	}
+	std::cout << "Unsupported image format: " << filePath << "\n";
+	return false;
+}
+
+bool ImageWriter::WritePFM(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image) {
+	std::vector<uint8_t> buffer;
+	std::string header = "PF\n" + std::to_string(image.GetWidth()) + " " + std::to_string(image.GetHeight()) + "\n-1.0\n";
+	buffer.insert(buffer.end(), header.begin(), header.end());
+	// PFM stores rows bottom to top, same as film.
+	for (int32_t y = 0; y < image.GetHeight(); y++) {
+		for (int32_t x = 0; x < image.GetWidth(); x++) {
+			Vec3 value = image.GetValue(x, y);
+			WriteBinary(buffer, (float)value.r);
+			WriteBinary(buffer, (float)value.g);
+			WriteBinary(buffer, (float)value.b);
+		}
+	}
+	return SaveFile(filePath, buffer);
+}
+
+bool ImageWriter::WritePNG(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image) {
+	const int32_t width = image.GetWidth(), height = image.GetHeight();
+
+	std::vector<uint8_t> raw;
+	raw.reserve((size_t)(width * 3 + 1) * height);
+	for (int32_t y = height - 1; y >= 0; y--) {
+		raw.push_back(0);
+		for (int32_t x = 0; x < width; x++) {
+			Vec3 value = image.GetValue(x, y);
+			raw.push_back(LinearToSRGB8(value.r));
+			raw.push_back(LinearToSRGB8(value.g));
+			raw.push_back(LinearToSRGB8(value.b));
+		}
+	}
+
+	// Zlib stream made of stored deflate blocks, no compression library required.
+	constexpr size_t maxBlockSize = 65535;
+	std::vector<uint8_t> zlib = { 0x78, 0x01 };
+	for (size_t offset = 0; offset < raw.size() || offset == 0; offset += maxBlockSize) {
+		uint16_t blockSize = (uint16_t)std::min(maxBlockSize, raw.size() - offset);
+		zlib.push_back(offset + blockSize >= raw.size() ? 1 : 0);
+		WriteBinary(zlib, blockSize);
+		WriteBinary(zlib, (uint16_t)~blockSize);
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		if (raw.empty()) break;
+	}
+	WriteBinaryBigEndian(zlib, Adler32(raw));
+
+	std::vector<uint8_t> header;
+	WriteBinaryBigEndian(header, width);
+	WriteBinaryBigEndian(header, height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+	std::vector<uint8_t> buffer = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	WritePNGChunk(buffer, "IHDR", header);
+	WritePNGChunk(buffer, "IDAT", zlib);
+	WritePNGChunk(buffer, "IEND", {});
+	return SaveFile(filePath, buffer);
+}
+
+bool ImageWriter::WriteEXR(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image) {
+	return WriteEXR(filePath, image, {});
+}
+
+bool ImageWriter::WriteEXR(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image, std::vector<ImageChannel> layers) {
+	glm::ivec2 resolution = image.GetResolution();
+	std::vector<ImageChannel> channels = { ImageChannel("R", resolution), ImageChannel("G", resolution), ImageChannel("B", resolution) };
+	for (int32_t i = 0; i < resolution.x * resolution.y; i++) {
+		Vec3 value = image.GetValue(i);
+		channels[0].m_data[i] = (float)value.r;
+		channels[1].m_data[i] = (float)value.g;
+		channels[2].m_data[i] = (float)value.b;
+	}
+	for (ImageChannel& layer : layers) {
+		channels.push_back(std::move(layer));
+	}
+	return WriteEXR(filePath, resolution, channels);
+}
+
+bool ImageWriter::WriteEXR(const std::filesystem::path& filePath, glm::ivec2 resolution, std::vector<ImageChannel> channels) {
+	// OpenEXR requires channels to be sorted by name.
+	std::sort(channels.begin(), channels.end(), [](const ImageChannel& a, const ImageChannel& b) {
+		return a.m_name < b.m_name;
+		});
+
+	std::vector<uint8_t> buffer = { 0x76, 0x2f, 0x31, 0x01, 0x02, 0x00, 0x00, 0x00 };
+
+	std::vector<uint8_t> channelList;
+	for (const ImageChannel& channel : channels) {
+		WriteString(channelList, channel.m_name);
+		WriteBinary(channelList, (int32_t)2); // FLOAT pixel type
+		channelList.insert(channelList.end(), { 0, 0, 0, 0 }); // pLinear and reserved bytes
+		WriteBinary(channelList, (int32_t)1);
+		WriteBinary(channelList, (int32_t)1);
+	}
+	channelList.push_back(0);
+
+	auto writeAttribute = [&](const std::string& name, const std::string& type, const std::vector<uint8_t>& value) {
+		WriteString(buffer, name);
+		WriteString(buffer, type);
+		WriteBinary(buffer, (int32_t)value.size());
+		buffer.insert(buffer.end(), value.begin(), value.end());
+		};
+
+	std::vector<uint8_t> box;
+	WriteBinary(box, (int32_t)0);
+	WriteBinary(box, (int32_t)0);
+	WriteBinary(box, (int32_t)resolution.x - 1);
+	WriteBinary(box, (int32_t)resolution.y - 1);
+	std::vector<uint8_t> one, center;
+	WriteBinary(one, 1.0f);
+	WriteBinary(center, 0.0f);
+	WriteBinary(center, 0.0f);
+
+	writeAttribute("channels", "chlist", channelList);
+	writeAttribute("compression", "compression", { 0 });
+	writeAttribute("dataWindow", "box2i", box);
+	writeAttribute("displayWindow", "box2i", box);
+	writeAttribute("lineOrder", "lineOrder", { 0 });
+	writeAttribute("pixelAspectRatio", "float", one);
+	writeAttribute("screenWindowCenter", "v2f", center);
+	writeAttribute("screenWindowWidth", "float", one);
+	buffer.push_back(0);
+
+	// Uncompressed scanline file stores one line per block, preceded by the table of block offsets.
+	const int32_t lineDataSize = resolution.x * (int32_t)channels.size() * sizeof(float);
+	const uint64_t blocksStart = buffer.size() + sizeof(uint64_t) * resolution.y;
+	for (int32_t line = 0; line < resolution.y; line++) {
+		WriteBinary(buffer, blocksStart + (uint64_t)line * (2 * sizeof(int32_t) + lineDataSize));
+	}
+	for (int32_t line = 0; line < resolution.y; line++) {
+		int32_t y = resolution.y - 1 - line;
+		WriteBinary(buffer, line);
+		WriteBinary(buffer, lineDataSize);
+		for (const ImageChannel& channel : channels) {
+			const uint8_t* row = (const uint8_t*)(channel.m_data.data() + y * resolution.x);
+			buffer.insert(buffer.end(), row, row + resolution.x * sizeof(float));
+		}
+	}
+	return SaveFile(filePath, buffer);
+}
+
+bool ImageWriter::IsSupportedFormat(const std::filesystem::path& filePath) {
+	std::string extension = filePath.extension().string();
+	return extension == ".pfm" || extension == ".png" || extension == ".exr";
+}
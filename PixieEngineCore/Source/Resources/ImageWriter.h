@@ -0,0 +1,24 @@
+#pragma once
+#include "pch.h"
+#include "Buffer2D.h"
+
+// Named single channel image layer. Layers are written as "layer.R", "layer.G", ... into multi-layer files.
+struct ImageChannel {
+	std::string m_name;
+	std::vector<float> m_data;
+
+	ImageChannel(const std::string& name, glm::ivec2 resolution);
+};
+
+// CPU only image export, usable without OpenGL context. Rows are stored bottom to top as in Film.
+class ImageWriter {
+public:
+	static bool Write(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image);
+	static bool WritePFM(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image);
+	static bool WritePNG(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image);
+	static bool WriteEXR(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image);
+	// Beauty image in default RGB layer with additional layers, such as AOVs, in the same file.
+	static bool WriteEXR(const std::filesystem::path& filePath, const Buffer2D<Vec3>& image, std::vector<ImageChannel> layers);
+	static bool WriteEXR(const std::filesystem::path& filePath, glm::ivec2 resolution, std::vector<ImageChannel> channels);
+	static bool IsSupportedFormat(const std::filesystem::path& filePath);
+};
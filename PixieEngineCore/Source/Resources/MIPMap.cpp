@@ -0,0 +1,65 @@
+#include "pch.h"
+#include "MIPMap.h"
+
+std::string to_string(WrapMode mode) {
+	switch (mode) {
+	case WrapMode::Repeat: return "Repeat";
+	case WrapMode::Clamp: return "Clamp";
+	case WrapMode::Mirror: return "Mirror";
+	default: return "Undefined Wrap Mode";
+	}
+}
+
+std::string to_string(TextureFilter filter) {
+	switch (filter) {
+	case TextureFilter::Nearest: return "Nearest";
+	case TextureFilter::Bilinear: return "Bilinear";
+	case TextureFilter::Trilinear: return "Trilinear";
+	default: return "Undefined Texture Filter";
+	}
+}
+
+glm::ivec2 WrapTexel(glm::ivec2 p, glm::ivec2 resolution, WrapMode mode) {
+	for (int32_t c = 0; c < 2; c++) {
+		if (p[c] >= 0 && p[c] < resolution[c]) continue;
+		switch (mode) {
+		case WrapMode::Repeat:
+			p[c] = ((p[c] % resolution[c]) + resolution[c]) % resolution[c];
+			break;
+		case WrapMode::Mirror: {
+			int32_t period = 2 * resolution[c];
+			int32_t m = ((p[c] % period) + period) % period;
+			p[c] = m < resolution[c] ? m : period - 1 - m;
+			break;
+		}
+		default:
+			p[c] = Clamp(p[c], 0, resolution[c] - 1);
+			break;
+		}
+	}
+	return p;
+}
+
+glm::u8vec3 TexelStorage<Vec3, glm::u8vec3>::Encode(const Vec3& value) {
+	Vec3 encoded = glm::pow(glm::clamp(value, Vec3(0.0f), Vec3(1.0f)), Vec3(1.0f / 2.2f)) * (Float)255 + (Float)0.5;
+	return glm::u8vec3(encoded);
+}
+
+Vec3 TexelStorage<Vec3, glm::u8vec3>::Decode(const glm::u8vec3& texel) {
+	static const std::array<Float, 256> table = []() {
+		std::array<Float, 256> values;
+		for (int32_t i = 0; i < 256; i++) {
+			values[i] = std::pow((Float)i / 255, (Float)2.2);
+		}
+		return values;
+	}();
+	return Vec3(table[texel.x], table[texel.y], table[texel.z]);
+}
+
+glm::u16vec3 TexelStorage<Vec3, glm::u16vec3>::Encode(const Vec3& value) {
+	return glm::u16vec3(glm::packHalf1x16((float)value.x), glm::packHalf1x16((float)value.y), glm::packHalf1x16((float)value.z));
+}
+
+Vec3 TexelStorage<Vec3, glm::u16vec3>::Decode(const glm::u16vec3& texel) {
+	return Vec3(glm::unpackHalf1x16(texel.x), glm::unpackHalf1x16(texel.y), glm::unpackHalf1x16(texel.z));
+}
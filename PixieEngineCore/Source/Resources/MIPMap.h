@@ -0,0 +1,292 @@
+#pragma once
+#include "pch.h"
+#include "Buffer2D.h"
+#include <glm/gtc/packing.hpp>
+
+enum class WrapMode : int32_t {
+	Repeat = 0,
+	Clamp,
+	Mirror,
+	COUNT
+};
+
+std::string to_string(WrapMode mode);
+
+enum class TextureFilter : int32_t {
+	Nearest = 0,
+	Bilinear,
+	Trilinear,
+	COUNT
+};
+
+std::string to_string(TextureFilter filter);
+
+glm::ivec2 WrapTexel(glm::ivec2 p, glm::ivec2 resolution, WrapMode mode);
+
+// Conversion between filtered value type and storage type of texels, identity unless specialized.
+template<typename T, typename S>
+struct TexelStorage {
+	static S Encode(const T& value) { return value; }
+	static T Decode(const S& texel) { return texel; }
+};
+
+// 8 bit sRGB encoded color, decoded with gamma 2.2 same as stb_image does for floating point loads.
+template<>
+struct TexelStorage<Vec3, glm::u8vec3> {
+	static glm::u8vec3 Encode(const Vec3& value);
+	static Vec3 Decode(const glm::u8vec3& texel);
+};
+
+// Linear color in half precision floats.
+template<>
+struct TexelStorage<Vec3, glm::u16vec3> {
+	static glm::u16vec3 Encode(const Vec3& value);
+	static Vec3 Decode(const glm::u16vec3& texel);
+};
+
+// 2D array stored in square blocks of 2^LogBlockSize texels. Texels close in both directions share cache lines,
+// which keeps bilinear and trilinear lookups local on large textures.
+template<typename T, int32_t LogBlockSize = 2>
+class BlockedArray {
+public:
+	BlockedArray(glm::ivec2 resolution, const T* data = nullptr);
+
+	glm::ivec2 GetResolution() const;
+	size_t GetSizeInBytes() const;
+	T& operator()(int32_t x, int32_t y);
+	const T& operator()(int32_t x, int32_t y) const;
+
+protected:
+	static constexpr int32_t c_blockSize = 1 << LogBlockSize;
+
+	glm::ivec2 m_resolution;
+	int32_t m_blocksCountX;
+	std::vector<T> m_data;
+
+	size_t GetIndex(int32_t x, int32_t y) const;
+};
+
+template<typename T, int32_t LogBlockSize>
+inline BlockedArray<T, LogBlockSize>::BlockedArray(glm::ivec2 resolution, const T* data) :
+	m_resolution(resolution), m_blocksCountX((resolution.x + c_blockSize - 1) >> LogBlockSize) {
+	int32_t blocksCountY = (resolution.y + c_blockSize - 1) >> LogBlockSize;
+	m_data.resize((size_t)m_blocksCountX * blocksCountY * c_blockSize * c_blockSize, T(0));
+	if (data) {
+		for (int32_t y = 0; y < resolution.y; y++) {
+			for (int32_t x = 0; x < resolution.x; x++) {
+				(*this)(x, y) = data[y * resolution.x + x];
+			}
+		}
+	}
+}
+
+template<typename T, int32_t LogBlockSize>
+inline glm::ivec2 BlockedArray<T, LogBlockSize>::GetResolution() const {
+	return m_resolution;
+}
+
+template<typename T, int32_t LogBlockSize>
+inline size_t BlockedArray<T, LogBlockSize>::GetSizeInBytes() const {
+	return m_data.size() * sizeof(T);
+}
+
+template<typename T, int32_t LogBlockSize>
+inline T& BlockedArray<T, LogBlockSize>::operator()(int32_t x, int32_t y) {
+	return m_data[GetIndex(x, y)];
+}
+
+template<typename T, int32_t LogBlockSize>
+inline const T& BlockedArray<T, LogBlockSize>::operator()(int32_t x, int32_t y) const {
+	return m_data[GetIndex(x, y)];
+}
+
+template<typename T, int32_t LogBlockSize>
+inline size_t BlockedArray<T, LogBlockSize>::GetIndex(int32_t x, int32_t y) const {
+	size_t block = (size_t)(y >> LogBlockSize) * m_blocksCountX + (x >> LogBlockSize);
+	size_t offset = ((y & (c_blockSize - 1)) << LogBlockSize) + (x & (c_blockSize - 1));
+	return (block << (2 * LogBlockSize)) + offset;
+}
+
+// Image pyramid for filtered texture lookups. Every level halves resolution of the previous one with a box filter
+// down to a single texel, odd sizes are rounded down and filtered with 3 taps. Lookup coordinates are in [0, 1] texture space, outside values are handled by wrap mode.
+// Texels are kept in storage type S and converted to T on lookup.
+template<typename T, typename S = T>
+class MIPMap {
+public:
+	MIPMap(const Buffer2D<T>& image, WrapMode wrapMode = WrapMode::Repeat);
+	// Level 0 texels already in storage format, row by row.
+	MIPMap(glm::ivec2 resolution, const S* texels, WrapMode wrapMode = WrapMode::Repeat);
+
+	int32_t GetLevelsCount() const;
+	glm::ivec2 GetLevelResolution(int32_t level) const;
+	size_t GetSizeInBytes() const;
+	// Stored texels of a level, row by row, for upload to GPU.
+	std::vector<S> GetLevelTexels(int32_t level) const;
+	T Texel(int32_t level, glm::ivec2 p) const;
+	T Nearest(int32_t level, Vec2 st) const;
+	T Bilerp(int32_t level, Vec2 st) const;
+	// Width is filter footprint in texture space, for example ray cone width divided by texture extent.
+	T Filter(Vec2 st, Float width, TextureFilter filter) const;
+
+protected:
+	WrapMode m_wrapMode;
+	std::vector<BlockedArray<S>> m_pyramid;
+
+	void GenerateLevels();
+};
+
+template<typename T, typename S>
+inline MIPMap<T, S>::MIPMap(const Buffer2D<T>& image, WrapMode wrapMode) :
+	m_wrapMode(wrapMode) {
+	glm::ivec2 resolution = image.m_resolution;
+	if (resolution.x <= 0 || resolution.y <= 0 || image.m_data.empty()) {
+		m_pyramid.emplace_back(glm::ivec2(1));
+	}
+	else if constexpr (std::is_same_v<T, S>) {
+		m_pyramid.emplace_back(resolution, image.m_data.data());
+	}
+	else {
+		std::vector<S> texels(image.m_data.size());
+		for (size_t i = 0; i < texels.size(); i++) {
+			texels[i] = TexelStorage<T, S>::Encode(image.m_data[i]);
+		}
+		m_pyramid.emplace_back(resolution, texels.data());
+	}
+	GenerateLevels();
+}
+
+template<typename T, typename S>
+inline MIPMap<T, S>::MIPMap(glm::ivec2 resolution, const S* texels, WrapMode wrapMode) :
+	m_wrapMode(wrapMode) {
+	if (resolution.x <= 0 || resolution.y <= 0 || !texels) {
+		m_pyramid.emplace_back(glm::ivec2(1));
+	}
+	else {
+		m_pyramid.emplace_back(resolution, texels);
+	}
+	GenerateLevels();
+}
+
+// Box filter taps of texel i of the next level along an axis of n texels, returns taps count. Odd sizes spread every
+// texel over n / (n / 2) texels with 3 taps, so the last row or column contributes instead of being dropped.
+inline int32_t GetDownsampleTaps(int32_t i, int32_t n, std::array<int32_t, 3>& taps, std::array<Float, 3>& weights) {
+	if (n == 1) {
+		taps[0] = 0;
+		weights[0] = 1.0f;
+		return 1;
+	}
+	if (n % 2 == 0) {
+		taps = { 2 * i, 2 * i + 1, 0 };
+		weights = { 0.5f, 0.5f, 0.0f };
+		return 2;
+	}
+	Float m = (Float)(n / 2);
+	taps = { 2 * i, 2 * i + 1, 2 * i + 2 };
+	weights = { (m - i) / n, m / n, (i + 1) / (Float)n };
+	return 3;
+}
+
+template<typename T, typename S>
+inline void MIPMap<T, S>::GenerateLevels() {
+	glm::ivec2 resolution = m_pyramid.back().GetResolution();
+	while (resolution.x > 1 || resolution.y > 1) {
+		glm::ivec2 nextResolution = glm::max(resolution / 2, glm::ivec2(1));
+		BlockedArray<S> next(nextResolution);
+		int32_t level = (int32_t)m_pyramid.size() - 1;
+		for (int32_t y = 0; y < nextResolution.y; y++) {
+			std::array<int32_t, 3> tapsY;
+			std::array<Float, 3> weightsY;
+			int32_t tapsCountY = GetDownsampleTaps(y, resolution.y, tapsY, weightsY);
+			for (int32_t x = 0; x < nextResolution.x; x++) {
+				std::array<int32_t, 3> tapsX;
+				std::array<Float, 3> weightsX;
+				int32_t tapsCountX = GetDownsampleTaps(x, resolution.x, tapsX, weightsX);
+				T value = T(0);
+				for (int32_t j = 0; j < tapsCountY; j++) {
+					for (int32_t i = 0; i < tapsCountX; i++) {
+						value += Texel(level, glm::ivec2(tapsX[i], tapsY[j])) * (weightsX[i] * weightsY[j]);
+					}
+				}
+				next(x, y) = TexelStorage<T, S>::Encode(value);
+			}
+		}
+		m_pyramid.push_back(std::move(next));
+		resolution = nextResolution;
+	}
+}
+
+template<typename T, typename S>
+inline int32_t MIPMap<T, S>::GetLevelsCount() const {
+	return (int32_t)m_pyramid.size();
+}
+
+template<typename T, typename S>
+inline glm::ivec2 MIPMap<T, S>::GetLevelResolution(int32_t level) const {
+	return m_pyramid[level].GetResolution();
+}
+
+template<typename T, typename S>
+inline size_t MIPMap<T, S>::GetSizeInBytes() const {
+	size_t size = 0;
+	for (const BlockedArray<S>& level : m_pyramid) {
+		size += level.GetSizeInBytes();
+	}
+	return size;
+}
+
+template<typename T, typename S>
+inline std::vector<S> MIPMap<T, S>::GetLevelTexels(int32_t level) const {
+	const BlockedArray<S>& image = m_pyramid[level];
+	glm::ivec2 resolution = image.GetResolution();
+	std::vector<S> texels((size_t)resolution.x * resolution.y);
+	for (int32_t y = 0; y < resolution.y; y++) {
+		for (int32_t x = 0; x < resolution.x; x++) {
+			texels[(size_t)y * resolution.x + x] = image(x, y);
+		}
+	}
+	return texels;
+}
+
+template<typename T, typename S>
+inline T MIPMap<T, S>::Texel(int32_t level, glm::ivec2 p) const {
+	const BlockedArray<S>& image = m_pyramid[level];
+	p = WrapTexel(p, image.GetResolution(), m_wrapMode);
+	return TexelStorage<T, S>::Decode(image(p.x, p.y));
+}
+
+template<typename T, typename S>
+inline T MIPMap<T, S>::Nearest(int32_t level, Vec2 st) const {
+	glm::ivec2 resolution = GetLevelResolution(level);
+	return Texel(level, glm::ivec2(glm::floor(st * Vec2(resolution))));
+}
+
+template<typename T, typename S>
+inline T MIPMap<T, S>::Bilerp(int32_t level, Vec2 st) const {
+	Vec2 p = st * Vec2(GetLevelResolution(level)) - Vec2(0.5f);
+	Vec2 p0 = glm::floor(p);
+	Vec2 d = p - p0;
+	glm::ivec2 i0 = glm::ivec2(p0);
+	return (Texel(level, i0) * (1 - d.x) + Texel(level, i0 + glm::ivec2(1, 0)) * d.x) * (1 - d.y) +
+		(Texel(level, i0 + glm::ivec2(0, 1)) * (1 - d.x) + Texel(level, i0 + glm::ivec2(1, 1)) * d.x) * d.y;
+}
+
+template<typename T, typename S>
+inline T MIPMap<T, S>::Filter(Vec2 st, Float width, TextureFilter filter) const {
+	if (filter == TextureFilter::Nearest) {
+		return Nearest(0, st);
+	}
+	if (filter == TextureFilter::Bilinear) {
+		return Bilerp(0, st);
+	}
+	// Level where footprint covers about one texel, finest level has index 0.
+	Float level = GetLevelsCount() - 1 + std::log2(std::max<Float>(width, 1e-8f));
+	if (level <= 0) {
+		return Bilerp(0, st);
+	}
+	if (level >= GetLevelsCount() - 1) {
+		return Texel(GetLevelsCount() - 1, glm::ivec2(0));
+	}
+	int32_t levelIndex = (int32_t)level;
+	Float delta = level - levelIndex;
+	return Bilerp(levelIndex, st) * (1 - delta) + Bilerp(levelIndex + 1, st) * delta;
+}
@@ -15,21 +15,45 @@ Float Reflectance(Float cosine, Float ref_idx) {
 	return r0 + (1.0f - r0) * pow((1.0f - cosine), 5.0f);
 }
 
+// Constant textures are created once and shared by all materials.
+struct DefaultMaterialTextures {
+	Buffer2DTexture<Vec3> albedo;
+	Buffer2DTexture<Vec3> emission;
+	Buffer2DTexture<Float> metallic;
+	Buffer2DTexture<Float> roughness;
+	Buffer2DTexture<Vec3> normal;
+
+	DefaultMaterialTextures() {
+		albedo.SetPixel({ 0, 0 }, Vec3(1.0f));
+		emission.SetPixel({ 0, 0 }, Vec3(0.0f));
+		metallic.SetPixel({ 0, 0 }, 1.0f);
+		roughness.SetPixel({ 0, 0 }, 1.0f);
+		normal.SetPixel({ 0, 0 }, Vec3(0.0f, 0.0f, 1.0f));
+		albedo.Upload();
+		emission.Upload();
+		metallic.Upload();
+		roughness.Upload();
+		normal.Upload();
+		albedo.GenerateMIPMap();
+		emission.GenerateMIPMap();
+		metallic.GenerateMIPMap();
+		roughness.GenerateMIPMap();
+		normal.GenerateMIPMap();
+	}
+};
+
+static const DefaultMaterialTextures& GetDefaultMaterialTextures() {
+	static const DefaultMaterialTextures textures;
+	return textures;
+}
+
 Material::Material(const std::string& name, Spectrum albedo, Spectrum emissionColor, float emissionStrength, float roughness, float metallic, float transparency, float refraction) :
-	m_name(name), m_emissionColor(emissionColor), m_emissionStrength(emissionStrength), m_albedo(albedo), m_roughness(roughness), m_metallic(metallic), m_transparency(transparency), m_refraction(refraction) {
+	m_name(name), m_emissionColor(emissionColor), m_emissionStrength(emissionStrength), m_albedo(albedo), m_roughness(roughness), m_metallic(metallic), m_transparency(transparency), m_refraction(refraction),
+	m_albedoTexture(GetDefaultMaterialTextures().albedo), m_emissionTexture(GetDefaultMaterialTextures().emission), m_metallicTexture(GetDefaultMaterialTextures().metallic),
+	m_roughnessTexture(GetDefaultMaterialTextures().roughness), m_normalTexture(GetDefaultMaterialTextures().normal) {
 	assert(!isnan(m_emissionColor.GetRGB().x) && !isnan(m_emissionColor.GetRGB().y) && !isnan(m_emissionColor.GetRGB().z));
 	assert(!isnan(m_emissionStrength) && !isnan(m_albedo.GetRGB().x) && !isnan(m_albedo.GetRGB().y) && !isnan(m_albedo.GetRGB().z));
 	assert(!isnan(m_roughness) && !isnan(m_metallic) && !isnan(m_transparency) && !isnan(m_refraction));
-	m_albedoTexture.SetPixel({ 0, 0 }, Vec3(1.0f));
-	m_albedoTexture.Upload();
-	m_emissionTexture.SetPixel({ 0, 0 }, Vec3(0.0f));
-	m_emissionTexture.Upload();
-	m_metallicTexture.SetPixel({ 0, 0 }, 1.0f);
-	m_metallicTexture.Upload();
-	m_roughnessTexture.SetPixel({ 0, 0 }, 1.0f);
-	m_roughnessTexture.Upload();
-	m_normalTexture.SetPixel({ 0, 0 }, Vec3(0.0f, 0.0f, 1.0f));
-	m_normalTexture.Upload();
 }
 
 bool Material::IsEmissive() {
@@ -44,10 +68,22 @@ Spectrum Material::GetEmission() {
 	return m_emissionColor * m_emissionStrength;
 }
 
+Spectrum Material::GetAlbedo(const RayInteraction& intr) const {
+	if (m_pinnedAlbedoMap) {
+		return m_albedo * Spectrum(m_pinnedAlbedoMap.Sample(intr.uv, intr.uvFootprint));
+	}
+	if (m_albedoMap) {
+		return m_albedo * Spectrum(m_albedoMap->Sample(intr.uv, intr.uvFootprint));
+	}
+	return m_albedo * Spectrum(m_albedoTexture.Sample(intr.uv, intr.uvFootprint));
+}
+
+GLuint Material::GetAlbedoTextureID() const {
+	return m_albedoMap ? m_albedoMap->GetTextureID() : m_albedoTexture.GetID();
+}
+
 Spectrum Material::Evaluate(const RayInteraction& intr) {
-	Vec3 color = m_albedo.GetRGB();
-	color *= m_albedoTexture.Sample(intr.uv);
-	return color / Pi;
+	return GetAlbedo(intr) * InvPi;
 }
 
 Float Material::Pdf() {
@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include "Buffer2DTexture.h"
+#include "TextureCache.h"
 #include "Math/Random.h"
 #include "RayTracing/BSDF.h"
 #include "RayTracing/Ray.h"
@@ -13,6 +14,10 @@ struct Material {
 	std::string m_name;
 	Spectrum m_albedo = Spectrum(0.8f);
 	Buffer2DTexture<Vec3> m_albedoTexture;
+	// Image texture shared through TextureCache, replaces m_albedoTexture when set.
+	std::shared_ptr<CachedTexture> m_albedoMap;
+	// Pixels of m_albedoMap resolved by the scene snapshot owning this copy, sampled instead of going through cache.
+	PinnedTexture m_pinnedAlbedoMap;
 	Spectrum m_emissionColor = Spectrum(1.0f);
 	Float m_emissionStrength = 0.0f;
 	Buffer2DTexture<Vec3> m_emissionTexture;
@@ -29,6 +34,9 @@ struct Material {
 	bool IsEmissive();
 	bool IsTranslucent();
 	Spectrum GetEmission();
+	// Albedo color modulated by filtered albedo texture, using uv footprint of the interaction.
+	Spectrum GetAlbedo(const RayInteraction& intr) const;
+	GLuint GetAlbedoTextureID() const;
 	Spectrum Evaluate(const RayInteraction& intr);
 	BSDF GetBSDF(const RayInteraction& intr);
 	BxDFFlags Flags();
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "Mesh.h"
 
+static std::atomic<uint64_t> meshVersionCounter = 0;
+
 Vertex::Vertex(const Vec3& p, const Vec3& n, const Vec2& uv) :
 	position(p), normal(n), uv(uv) {
 	for (int32_t i = 0; i < MaxBonesPerVertex; i++) {
@@ -45,6 +47,11 @@ Mesh::Mesh(const std::vector<Vertex>& _vertices, const std::vector<int32_t>& _in
 	Upload();
 }
 
+Mesh::Mesh(std::vector<Vertex>&& _vertices, std::vector<int32_t>&& _indices) :
+	m_vertices(std::move(_vertices)), m_indices(std::move(_indices)) {
+	Upload();
+}
+
 Mesh::~Mesh() {
 	if(m_vao) glDeleteVertexArrays(1, &m_vao);
 	if(m_vbo) glDeleteBuffers(1, &m_vbo);
@@ -62,7 +69,8 @@ Vec3 Mesh::GetCenter() const {
 }
 
 void Mesh::Upload() {
-	if (m_vertices.size() == 0 || m_indices.size() == 0) {
+	m_version = ++meshVersionCounter;
+	if (m_vertices.size() == 0 || m_indices.size() == 0 || !IsOpenGLContextLoaded()) {
 		return;
 	}
 	if (!m_vao) {
@@ -1,6 +1,8 @@
 #pragma once
 #include "pch.h"
 
+class MeshBVH;
+
 static const uint32_t MaxBonesPerVertex = 4;
 
 struct Vertex {
@@ -22,8 +24,11 @@ struct Mesh {
 	GLuint m_vbo = 0;
 	GLuint m_ibo = 0;
 	int32_t m_indicesCount = 0;
+	uint64_t m_version = 0; // unique among all meshes, changes on every Upload of modified data
+	std::shared_ptr<MeshBVH> m_cachedBVH; // prebuilt BVH loaded from scene cache, ignored once mesh version changes
 
 	Mesh(const std::vector<Vertex>& vertices, const std::vector<int32_t>& indices);
+	Mesh(std::vector<Vertex>&& vertices, std::vector<int32_t>&& indices);
 	~Mesh();
 
 	Vec3 GetCenter() const;
@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "ModelImport.h"
+#include <assimp/ProgressHandler.hpp>
+
+std::string to_string(ModelImportStage stage) {
+	switch (stage) {
+	case ModelImportStage::Reading: return "Reading";
+	case ModelImportStage::Converting: return "Converting Meshes";
+	case ModelImportStage::LoadingTextures: return "Loading Textures";
+	case ModelImportStage::Uploading: return "Uploading";
+	case ModelImportStage::Finished: return "Finished";
+	case ModelImportStage::Failed: return "Failed";
+	case ModelImportStage::Cancelled: return "Cancelled";
+	default: return "Undefined Model Import Stage";
+	}
+}
+
+ModelImport::ModelImport(const std::filesystem::path& path) :
+	m_path(path) {}
+
+ModelImport::~ModelImport() {
+	Cancel();
+	if (m_task.valid()) {
+		m_task.wait();
+	}
+}
+
+const std::filesystem::path& ModelImport::GetPath() const {
+	return m_path;
+}
+
+ModelImportStage ModelImport::GetStage() const {
+	return m_stage;
+}
+
+Float ModelImport::GetStageProgress() const {
+	return m_stageProgress;
+}
+
+Float ModelImport::GetProgress() const {
+	int32_t stage = (int32_t)GetStage();
+	if (stage >= (int32_t)c_stageWeights.size()) {
+		return 1.0f;
+	}
+	Float progress = 0.0f;
+	for (int32_t i = 0; i < stage; i++) {
+		progress += c_stageWeights[i];
+	}
+	return progress + c_stageWeights[stage] * GetStageProgress();
+}
+
+bool ModelImport::IsDone() const {
+	ModelImportStage stage = GetStage();
+	return stage == ModelImportStage::Finished || stage == ModelImportStage::Failed || stage == ModelImportStage::Cancelled;
+}
+
+void ModelImport::Cancel() {
+	m_isCancelled = true;
+}
+
+bool ModelImport::IsCancelled() const {
+	return m_isCancelled;
+}
+
+SceneObject* ModelImport::GetResult() const {
+	return GetStage() == ModelImportStage::Finished ? m_result : nullptr;
+}
+
+void ModelImport::SetStage(ModelImportStage stage) {
+	m_stageProgress = 0.0f;
+	m_stage = stage;
+}
+
+Assimp::ProgressHandler* ModelImport::CreateReadProgressHandler() {
+	class ReadProgressHandler : public Assimp::ProgressHandler {
+	public:
+		ReadProgressHandler(ModelImport& import) :
+			m_import(import) {}
+
+		bool Update(float percentage) override {
+			// Negative percentage means progress is unknown.
+			if (percentage >= 0.0f) {
+				m_import.m_stageProgress = Clamp((Float)percentage, 0.0f, 1.0f);
+			}
+			return !m_import.IsCancelled();
+		}
+
+	protected:
+		ModelImport& m_import;
+	};
+	return new ReadProgressHandler(*this);
+}
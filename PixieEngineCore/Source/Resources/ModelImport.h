@@ -0,0 +1,74 @@
+#pragma once
+#include "pch.h"
+#include "Mesh.h"
+#include "TextureCache.h"
+#include "Animation/MeshAnimator.h"
+
+class SceneObject;
+
+enum class ModelImportStage : int32_t {
+	Reading = 0,
+	Converting,
+	LoadingTextures,
+	Uploading,
+	Finished,
+	Failed,
+	Cancelled,
+	COUNT
+};
+
+std::string to_string(ModelImportStage stage);
+
+// State of one model file import. Reading the file, converting meshes and decoding textures run on a background
+// thread, meshes and textures are uploaded and objects are created on main thread by
+// ResourceManager::UpdateModelImports. Progress and stage can be read from any thread.
+class ModelImport {
+public:
+	ModelImport(const std::filesystem::path& path);
+	// Cancels the import and waits for its background task, which writes to members of this object.
+	~ModelImport();
+
+	const std::filesystem::path& GetPath() const;
+	ModelImportStage GetStage() const;
+	// Progress of the current stage in [0, 1].
+	Float GetStageProgress() const;
+	// Progress of the whole import in [0, 1], stages are weighted by their usual share of import time.
+	Float GetProgress() const;
+	// Import finished, failed or was cancelled.
+	bool IsDone() const;
+	// Stops import at the next checkpoint, objects are not added to the scene.
+	void Cancel();
+	bool IsCancelled() const;
+	// Root object of the model, null until import is finished.
+	SceneObject* GetResult() const;
+
+protected:
+	struct MeshData {
+		bool isUsed = false; // referenced by a node
+		std::vector<Vertex> vertices;
+		std::vector<int32_t> indices;
+	};
+
+	static constexpr std::array<Float, 4> c_stageWeights = { 0.4f, 0.3f, 0.2f, 0.1f };
+
+	std::filesystem::path m_path;
+	std::atomic<ModelImportStage> m_stage = ModelImportStage::Reading;
+	std::atomic<Float> m_stageProgress = 0.0f;
+	std::atomic<bool> m_isCancelled = false;
+	std::future<void> m_task;
+	Assimp::Importer m_importer;
+	const aiScene* m_scene = nullptr;
+	std::map<std::string, BoneInfo> m_boneInfoMap;
+	std::vector<MeshData> m_meshData;
+	std::vector<std::shared_ptr<CachedTexture>> m_textures;
+	// Filled on main thread during upload, meshes are created in order of scene meshes.
+	std::vector<Mesh*> m_meshes;
+	size_t m_uploadedTextures = 0;
+	SceneObject* m_result = nullptr;
+
+	void SetStage(ModelImportStage stage);
+	// Reports progress of reading the file and aborts reading once import is cancelled. Importer takes ownership.
+	Assimp::ProgressHandler* CreateReadProgressHandler();
+
+	friend class ResourceManager;
+};
@@ -4,6 +4,8 @@
 #include "GlobalRenderer.h"
 #include "TextureGenerator.h"
 #include "MeshGenerator.h"
+#include "SceneCache.h"
+#include "Parallel.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -18,9 +20,12 @@ std::vector<Mesh*> ResourceManager::m_meshes = {};
 std::map<char, FontCharacter> ResourceManager::m_characters = {};
 uint32_t ResourceManager::m_defaultFontSize = 64;
 Texture ResourceManager::m_brdfLUT;
+std::vector<std::shared_ptr<ModelImport>> ResourceManager::m_modelImports = {};
 
 static const std::string c_deafultMaterial = "Default Material";
 static const int32_t c_maxMaterials = 512;
+// Bytes of mesh and texture data uploaded per frame by background model imports.
+static const size_t c_importUploadBytesPerFrame = 64 * 1024 * 1024;
 
 inline void ltrim(std::string& s) {
 	s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
@@ -72,6 +77,10 @@ std::filesystem::path ResourceManager::GetApplicationDirectory() {
 	return m_applicationPath.parent_path();
 }
 
+std::filesystem::path ResourceManager::GetCacheDirectory() {
+	return GetApplicationDirectory() / "Cache";
+}
+
 std::filesystem::path ResourceManager::GetAssetsPath() {
 	return m_assetsPath;
 }
@@ -88,6 +97,10 @@ void ResourceManager::Initialize() {
 	m_materials.reserve(c_maxMaterials);
 	AddMaterial(Material(c_deafultMaterial));
 
+	if (!IsOpenGLContextLoaded()) {
+		return;
+	}
+
 	LoadDefaultFont();
 
 	m_brdfLUT = Texture({ 512, 512 }, GL_RG16F, GL_RG, GL_FLOAT, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR);
@@ -105,7 +118,14 @@ std::shared_ptr<Scene> ResourceManager::LoadScene(const std::filesystem::path& f
 		scene = LoadPixieEngineScene(filePath);
 	} 
 	else if (filePath.extension() == ".pbrt") {
-		scene = LoadPBRTScene(filePath);
+		scene = SceneCache::Load(filePath);
+		if (!scene) {
+			std::vector<std::filesystem::path> sources;
+			scene = LoadPBRTScene(filePath, sources);
+			if (scene) {
+				SceneCache::Write(filePath, scene.get(), sources, SceneManager::GetBVHBuildMethod());
+			}
+		}
 	}
 
 	return scene;
@@ -118,25 +138,179 @@ bool ResourceManager::SaveScene(const std::filesystem::path& filePath, Scene* sc
 }
 
 SceneObject* ResourceManager::LoadModel(const std::filesystem::path& filePath) {
-	m_currentFilePath = filePath;
-	std::cout << "Loading model from file: " << filePath << "\n";
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(filePath.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
+	ModelImport import(filePath);
+	ImportModel(import);
+	size_t uploadBudget = std::numeric_limits<size_t>::max();
+	FinishModelImport(import, uploadBudget);
+	return import.GetResult();
+}
+
+std::shared_ptr<ModelImport> ResourceManager::LoadModelAsync(const std::filesystem::path& filePath) {
+	std::shared_ptr<ModelImport> import = std::make_shared<ModelImport>(filePath);
+	// Registry keeps the import alive until its task is finished.
+	import->m_task = std::async(std::launch::async, [import = import.get()]() {
+		ImportModel(*import);
+	});
+	m_modelImports.push_back(import);
+	return import;
+}
+
+bool ResourceManager::UpdateModelImports() {
+	bool isModelAdded = false;
+	size_t uploadBudget = c_importUploadBytesPerFrame;
+	for (std::shared_ptr<ModelImport>& import : m_modelImports) {
+		if (import->m_task.valid()) {
+			if (import->m_task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				continue;
+			}
+			import->m_task.get();
+		}
+		if (!import->IsDone() && FinishModelImport(*import, uploadBudget)) {
+			isModelAdded |= import->GetResult() != nullptr;
+		}
+	}
+	std::erase_if(m_modelImports, [](const std::shared_ptr<ModelImport>& import) {
+		return !import->m_task.valid() && import->IsDone();
+	});
+	return isModelAdded;
+}
+
+const std::vector<std::shared_ptr<ModelImport>>& ResourceManager::GetModelImports() {
+	return m_modelImports;
+}
+
+void ResourceManager::ImportModel(ModelImport& import) {
+	std::cout << "Loading model from file: " << import.m_path << "\n";
+	import.m_importer.SetProgressHandler(import.CreateReadProgressHandler());
+	const aiScene* scene = import.m_importer.ReadFile(import.m_path.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
+	if (import.IsCancelled()) {
+		return;
+	}
 	if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
-		std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << "\n";
-		return nullptr;
+		std::cout << "ERROR::ASSIMP::" << import.m_importer.GetErrorString() << "\n";
+		import.SetStage(ModelImportStage::Failed);
+		return;
+	}
+	import.m_scene = scene;
+
+	// Bones are registered in order of node traversal, so their IDs don't depend on which thread converts which mesh.
+	import.SetStage(ModelImportStage::Converting);
+	std::vector<uint32_t> nodeMeshes;
+	CollectAssimpNodeMeshes(scene->mRootNode, nodeMeshes);
+	import.m_meshData.resize(scene->mNumMeshes);
+	std::vector<int32_t> meshes;
+	std::set<uint32_t> materials;
+	for (uint32_t meshIndex : nodeMeshes) {
+		RegisterAssimpBones(scene->mMeshes[meshIndex], import.m_boneInfoMap);
+		if (!import.m_meshData[meshIndex].isUsed) {
+			import.m_meshData[meshIndex].isUsed = true;
+			meshes.push_back((int32_t)meshIndex);
+			materials.insert(scene->mMeshes[meshIndex]->mMaterialIndex);
+		}
+	}
+
+	// Meshes and textures differ a lot in size, so threads take them one at a time instead of fixed ranges.
+	std::atomic<int32_t> nextMesh = 0;
+	std::atomic<int32_t> convertedMeshes = 0;
+	ParallelFor((int32_t)meshes.size(), [&](int32_t start, int32_t end) {
+		for (int32_t i = nextMesh++; i < (int32_t)meshes.size() && !import.IsCancelled(); i = nextMesh++) {
+			ProcessAssimpMesh(scene->mMeshes[meshes[i]], import.m_boneInfoMap, import.m_meshData[meshes[i]]);
+			import.m_stageProgress = (Float)++convertedMeshes / meshes.size();
+		}
+	}, 1);
+	if (import.IsCancelled()) {
+		return;
+	}
+
+	import.SetStage(ModelImportStage::LoadingTextures);
+	std::set<std::filesystem::path> texturePathsSet;
+	for (uint32_t materialIndex : materials) {
+		const aiMaterial* material = scene->mMaterials[materialIndex];
+		for (aiTextureType type : { aiTextureType_DIFFUSE, aiTextureType_SPECULAR }) {
+			for (uint32_t i = 0; i < material->GetTextureCount(type); i++) {
+				aiString str;
+				material->GetTexture(type, i, &str);
+				texturePathsSet.insert(import.m_path.parent_path().string() + "/" + str.C_Str());
+			}
+		}
+	}
+	std::vector<std::filesystem::path> texturePaths(texturePathsSet.begin(), texturePathsSet.end());
+	std::vector<std::shared_ptr<CachedTexture>> textures(texturePaths.size());
+	std::atomic<int32_t> nextTexture = 0;
+	std::atomic<int32_t> loadedTextures = 0;
+	ParallelFor((int32_t)texturePaths.size(), [&](int32_t start, int32_t end) {
+		for (int32_t i = nextTexture++; i < (int32_t)texturePaths.size() && !import.IsCancelled(); i = nextTexture++) {
+			textures[i] = TextureCache::Load(texturePaths[i]);
+			if (textures[i]) {
+				textures[i]->Preload();
+			}
+			import.m_stageProgress = (Float)++loadedTextures / texturePaths.size();
+		}
+	}, 1);
+	for (std::shared_ptr<CachedTexture>& texture : textures) {
+		if (texture) {
+			import.m_textures.push_back(texture);
+		}
+	}
+	if (import.IsCancelled()) {
+		return;
+	}
+
+	import.SetStage(ModelImportStage::Uploading);
+}
+
+bool ResourceManager::FinishModelImport(ModelImport& import, size_t& uploadBudget) {
+	if (import.IsCancelled()) {
+		for (Mesh* mesh : import.m_meshes) {
+			delete mesh;
+		}
+		import.m_meshes.clear();
+		import.m_importer.FreeScene();
+		import.SetStage(ModelImportStage::Cancelled);
+		return true;
+	}
+	if (import.GetStage() != ModelImportStage::Uploading) {
+		return import.IsDone();
+	}
+
+	size_t uploadsCount = import.m_meshData.size() + import.m_textures.size();
+	while (import.m_meshes.size() < import.m_meshData.size()) {
+		if (uploadBudget == 0) {
+			return false;
+		}
+		ModelImport::MeshData& data = import.m_meshData[import.m_meshes.size()];
+		// Meshes not referenced by any node are not converted.
+		if (!data.isUsed) {
+			import.m_meshes.push_back(nullptr);
+			continue;
+		}
+		size_t bytes = data.vertices.size() * sizeof(Vertex) + data.indices.size() * sizeof(int32_t);
+		import.m_meshes.push_back(new Mesh(std::move(data.vertices), std::move(data.indices)));
+		uploadBudget -= std::min(bytes, uploadBudget);
+		import.m_stageProgress = (Float)import.m_meshes.size() / uploadsCount;
+	}
+	while (import.m_uploadedTextures < import.m_textures.size()) {
+		if (uploadBudget == 0) {
+			return false;
+		}
+		const CachedTexture& texture = *import.m_textures[import.m_uploadedTextures++];
+		texture.GetTextureID();
+		size_t bytes = (size_t)texture.GetResolution().x * texture.GetResolution().y * (texture.GetFormat() == TexelFormat::RGB16F ? 6 : 3);
+		uploadBudget -= std::min(bytes, uploadBudget);
+		import.m_stageProgress = (Float)(import.m_meshes.size() + import.m_uploadedTextures) / uploadsCount;
 	}
 
-	std::map<std::string, BoneInfo> boneInfoMap;
-	SceneObject* rootObject = ProcessAssimpNode(scene, scene->mRootNode, boneInfoMap);
+	m_currentFilePath = import.m_path;
+	const aiScene* scene = import.m_scene;
+	SceneObject* rootObject = ProcessAssimpNode(scene->mRootNode, import);
 
 	std::vector<Animation*> animations;
 	for (uint32_t i = 0; i < scene->mNumAnimations; i++) {
-		std::vector<Bone> bones = ProcessAssimpAnimation(scene->mAnimations[i], boneInfoMap);
+		std::vector<Bone> bones = ProcessAssimpAnimation(scene->mAnimations[i], import.m_boneInfoMap);
 		animations.push_back(new Animation(
 			(float)scene->mAnimations[i]->mDuration,
 			(int32_t)scene->mAnimations[i]->mTicksPerSecond,
-			bones, boneInfoMap, rootObject)
+			bones, import.m_boneInfoMap, rootObject)
 		);
 	}
 	if (animations.size() > 0) {
@@ -144,9 +318,12 @@ SceneObject* ResourceManager::LoadModel(const std::filesystem::path& filePath) {
 		SceneManager::CreateComponent<MeshAnimatorComponent>(rootObject, animations, globalInverseTransform);
 	}
 
-	importer.FreeScene();
-
-	return rootObject;
+	import.m_importer.FreeScene();
+	import.m_scene = nullptr;
+	import.m_meshData.clear();
+	import.m_result = rootObject;
+	import.SetStage(ModelImportStage::Finished);
+	return true;
 }
 
 Texture ResourceManager::LoadTexture(const std::filesystem::path& filePath) {
@@ -256,6 +433,14 @@ Buffer2DTexture<Float> ResourceManager::LoadBuffer2DTextureFloat(const std::file
 }
 
 Buffer2DTexture<Vec3> ResourceManager::LoadBuffer2DTextureRGB(const std::filesystem::path& filePath) {
+	Buffer2D<Vec3> buffer({ 0, 0 });
+	if (!LoadBuffer2DRGB(filePath, buffer)) {
+		return Buffer2DTexture<Vec3>();
+	}
+	return Buffer2DTexture<Vec3>(buffer);
+}
+
+bool ResourceManager::LoadBuffer2DRGB(const std::filesystem::path& filePath, Buffer2D<Vec3>& buffer) {
 	std::cout << "  Loading texture: " << filePath << "\n";
 	int32_t width, height, nrChannels;
 	float* data = stbi_loadf(filePath.string().c_str(), &width, &height, &nrChannels, 3);
@@ -264,15 +449,15 @@ Buffer2DTexture<Vec3> ResourceManager::LoadBuffer2DTextureRGB(const std::filesys
 		data = stbi_loadf(fullPath.string().c_str(), &width, &height, &nrChannels, 3);
 		if (!data) {
 			std::cout << "  Error: Failed to load texture.\n";
-			return Buffer2DTexture<Vec3>();
+			return false;
 		}
 	}
-	Buffer2D<Vec3> buffer({ width, height });
+	buffer.Resize({ width, height });
 	for (int32_t i = 0; i < width * height; i++) {
 		buffer.m_data[i] = Vec3(data[i * 3 + 0], data[i * 3 + 1], data[i * 3 + 2]);
 	}
 	stbi_image_free(data);
-	return Buffer2DTexture<Vec3>(buffer);
+	return true;
 }
 
 Buffer2DTexture<Vec4> ResourceManager::LoadBuffer2DTextureRGBA(const std::filesystem::path& filePath) {
@@ -295,9 +480,9 @@ Buffer2DTexture<Vec4> ResourceManager::LoadBuffer2DTextureRGBA(const std::filesy
 	return Buffer2DTexture<Vec4>(buffer);
 }
 
-HDRISkybox ResourceManager::LoadSkybox(const std::filesystem::path& path) {
-	Buffer2DTexture<Vec3> sphericalMap = LoadBuffer2DTextureRGB(GetApplicationDirectory().string() + std::string("/Resources/Skymaps/") + path.string());
-	return TextureGenerator::Skybox(sphericalMap, { 512, 512 }, { 32, 32 }, { 128, 128 });
+std::shared_ptr<SharedSkybox> ResourceManager::LoadSkybox(const std::filesystem::path& path) {
+	std::filesystem::path fullPath = GetApplicationDirectory().string() + std::string("/Resources/Skymaps/") + path.string();
+	return SkyboxRegistry::Load(fullPath);
 }
 
 Material* ResourceManager::GetDefaultMaterial() {
@@ -403,7 +588,8 @@ std::shared_ptr<Scene> ResourceManager::LoadPixieEngineScene(const std::filesyst
 	return nullptr;
 }
 
-std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::path& filePath) {
+std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::path& filePath, std::vector<std::filesystem::path>& sources) {
+	sources.push_back(filePath);
 	std::ifstream reader;
 	reader.open(filePath);
 	std::string line;
@@ -415,6 +601,7 @@ std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::pat
 	std::vector<SceneObject*> objects;
 	objects.resize(maxDepth);
 	objects[0] = scene->GetRootObject();
+	std::map<std::string, SceneObject*> prototypes;
 	while (std::getline(reader, line)) {
 		trim(line);
 		if (line == "") {
@@ -446,6 +633,10 @@ std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::pat
 				return scene;
 			}
 			objects[depth] = SceneManager::CreateObject("node", objects[depth - 1]);
+			if (tokens[0] == "ObjectBegin" && tokens.size() > 1) {
+				objects[depth]->SetName(tokens[1]);
+				prototypes[tokens[1]] = objects[depth];
+			}
 			continue;
 		}
 		else if (tokens[0] == "AttributeEnd" || tokens[0] == "ObjectEnd") {
@@ -510,8 +701,9 @@ std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::pat
 					std::cout << "Unexpected token parsing Shape plymesh: " << tokens[2] << "\n";
 					break;
 				}
-				std::string modelPath = tokens[3];
-				SceneObject* model = LoadModel(filePath.parent_path().string() + "/" + modelPath);
+				std::string modelPath = filePath.parent_path().string() + "/" + tokens[3];
+				sources.push_back(modelPath);
+				SceneObject* model = LoadModel(modelPath);
 				if (!model) {
 					break;
 				}
@@ -657,7 +849,16 @@ std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::pat
 			continue;
 		}
 		else if (tokens[0] == "ObjectInstance") {
-			std::cout << "Warning: ObjectInstance directive is ignored.\n";
+			if (tokens.size() != 2) {
+				std::cout << "Unexpected tokens amount parsing ObjectInstance: " << tokens.size() << "\n";
+				break;
+			}
+			auto prototype = prototypes.find(tokens[1]);
+			if (prototype == prototypes.end()) {
+				std::cout << "Error parsing ObjectInstance. Object is not defined: " << tokens[1] << "\n";
+				break;
+			}
+			InstantiateObject(prototype->second, objects[depth]);
 			continue;
 		}
 		else if (tokens[0] == "Translate") {
@@ -668,10 +869,39 @@ std::shared_ptr<Scene> ResourceManager::LoadPBRTScene(const std::filesystem::pat
 		break;
 	}
 	reader.close();
+	// Object definitions are not rendered by themselves, only their instances are.
+	for (auto& [name, prototype] : prototypes) {
+		SceneManager::RemoveObject(prototype);
+	}
 	return scene;
 }
 
-SceneObject* ResourceManager::ProcessAssimpNode(const aiScene* scene, const aiNode* node, std::map<std::string, BoneInfo>& boneInfoMap) {
+SceneObject* ResourceManager::InstantiateObject(const SceneObject* prototype, SceneObject* parent) {
+	// Instances share meshes with the prototype, so ray tracer builds a single BVH for all of them.
+	SceneObject* object = SceneManager::CreateObject(prototype->GetName(), parent, prototype->GetTransform());
+	if (MeshComponent* meshComponent = prototype->GetComponent<MeshComponent>()) {
+		SceneManager::CreateComponent<MeshComponent>(object, meshComponent->GetMesh());
+	}
+	if (MaterialComponent* materialComponent = prototype->GetComponent<MaterialComponent>()) {
+		SceneManager::CreateComponent<MaterialComponent>(object, materialComponent->GetMaterial());
+	}
+	for (const SceneObject* child : prototype->GetChildren()) {
+		InstantiateObject(child, object);
+	}
+	return object;
+}
+
+void ResourceManager::CollectAssimpNodeMeshes(const aiNode* node, std::vector<uint32_t>& meshes) {
+	for (uint32_t i = 0; i < node->mNumMeshes; i++) {
+		meshes.push_back(node->mMeshes[i]);
+	}
+	for (uint32_t i = 0; i < node->mNumChildren; i++) {
+		CollectAssimpNodeMeshes(node->mChildren[i], meshes);
+	}
+}
+
+SceneObject* ResourceManager::ProcessAssimpNode(const aiNode* node, ModelImport& import) {
+	const aiScene* scene = import.m_scene;
 	std::cout << "  Node: " << node->mName.C_Str() << " (children: " << node->mNumChildren << ", meshes: " << node->mNumMeshes << ")\n";
 	
 	Transform transform = Transform(AssimpGLMHelpers::ConvertMatrixToGLMFormat(node->mTransformation));
@@ -679,7 +909,7 @@ SceneObject* ResourceManager::ProcessAssimpNode(const aiScene* scene, const aiNo
 
 	if (node->mNumMeshes == 1) {
 		aiMesh* aiMesh = scene->mMeshes[node->mMeshes[0]];
-		Mesh* mesh = ProcessAssimpMesh(aiMesh, boneInfoMap);
+		Mesh* mesh = import.m_meshes[node->mMeshes[0]];
 		SceneManager::CreateComponent<MeshComponent>(nodeObject, mesh);
 		Material* material = GetDefaultMaterial();
 		if (aiMesh->mMaterialIndex >= 0) {
@@ -694,7 +924,7 @@ SceneObject* ResourceManager::ProcessAssimpNode(const aiScene* scene, const aiNo
 		for (uint32_t meshIndex = 0; meshIndex < node->mNumMeshes; meshIndex++) {
 			SceneObject* child = SceneManager::CreateObject("mesh holder", nodeObject);
 			aiMesh* aiMesh = scene->mMeshes[node->mMeshes[meshIndex]];
-			Mesh* mesh = ProcessAssimpMesh(aiMesh, boneInfoMap);
+			Mesh* mesh = import.m_meshes[node->mMeshes[meshIndex]];
 			SceneManager::CreateComponent<MeshComponent>(child, mesh);
 			Material* material = GetDefaultMaterial();
 			if (aiMesh->mMaterialIndex >= 0) {
@@ -706,7 +936,7 @@ SceneObject* ResourceManager::ProcessAssimpNode(const aiScene* scene, const aiNo
 	}
 
 	for (uint32_t i = 0; i < node->mNumChildren; i++) {
-		SceneObject* child = ProcessAssimpNode(scene, node->mChildren[i], boneInfoMap);
+		SceneObject* child = ProcessAssimpNode(node->mChildren[i], import);
 		SceneManager::SetObjectParent(child, nodeObject);
 	}
 
@@ -754,8 +984,19 @@ std::vector<Bone> ResourceManager::ProcessAssimpAnimation(const aiAnimation* ani
 	return bones;
 }
 
-Mesh* ResourceManager::ProcessAssimpMesh(const aiMesh* mesh, std::map<std::string, BoneInfo>& boneInfoMap) {
-	std::vector<Vertex> vertices;
+void ResourceManager::RegisterAssimpBones(const aiMesh* mesh, std::map<std::string, BoneInfo>& boneInfoMap) {
+	for (uint32_t boneIndex = 0; boneIndex < mesh->mNumBones; boneIndex++) {
+		std::string boneName = mesh->mBones[boneIndex]->mName.C_Str();
+		if (boneInfoMap.find(boneName) == boneInfoMap.end()) {
+			int32_t boneID = (int32_t)boneInfoMap.size();
+			boneInfoMap[boneName] = { boneID, AssimpGLMHelpers::ConvertMatrixToGLMFormat(mesh->mBones[boneIndex]->mOffsetMatrix) };
+		}
+	}
+}
+
+void ResourceManager::ProcessAssimpMesh(const aiMesh* mesh, const std::map<std::string, BoneInfo>& boneInfoMap, ModelImport::MeshData& data) {
+	std::vector<Vertex>& vertices = data.vertices;
+	vertices.reserve(mesh->mNumVertices);
 	for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
 		vertices.push_back(Vertex(
 			AssimpGLMHelpers::GetGLMVec(mesh->mVertices[i]),
@@ -764,7 +1005,8 @@ Mesh* ResourceManager::ProcessAssimpMesh(const aiMesh* mesh, std::map<std::strin
 		));
 	}
 
-	std::vector<int32_t> indices;
+	std::vector<int32_t>& indices = data.indices;
+	indices.reserve(mesh->mNumFaces * 3);
 	for (uint32_t i = 0; i < mesh->mNumFaces; i++) {
 		aiFace face = mesh->mFaces[i];
 		bool validFace = true;
@@ -780,16 +1022,9 @@ Mesh* ResourceManager::ProcessAssimpMesh(const aiMesh* mesh, std::map<std::strin
 		}
 	}
 
+	// Bones are registered before conversion, so the map is only read here.
 	for (uint32_t boneIndex = 0; boneIndex < mesh->mNumBones; boneIndex++) {
-		int32_t boneID = -1;
-		std::string boneName = mesh->mBones[boneIndex]->mName.C_Str();
-		if (boneInfoMap.find(boneName) == boneInfoMap.end()) {
-			boneID = (int32_t)boneInfoMap.size();
-			boneInfoMap[boneName] = { boneID, AssimpGLMHelpers::ConvertMatrixToGLMFormat(mesh->mBones[boneIndex]->mOffsetMatrix) };
-		}
-		else {
-			boneID = boneInfoMap[boneName].id;
-		}
+		int32_t boneID = boneInfoMap.at(mesh->mBones[boneIndex]->mName.C_Str()).id;
 		assert(boneID != -1);
 
 		aiVertexWeight* weights = mesh->mBones[boneIndex]->mWeights;
@@ -798,8 +1033,6 @@ Mesh* ResourceManager::ProcessAssimpMesh(const aiMesh* mesh, std::map<std::strin
 			vertices[weights[weightIndex].mVertexId].AddWeight(boneID, weights[weightIndex].mWeight);
 		}
 	}
-
-	return new Mesh(vertices, indices);
 }
 
 Material* ResourceManager::ProcessAssimpMaterial(const aiMaterial* aiMaterial) {
@@ -825,13 +1058,13 @@ Material* ResourceManager::ProcessAssimpMaterial(const aiMaterial* aiMaterial) {
 	glmEmissionColor /= emissionNormaizer;
 	emissionInt = emissionNormaizer * (emissionInt ? emissionInt : 1.0f);
 
-	std::vector<Buffer2DTexture<Vec3>> diffuseMaps = ProcessAssimpMaterialTextures(aiMaterial, aiTextureType_DIFFUSE, "texture_diffuse");
-	std::vector<Buffer2DTexture<Vec3>> specularMaps = ProcessAssimpMaterialTextures(aiMaterial, aiTextureType_SPECULAR, "texture_specular");
+	std::vector<std::shared_ptr<CachedTexture>> diffuseMaps = ProcessAssimpMaterialTextures(aiMaterial, aiTextureType_DIFFUSE, "texture_diffuse");
+	std::vector<std::shared_ptr<CachedTexture>> specularMaps = ProcessAssimpMaterialTextures(aiMaterial, aiTextureType_SPECULAR, "texture_specular");
 
 	Material material = Material(materialName);
 	material.m_albedo = Vec3(color.r, color.g, color.b);
 	if (diffuseMaps.size() > 0) {
-		material.m_albedoTexture = diffuseMaps[0];
+		material.m_albedoMap = diffuseMaps[0];
 	}
 	material.m_roughness = 1.0f - metallic;
 	material.m_metallic = metallic;
@@ -854,13 +1087,15 @@ Material* ResourceManager::ProcessAssimpMaterial(const aiMaterial* aiMaterial) {
 	return AddMaterial(material);
 }
 
-std::vector<Buffer2DTexture<Vec3>> ResourceManager::ProcessAssimpMaterialTextures(const aiMaterial* material, aiTextureType type, const std::string& name) {
-	std::vector<Buffer2DTexture<Vec3>> textures;
+std::vector<std::shared_ptr<CachedTexture>> ResourceManager::ProcessAssimpMaterialTextures(const aiMaterial* material, aiTextureType type, const std::string& name) {
+	std::vector<std::shared_ptr<CachedTexture>> textures;
 	for (uint32_t i = 0; i < material->GetTextureCount(type); i++) {
 		aiString str;
 		material->GetTexture(type, i, &str);
 		std::filesystem::path texturePath = m_currentFilePath.parent_path().string() + "/" + str.C_Str();
-		textures.push_back(LoadBuffer2DTextureRGB(texturePath));
+		if (std::shared_ptr<CachedTexture> texture = TextureCache::Load(texturePath)) {
+			textures.push_back(texture);
+		}
 	}
 	return textures;
 }
@@ -4,6 +4,9 @@
 #include "Animation/MeshAnimator.h"
 #include "Shader.h"
 #include "Buffer2DTexture.h"
+#include "TextureCache.h"
+#include "SkyboxRegistry.h"
+#include "ModelImport.h"
 
 enum class ResourceType : int32_t {
 	Scene,
@@ -32,19 +35,30 @@ public:
 	static std::filesystem::path GetApplicationPath();
 	static std::filesystem::path GetApplicationDirectory();
 	static std::filesystem::path GetAssetsPath();
+	// Directory for data derived from assets which can be rebuilt at any time.
+	static std::filesystem::path GetCacheDirectory();
 	static void SetAssetsPath(const std::filesystem::path& path);
 	static void Initialize();
 	static std::shared_ptr<Scene> LoadScene(const std::filesystem::path& filePath);
 	static bool SaveScene(const std::filesystem::path& filePath, Scene* scene);
 	static SceneObject* LoadModel(const std::filesystem::path& filePath);
+	// Imports model on background threads, it's added to the active scene by UpdateModelImports once it's ready.
+	static std::shared_ptr<ModelImport> LoadModelAsync(const std::filesystem::path& filePath);
+	// Uploads data of background imports within a per frame budget and creates objects of finished ones. Must be
+	// called on main thread, returns true when a model was added to the scene.
+	static bool UpdateModelImports();
+	static const std::vector<std::shared_ptr<ModelImport>>& GetModelImports();
 	static Texture LoadTextureFloat(const std::filesystem::path& filePath);
 	static Texture LoadTexture(const std::filesystem::path& filePath);
 	static Texture LoadTextureRGB(const std::filesystem::path& filePath);
 	static Texture LoadTextureRGBA(const std::filesystem::path& filePath);
 	static Buffer2DTexture<Float> LoadBuffer2DTextureFloat(const std::filesystem::path& filePath);
 	static Buffer2DTexture<Vec3> LoadBuffer2DTextureRGB(const std::filesystem::path& filePath);
+	// Decodes image without creating OpenGL texture, so it can run on any thread.
+	static bool LoadBuffer2DRGB(const std::filesystem::path& filePath, Buffer2D<Vec3>& buffer);
 	static Buffer2DTexture<Vec4> LoadBuffer2DTextureRGBA(const std::filesystem::path& filePath);
-	static HDRISkybox LoadSkybox(const std::filesystem::path& path);
+	// Skybox from Resources/Skymaps, shared by all scenes and loaded in background.
+	static std::shared_ptr<SharedSkybox> LoadSkybox(const std::filesystem::path& path);
 	static Material* GetDefaultMaterial();
 	static Material* AddMaterial(const Material& material);
 	static Material* GetMaterial(uint32_t index);
@@ -79,15 +93,24 @@ protected:
 	static std::map<char, FontCharacter> m_characters;
 	static uint32_t m_defaultFontSize;
 	static Texture m_brdfLUT;
+	static std::vector<std::shared_ptr<ModelImport>> m_modelImports;
 
 	static bool CheckFileExtensionSupport(const std::filesystem::path& filePath, ResourceType type);
 	static std::shared_ptr<Scene> LoadPixieEngineScene(const std::filesystem::path& path);
-	static std::shared_ptr<Scene> LoadPBRTScene(const std::filesystem::path& filePath);
-	static SceneObject* ProcessAssimpNode(const aiScene* scene, const aiNode* node, std::map<std::string, BoneInfo>& boneInfoMap);
+	// Appends every file read while parsing to sources, scene file first.
+	static std::shared_ptr<Scene> LoadPBRTScene(const std::filesystem::path& filePath, std::vector<std::filesystem::path>& sources);
+	static SceneObject* InstantiateObject(const SceneObject* prototype, SceneObject* parent);
+	// Part of import independent of OpenGL and scene, runs on background thread for asynchronous imports.
+	static void ImportModel(ModelImport& import);
+	// Returns false when upload budget ran out before import was finished.
+	static bool FinishModelImport(ModelImport& import, size_t& uploadBudget);
+	static void CollectAssimpNodeMeshes(const aiNode* node, std::vector<uint32_t>& meshes);
+	static SceneObject* ProcessAssimpNode(const aiNode* node, ModelImport& import);
 	static std::vector<Bone> ProcessAssimpAnimation(const aiAnimation* animation, std::map<std::string, BoneInfo>& boneInfoMap);
-	static Mesh* ProcessAssimpMesh(const aiMesh* mesh, std::map<std::string, BoneInfo>& boneInfoMap);
+	static void RegisterAssimpBones(const aiMesh* mesh, std::map<std::string, BoneInfo>& boneInfoMap);
+	static void ProcessAssimpMesh(const aiMesh* mesh, const std::map<std::string, BoneInfo>& boneInfoMap, ModelImport::MeshData& data);
 	static Material* ProcessAssimpMaterial(const aiMaterial* material);
-	static std::vector<Buffer2DTexture<Vec3>> ProcessAssimpMaterialTextures(const aiMaterial* material, aiTextureType type, const std::string& name);
+	static std::vector<std::shared_ptr<CachedTexture>> ProcessAssimpMaterialTextures(const aiMaterial* material, aiTextureType type, const std::string& name);
 	static std::vector<std::string> SplitPBRTFileLine(const std::string& line);
 	static Float StringToFloat(const std::string& str);
 	static Material* FindMaterial(const std::string& name);
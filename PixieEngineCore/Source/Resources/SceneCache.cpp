@@ -0,0 +1,376 @@
+#include "pch.h"
+#include "SceneCache.h"
+#include "BinaryIO.h"
+#include "ResourceManager.h"
+#include "SceneManager.h"
+#include "MeshBVH.h"
+#include "Parallel.h"
+#include "Math/Hash.h"
+
+std::filesystem::path SceneCache::GetCachePath(const std::filesystem::path& sourcePath) {
+	std::filesystem::path path = sourcePath;
+	path += ".pxcache";
+	return path;
+}
+
+std::shared_ptr<Scene> SceneCache::Load(const std::filesystem::path& sourcePath) {
+	std::ifstream file(GetCachePath(sourcePath), std::ios::binary);
+	if (!file) {
+		return nullptr;
+	}
+	uint32_t magic = 0, version = 0;
+	if (!ReadBinary(file, magic) || !ReadBinary(file, version) || magic != c_fileMagic || version != c_fileVersion || !ReadLayout(file)) {
+		return nullptr;
+	}
+
+	std::filesystem::path directory = sourcePath.parent_path();
+	uint32_t sourcesCount = 0;
+	if (!ReadBinary(file, sourcesCount)) {
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < sourcesCount; i++) {
+		SourceFile sourceFile;
+		if (!ReadBinary(file, sourceFile.path) || !ReadBinary(file, sourceFile.size) || !ReadBinary(file, sourceFile.timestamp) || !ReadBinary(file, sourceFile.hash)) {
+			return nullptr;
+		}
+		if (!IsUpToDate(directory, sourceFile)) {
+			std::cout << "Scene cache is out of date: " << sourceFile.path << " was modified.\n";
+			return nullptr;
+		}
+	}
+
+	std::cout << "Loading scene from cache: " << GetCachePath(sourcePath) << "\n";
+	uint32_t meshesCount = 0;
+	if (!ReadBinary(file, meshesCount)) {
+		return nullptr;
+	}
+	std::vector<std::vector<Vertex>> vertices(meshesCount);
+	std::vector<std::vector<int32_t>> indices(meshesCount);
+	for (uint32_t i = 0; i < meshesCount; i++) {
+		if (!ReadBinary(file, vertices[i]) || !ReadBinary(file, indices[i])) {
+			std::cout << "  Error: Scene cache is corrupted.\n";
+			return nullptr;
+		}
+		for (int32_t index : indices[i]) {
+			if (index < 0 || (size_t)index >= vertices[i].size()) {
+				std::cout << "  Error: Scene cache is corrupted.\n";
+				return nullptr;
+			}
+		}
+	}
+
+	uint32_t materialsCount = 0;
+	if (!ReadBinary(file, materialsCount)) {
+		return nullptr;
+	}
+	std::vector<Material> materials(materialsCount);
+	for (uint32_t i = 0; i < materialsCount; i++) {
+		if (!ReadMaterial(file, materials[i])) {
+			std::cout << "  Error: Scene cache is corrupted.\n";
+			return nullptr;
+		}
+	}
+
+	uint32_t rootChildrenCount = 0;
+	std::vector<ObjectRecord> records;
+	if (!ReadBinary(file, rootChildrenCount)) {
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < rootChildrenCount; i++) {
+		if (!ReadObject(file, records, meshesCount, materialsCount)) {
+			std::cout << "  Error: Scene cache is corrupted.\n";
+			return nullptr;
+		}
+	}
+
+	// Everything needed to restore the scene is read, so nothing below can leave it half built.
+	std::vector<Mesh*> meshes(meshesCount);
+	for (uint32_t i = 0; i < meshesCount; i++) {
+		meshes[i] = new Mesh({}, {});
+		meshes[i]->m_vertices = std::move(vertices[i]);
+		meshes[i]->m_indices = std::move(indices[i]);
+		meshes[i]->Upload();
+	}
+	// Materials are shared by name like in PBRT scenes, pointers are taken once all of them are added.
+	for (const Material& material : materials) {
+		if (ResourceManager::GetMaterialIndex(material.m_name) == 0 && material.m_name != ResourceManager::GetDefaultMaterial()->m_name) {
+			ResourceManager::AddMaterial(material);
+		}
+	}
+	std::vector<Material*> materialPointers(materialsCount);
+	for (uint32_t i = 0; i < materialsCount; i++) {
+		materialPointers[i] = ResourceManager::GetMaterial(ResourceManager::GetMaterialIndex(materials[i].m_name));
+	}
+
+	std::shared_ptr<Scene> scene = SceneManager::CreateScene(sourcePath.filename().string());
+	size_t recordIndex = 0;
+	for (uint32_t i = 0; i < rootChildrenCount; i++) {
+		CreateObjects(records, recordIndex, scene->GetRootObject(), meshes, materialPointers);
+	}
+
+	// Components may upload their meshes again, BVHs are bound to mesh versions after all of them are created.
+	for (uint32_t i = 0; i < meshesCount; i++) {
+		meshes[i]->m_cachedBVH = MeshBVH::Read(file, meshes[i]);
+		if (!meshes[i]->m_cachedBVH) {
+			std::cout << "Warning: Scene cache holds no valid BVH of mesh " << i << ", remaining BVHs will be rebuilt.\n";
+			break;
+		}
+	}
+	return scene;
+}
+
+bool SceneCache::Write(const std::filesystem::path& sourcePath, Scene* scene, const std::vector<std::filesystem::path>& sources, BVHBuildMethod buildMethod) {
+	Contents contents;
+	for (SceneObject* child : scene->GetRootObject()->GetChildren()) {
+		if (!CollectContents(child, contents)) {
+			return false;
+		}
+	}
+
+	std::filesystem::path directory = sourcePath.parent_path();
+	std::vector<SourceFile> sourceFiles(sources.size());
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (!GetSourceFile(directory, sources[i], sourceFiles[i])) {
+			std::cout << "Warning: Scene cache is not written, failed to read source file: " << sources[i] << "\n";
+			return false;
+		}
+	}
+
+	// Mesh BVHs are built here instead of by the first snapshot, so they are stored with the scene.
+	ParallelFor((int32_t)contents.meshes.size(), [&](int32_t start, int32_t end) {
+		for (int32_t i = start; i < end; i++) {
+			Mesh* mesh = contents.meshes[i];
+			if (!mesh->m_cachedBVH || !mesh->m_cachedBVH->IsUpToDate(mesh, buildMethod)) {
+				mesh->m_cachedBVH = std::make_shared<MeshBVH>(mesh, buildMethod);
+			}
+		}
+	}, 1);
+
+	// Written under a temporary name, so an interrupted write never leaves a cache which looks valid.
+	std::filesystem::path path = GetCachePath(sourcePath);
+	std::filesystem::path temporaryPath = path;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary);
+		if (!file) {
+			std::cout << "Warning: Failed to write scene cache: " << path << "\n";
+			return false;
+		}
+		WriteBinary(file, c_fileMagic);
+		WriteBinary(file, c_fileVersion);
+		WriteLayout(file);
+
+		WriteBinary(file, (uint32_t)sourceFiles.size());
+		for (const SourceFile& sourceFile : sourceFiles) {
+			WriteBinary(file, sourceFile.path);
+			WriteBinary(file, sourceFile.size);
+			WriteBinary(file, sourceFile.timestamp);
+			WriteBinary(file, sourceFile.hash);
+		}
+
+		WriteBinary(file, (uint32_t)contents.meshes.size());
+		for (const Mesh* mesh : contents.meshes) {
+			WriteBinary(file, mesh->m_vertices);
+			WriteBinary(file, mesh->m_indices);
+		}
+
+		WriteBinary(file, (uint32_t)contents.materials.size());
+		for (Material* material : contents.materials) {
+			WriteMaterial(file, material);
+		}
+
+		const std::vector<SceneObject*>& rootChildren = scene->GetRootObject()->GetChildren();
+		WriteBinary(file, (uint32_t)rootChildren.size());
+		for (SceneObject* child : rootChildren) {
+			WriteObject(file, child, contents);
+		}
+
+		for (const Mesh* mesh : contents.meshes) {
+			mesh->m_cachedBVH->Write(file);
+		}
+		if (!file) {
+			std::cout << "Warning: Failed to write scene cache: " << path << "\n";
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		std::cout << "Warning: Failed to write scene cache: " << path << "\n";
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+// Raw structures are stored as they are in memory, cache written by a build with different layout is ignored.
+void SceneCache::WriteLayout(std::ostream& stream) {
+	WriteBinary(stream, (uint32_t)sizeof(Float));
+	WriteBinary(stream, (uint32_t)sizeof(Vertex));
+	WriteBinary(stream, (uint32_t)sizeof(BVHNode));
+	WriteBinary(stream, (uint32_t)sizeof(TrianglePacket));
+	WriteBinary(stream, (uint32_t)sizeof(TriangleShading));
+	WriteBinary(stream, (uint32_t)sizeof(BVHBuildStats));
+}
+
+bool SceneCache::ReadLayout(std::istream& stream) {
+	std::array<uint32_t, 6> sizes;
+	for (uint32_t& size : sizes) {
+		if (!ReadBinary(stream, size)) {
+			return false;
+		}
+	}
+	return sizes[0] == sizeof(Float) && sizes[1] == sizeof(Vertex) && sizes[2] == sizeof(BVHNode) &&
+		sizes[3] == sizeof(TrianglePacket) && sizes[4] == sizeof(TriangleShading) && sizes[5] == sizeof(BVHBuildStats);
+}
+
+bool SceneCache::GetSourceFile(const std::filesystem::path& directory, const std::filesystem::path& path, SourceFile& sourceFile) {
+	std::error_code error;
+	sourceFile.path = path.lexically_relative(directory).generic_string();
+	if (sourceFile.path.empty()) {
+		sourceFile.path = path.generic_string();
+	}
+	sourceFile.size = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	sourceFile.timestamp = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+	if (error) {
+		return false;
+	}
+	sourceFile.hash = HashFile(path);
+	return true;
+}
+
+bool SceneCache::IsUpToDate(const std::filesystem::path& directory, const SourceFile& sourceFile) {
+	std::filesystem::path path = directory / sourceFile.path;
+	std::error_code error;
+	uint64_t size = std::filesystem::file_size(path, error);
+	if (error || size != sourceFile.size) {
+		return false;
+	}
+	int64_t timestamp = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+	if (error) {
+		return false;
+	}
+	// Files touched without changes, for example by a checkout, are compared by content.
+	return timestamp == sourceFile.timestamp || HashFile(path) == sourceFile.hash;
+}
+
+uint64_t SceneCache::HashFile(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return MurmurHash64A((const unsigned char*)source.data(), source.size(), 0);
+}
+
+bool SceneCache::CollectContents(SceneObject* object, Contents& contents) {
+	for (Component* component : object->GetComponents()) {
+		if (component->type == ComponentType::Mesh) {
+			Mesh* mesh = ((MeshComponent*)component)->GetMesh();
+			if (contents.meshIndices.find(mesh) == contents.meshIndices.end()) {
+				contents.meshIndices[mesh] = (int32_t)contents.meshes.size();
+				contents.meshes.push_back(mesh);
+			}
+		}
+		else if (component->type == ComponentType::Material) {
+			Material* material = ((MaterialComponent*)component)->GetMaterial();
+			if (contents.materialIndices.find(material) == contents.materialIndices.end()) {
+				contents.materialIndices[material] = (int32_t)contents.materials.size();
+				contents.materials.push_back(material);
+			}
+		}
+		else if (component->type != ComponentType::DiffuseAreaLight) {
+			std::cout << "Warning: Scene cache is not written, " << to_string(component->type) << " can't be stored in it.\n";
+			return false;
+		}
+	}
+	for (SceneObject* child : object->GetChildren()) {
+		if (!CollectContents(child, contents)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void SceneCache::WriteMaterial(std::ostream& stream, Material* material) {
+	WriteBinary(stream, material->m_name);
+	WriteBinary(stream, material->m_albedo.GetRGB());
+	WriteBinary(stream, material->m_emissionColor.GetRGB());
+	WriteBinary(stream, material->m_emissionStrength);
+	WriteBinary(stream, material->m_metallic);
+	WriteBinary(stream, material->m_roughness);
+	WriteBinary(stream, material->m_refraction);
+	WriteBinary(stream, material->m_transparency);
+	WriteBinary(stream, material->m_albedoMap ? material->m_albedoMap->GetPath().string() : std::string());
+}
+
+bool SceneCache::ReadMaterial(std::istream& stream, Material& material) {
+	Vec3 albedo, emissionColor;
+	std::string albedoMapPath;
+	if (!ReadBinary(stream, material.m_name) || !ReadBinary(stream, albedo) || !ReadBinary(stream, emissionColor) ||
+		!ReadBinary(stream, material.m_emissionStrength) || !ReadBinary(stream, material.m_metallic) || !ReadBinary(stream, material.m_roughness) ||
+		!ReadBinary(stream, material.m_refraction) || !ReadBinary(stream, material.m_transparency) || !ReadBinary(stream, albedoMapPath)) {
+		return false;
+	}
+	material.m_albedo = Spectrum(albedo);
+	material.m_emissionColor = Spectrum(emissionColor);
+	if (!albedoMapPath.empty()) {
+		material.m_albedoMap = TextureCache::Load(albedoMapPath);
+	}
+	return true;
+}
+
+void SceneCache::WriteObject(std::ostream& stream, const SceneObject* object, const Contents& contents) {
+	MeshComponent* meshComponent = object->GetComponent<MeshComponent>();
+	MaterialComponent* materialComponent = object->GetComponent<MaterialComponent>();
+	AreaLightComponent* areaLightComponent = object->GetComponent<AreaLightComponent>();
+	WriteBinary(stream, object->GetName());
+	WriteBinary(stream, object->GetTransform().GetMatrix());
+	WriteBinary(stream, meshComponent ? contents.meshIndices.at(meshComponent->GetMesh()) : -1);
+	WriteBinary(stream, materialComponent ? contents.materialIndices.at(materialComponent->GetMaterial()) : -1);
+	WriteBinary(stream, areaLightComponent != nullptr);
+	WriteBinary(stream, areaLightComponent ? areaLightComponent->GetColor() : Vec3(1.0f));
+	WriteBinary(stream, areaLightComponent ? areaLightComponent->GetStrength() : 0.0f);
+	WriteBinary(stream, (uint32_t)object->GetChildren().size());
+	for (SceneObject* child : object->GetChildren()) {
+		WriteObject(stream, child, contents);
+	}
+}
+
+bool SceneCache::ReadObject(std::istream& stream, std::vector<ObjectRecord>& records, size_t meshesCount, size_t materialsCount) {
+	ObjectRecord record;
+	if (!ReadBinary(stream, record.name) || !ReadBinary(stream, record.transform) || !ReadBinary(stream, record.meshIndex) || !ReadBinary(stream, record.materialIndex) ||
+		!ReadBinary(stream, record.hasAreaLight) || !ReadBinary(stream, record.lightColor) || !ReadBinary(stream, record.lightStrength) || !ReadBinary(stream, record.childrenCount)) {
+		return false;
+	}
+	if (record.meshIndex < -1 || record.meshIndex >= (int32_t)meshesCount || record.materialIndex < -1 || record.materialIndex >= (int32_t)materialsCount) {
+		return false;
+	}
+	records.push_back(record);
+	for (uint32_t i = 0; i < record.childrenCount; i++) {
+		if (!ReadObject(stream, records, meshesCount, materialsCount)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void SceneCache::CreateObjects(const std::vector<ObjectRecord>& records, size_t& index, SceneObject* parent, const std::vector<Mesh*>& meshes, const std::vector<Material*>& materials) {
+	const ObjectRecord& record = records[index++];
+	SceneObject* object = SceneManager::CreateObject(record.name, parent, Transform(record.transform));
+	if (record.materialIndex != -1) {
+		SceneManager::CreateComponent<MaterialComponent>(object, materials[record.materialIndex]);
+	}
+	if (record.meshIndex != -1) {
+		SceneManager::CreateComponent<MeshComponent>(object, meshes[record.meshIndex]);
+	}
+	if (record.hasAreaLight) {
+		SceneManager::CreateComponent<AreaLightComponent>(object, record.lightColor, record.lightStrength);
+	}
+	for (uint32_t i = 0; i < record.childrenCount; i++) {
+		CreateObjects(records, index, object, meshes, materials);
+	}
+}
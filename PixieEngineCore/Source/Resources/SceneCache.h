@@ -0,0 +1,57 @@
+#pragma once
+#include "pch.h"
+#include "BVHBuilder.h"
+#include "Scene/Scene.h"
+
+// Binary copy of a parsed scene stored next to its source file: meshes, materials, object hierarchy and prebuilt
+// mesh BVHs. Valid while every source file keeps its size and either its modification time or its content hash.
+class SceneCache {
+public:
+	static std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath);
+	// Returns nullptr if there is no up to date cache of the source.
+	static std::shared_ptr<Scene> Load(const std::filesystem::path& sourcePath);
+	// Sources are the scene file followed by every file read while parsing it. Scenes with components which can't be
+	// restored from cache are not written.
+	static bool Write(const std::filesystem::path& sourcePath, Scene* scene, const std::vector<std::filesystem::path>& sources, BVHBuildMethod buildMethod);
+
+protected:
+	static constexpr uint32_t c_fileMagic = 0x50584353; // "PXCS"
+	static constexpr uint32_t c_fileVersion = 3;
+
+	struct SourceFile {
+		std::string path; // relative to directory of the scene file
+		uint64_t size = 0;
+		int64_t timestamp = 0;
+		uint64_t hash = 0;
+	};
+
+	struct ObjectRecord {
+		std::string name;
+		Mat4 transform = Mat4(1.0f);
+		int32_t meshIndex = -1;
+		int32_t materialIndex = -1;
+		bool hasAreaLight = false;
+		Vec3 lightColor = Vec3(1.0f);
+		Float lightStrength = 0.0f;
+		uint32_t childrenCount = 0;
+	};
+
+	struct Contents {
+		std::vector<Mesh*> meshes;
+		std::map<const Mesh*, int32_t> meshIndices;
+		std::vector<Material*> materials;
+		std::map<const Material*, int32_t> materialIndices;
+	};
+
+	static void WriteLayout(std::ostream& stream);
+	static bool ReadLayout(std::istream& stream);
+	static bool GetSourceFile(const std::filesystem::path& directory, const std::filesystem::path& path, SourceFile& sourceFile);
+	static bool IsUpToDate(const std::filesystem::path& directory, const SourceFile& sourceFile);
+	static uint64_t HashFile(const std::filesystem::path& path);
+	static bool CollectContents(SceneObject* object, Contents& contents);
+	static void WriteMaterial(std::ostream& stream, Material* material);
+	static bool ReadMaterial(std::istream& stream, Material& material);
+	static void WriteObject(std::ostream& stream, const SceneObject* object, const Contents& contents);
+	static bool ReadObject(std::istream& stream, std::vector<ObjectRecord>& records, size_t meshesCount, size_t materialsCount);
+	static void CreateObjects(const std::vector<ObjectRecord>& records, size_t& index, SceneObject* parent, const std::vector<Mesh*>& meshes, const std::vector<Material*>& materials);
+};
@@ -0,0 +1,114 @@
+#include "pch.h"
+#include "SkyboxRegistry.h"
+#include "ResourceManager.h"
+#include "TextureGenerator.h"
+#include "Math/Hash.h"
+
+std::map<std::filesystem::path, std::shared_ptr<SharedSkybox>> SkyboxRegistry::m_skyboxes;
+std::shared_ptr<const HDRISkybox> SkyboxRegistry::m_placeholder;
+std::mutex SkyboxRegistry::m_environmentMapsMutex;
+std::map<uint64_t, std::weak_ptr<const EnvironmentMap>> SkyboxRegistry::m_environmentMaps;
+
+/*
+	Shared Skybox
+*/
+
+SharedSkybox::SharedSkybox(const std::filesystem::path& path) :
+	m_path(path) {}
+
+const std::filesystem::path& SharedSkybox::GetPath() const {
+	return m_path;
+}
+
+bool SharedSkybox::IsReady() const {
+	return m_skybox != nullptr;
+}
+
+bool SharedSkybox::IsFailed() const {
+	return m_isFailed;
+}
+
+std::shared_ptr<const HDRISkybox> SharedSkybox::Get() const {
+	return m_skybox;
+}
+
+/*
+	Skybox Registry
+*/
+
+std::shared_ptr<SharedSkybox> SkyboxRegistry::Load(const std::filesystem::path& path) {
+	std::shared_ptr<SharedSkybox>& skybox = m_skyboxes[path];
+	if (!skybox) {
+		skybox = std::make_shared<SharedSkybox>(path);
+		skybox->m_decoded = std::async(std::launch::async, Decode, path);
+	}
+	return skybox;
+}
+
+std::shared_ptr<const HDRISkybox> SkyboxRegistry::GetPlaceholder() {
+	if (!m_placeholder) {
+		m_placeholder = std::make_shared<const HDRISkybox>(TextureGenerator::GradientSkybox(Vec3(1.0f, 1.0f, 1.0f), Vec3(0.5f, 0.7f, 1.0f)));
+	}
+	return m_placeholder;
+}
+
+void SkyboxRegistry::Update() {
+	for (auto& [path, skybox] : m_skyboxes) {
+		if (skybox->m_decoded.valid() && skybox->m_decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			Finish(*skybox);
+		}
+	}
+}
+
+void SkyboxRegistry::Wait(SharedSkybox& skybox) {
+	if (skybox.m_decoded.valid()) {
+		skybox.m_decoded.wait();
+		Finish(skybox);
+	}
+}
+
+int32_t SkyboxRegistry::GetLoadingCount() {
+	int32_t count = 0;
+	for (auto& [path, skybox] : m_skyboxes) {
+		if (skybox->m_decoded.valid()) {
+			count++;
+		}
+	}
+	return count;
+}
+
+SharedSkybox::DecodedSkybox SkyboxRegistry::Decode(const std::filesystem::path& path) {
+	SharedSkybox::DecodedSkybox decoded;
+	Buffer2D<Vec3> image({ 0, 0 });
+	if (!ResourceManager::LoadBuffer2DRGB(path, image)) {
+		return decoded;
+	}
+
+	std::ifstream file(path, std::ios::binary);
+	std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	uint64_t sourceHash = MurmurHash64A((const unsigned char*)source.data(), source.size(), 0);
+	{
+		std::lock_guard<std::mutex> lock(m_environmentMapsMutex);
+		decoded.environmentMap = m_environmentMaps[sourceHash].lock();
+	}
+	if (!decoded.environmentMap) {
+		decoded.environmentMap = EnvironmentMap::LoadCached(image, sourceHash, ResourceManager::GetCacheDirectory() / "Skyboxes");
+		std::lock_guard<std::mutex> lock(m_environmentMapsMutex);
+		m_environmentMaps[sourceHash] = decoded.environmentMap;
+	}
+	decoded.image = std::move(image);
+	return decoded;
+}
+
+void SkyboxRegistry::Finish(SharedSkybox& skybox) {
+	SharedSkybox::DecodedSkybox decoded = skybox.m_decoded.get();
+	if (!decoded.image) {
+		std::cout << "  Error: Failed to load skybox: " << skybox.m_path << "\n";
+		skybox.m_isFailed = true;
+		return;
+	}
+	Buffer2DTexture<Vec3> sphericalMap(*decoded.image);
+	HDRISkybox result = TextureGenerator::Skybox(sphericalMap, { 512, 512 }, { 32, 32 }, { 128, 128 });
+	result.m_environmentMap = decoded.environmentMap;
+	skybox.m_skybox = std::make_shared<const HDRISkybox>(std::move(result));
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.h"
+#include "Buffer2D.h"
+#include "Scene/Skyboxes.h"
+
+// Skybox loaded from an HDR file and shared by all scenes using it. The file is decoded and its ray tracing tables
+// are built on a background thread, textures are created on main thread by SkyboxRegistry::Update.
+class SharedSkybox {
+public:
+	SharedSkybox(const std::filesystem::path& path);
+
+	const std::filesystem::path& GetPath() const;
+	bool IsReady() const;
+	bool IsFailed() const;
+	// Null until the skybox is ready.
+	std::shared_ptr<const HDRISkybox> Get() const;
+
+protected:
+	struct DecodedSkybox {
+		std::optional<Buffer2D<Vec3>> image;
+		std::shared_ptr<const EnvironmentMap> environmentMap;
+	};
+
+	std::filesystem::path m_path;
+	std::future<DecodedSkybox> m_decoded;
+	std::shared_ptr<const HDRISkybox> m_skybox;
+	bool m_isFailed = false;
+
+	friend class SkyboxRegistry;
+};
+
+// Skyboxes by file path, every file is loaded once. Registry is accessed from main thread only.
+class SkyboxRegistry {
+public:
+	static std::shared_ptr<SharedSkybox> Load(const std::filesystem::path& path);
+	// Small gradient sky shown by scenes while their skybox is loading.
+	static std::shared_ptr<const HDRISkybox> GetPlaceholder();
+	// Creates textures of skyboxes decoded since the last call.
+	static void Update();
+	// Blocks until the skybox is decoded and finishes it, for headless callers not running Update every frame.
+	static void Wait(SharedSkybox& skybox);
+	static int32_t GetLoadingCount();
+
+protected:
+	static std::map<std::filesystem::path, std::shared_ptr<SharedSkybox>> m_skyboxes;
+	static std::shared_ptr<const HDRISkybox> m_placeholder;
+	// Ray tracing tables by content hash of the source file, filled by background loads.
+	static std::mutex m_environmentMapsMutex;
+	static std::map<uint64_t, std::weak_ptr<const EnvironmentMap>> m_environmentMaps;
+
+	static SharedSkybox::DecodedSkybox Decode(const std::filesystem::path& path);
+	static void Finish(SharedSkybox& skybox);
+};
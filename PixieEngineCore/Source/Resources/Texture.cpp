@@ -4,6 +4,10 @@
 std::map<GLuint, std::atomic<uint32_t>> Texture::s_counters;
 
 Texture::Texture() {
+	if (!IsOpenGLContextLoaded()) {
+		Texture::s_counters[m_id]++;
+		return;
+	}
 	glGenTextures(1, &m_id);
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -23,6 +27,10 @@ Texture::Texture(glm::ivec2 resolution, GLuint textureID) :
 
 Texture::Texture(glm::ivec2 resolution, GLint internalFormat, GLenum format, GLenum type, GLint wrapS, GLint wrapT, GLint minFilter, GLint magFilter) :
 	m_resolution(resolution), m_internalFormat(internalFormat), m_format(format), m_type(type) {
+	if (!IsOpenGLContextLoaded()) {
+		Texture::s_counters[m_id]++;
+		return;
+	}
 	glGenTextures(1, &m_id);
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
@@ -36,6 +44,10 @@ Texture::Texture(glm::ivec2 resolution, GLint internalFormat, GLenum format, GLe
 
 Texture::Texture(glm::ivec2 resolution, GLint internalFormat, GLenum format, GLenum type, void* data, GLint wrapS, GLint wrapT, GLint minFilter, GLint magFilter) :
 	m_resolution(resolution), m_internalFormat(internalFormat), m_format(format), m_type(type) {
+	if (!IsOpenGLContextLoaded()) {
+		Texture::s_counters[m_id]++;
+		return;
+	}
 	glGenTextures(1, &m_id);
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
@@ -50,7 +62,7 @@ Texture::Texture(glm::ivec2 resolution, GLint internalFormat, GLenum format, GLe
 Texture::~Texture() {
 	if (!Texture::s_counters.empty()) {
 		Texture::s_counters[m_id]--;
-		if (Texture::s_counters[m_id] == 0) {
+		if (Texture::s_counters[m_id] == 0 && IsOpenGLContextLoaded()) {
 			glDeleteTextures(1, &m_id);
 		}
 	}
@@ -68,7 +80,7 @@ Texture::Texture(const Texture& other) {
 Texture& Texture::operator= (const Texture& other) {
 	if (m_id != other.m_id) {
 		Texture::s_counters[m_id]--;
-		if (Texture::s_counters[m_id] == 0) {
+		if (Texture::s_counters[m_id] == 0 && IsOpenGLContextLoaded()) {
 			glDeleteTextures(1, &m_id);
 		}
 	}
@@ -82,6 +94,7 @@ Texture& Texture::operator= (const Texture& other) {
 }
 
 void Texture::SetWrap(GLint wrapS, GLint wrapT) {
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
@@ -89,6 +102,7 @@ void Texture::SetWrap(GLint wrapS, GLint wrapT) {
 }
 
 void Texture::SetFilters(GLint minFilter, GLint magFilter) {
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
@@ -96,12 +110,14 @@ void Texture::SetFilters(GLint minFilter, GLint magFilter) {
 }
 
 void Texture::SetMinFilter(GLint minFilter) {
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::SetMagFilter(GLint magFilter) {
+	if (!IsOpenGLContextLoaded()) return;
 	glBindTexture(GL_TEXTURE_2D, m_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
 	glBindTexture(GL_TEXTURE_2D, 0);
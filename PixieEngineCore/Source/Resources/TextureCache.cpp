@@ -0,0 +1,257 @@
+#include "pch.h"
+#include "TextureCache.h"
+#include "Math/Hash.h"
+#include "stb_image.h"
+
+std::string to_string(TexelFormat format) {
+	switch (format) {
+	case TexelFormat::RGB8: return "RGB8";
+	case TexelFormat::RGB16F: return "RGB16F";
+	default: return "Undefined Texel Format";
+	}
+}
+
+CachedTexture::CachedTexture(const std::filesystem::path& path, uint64_t contentHash, glm::ivec2 resolution, TexelFormat format) :
+	m_path(path), m_contentHash(contentHash), m_resolution(resolution), m_format(format) {}
+
+const std::filesystem::path& CachedTexture::GetPath() const {
+	return m_path;
+}
+
+uint64_t CachedTexture::GetContentHash() const {
+	return m_contentHash;
+}
+
+glm::ivec2 CachedTexture::GetResolution() const {
+	return m_resolution;
+}
+
+TexelFormat CachedTexture::GetFormat() const {
+	return m_format;
+}
+
+bool CachedTexture::IsResident() const {
+	return m_pixels.load(std::memory_order_acquire) != nullptr;
+}
+
+Vec3 CachedTexture::Sample(Vec2 uv, Float width, TextureFilter filter) const {
+	std::shared_ptr<const Pixels> pixels = Acquire();
+	return std::visit([&](const auto& mipMap) { return mipMap.Filter(uv, width, filter); }, *pixels);
+}
+
+PinnedTexture CachedTexture::Pin() const {
+	return PinnedTexture(Acquire());
+}
+
+GLuint CachedTexture::GetTextureID() const {
+	if (!m_texture) {
+		std::shared_ptr<const Pixels> pixels = Acquire();
+		if (const LDRMIPMap* mipMap = std::get_if<LDRMIPMap>(pixels.get())) {
+			std::vector<glm::u8vec3> texels = mipMap->GetLevelTexels(0);
+			m_texture = std::make_unique<Texture>(mipMap->GetLevelResolution(0), GL_SRGB8, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+		}
+		else if (const HDRMIPMap* mipMap = std::get_if<HDRMIPMap>(pixels.get())) {
+			std::vector<glm::u16vec3> texels = mipMap->GetLevelTexels(0);
+			m_texture = std::make_unique<Texture>(mipMap->GetLevelResolution(0), GL_RGB16F, GL_RGB, GL_HALF_FLOAT, texels.data());
+		}
+	}
+	return m_texture->m_id;
+}
+
+void CachedTexture::Preload() const {
+	Acquire();
+}
+
+std::shared_ptr<const CachedTexture::Pixels> CachedTexture::Acquire() const {
+	uint64_t epoch = TextureCache::GetEpoch();
+	if (m_lastAccess.load(std::memory_order_relaxed) != epoch) {
+		m_lastAccess.store(epoch, std::memory_order_relaxed);
+	}
+	std::shared_ptr<const Pixels> pixels = m_pixels.load(std::memory_order_acquire);
+	if (pixels) {
+		m_hits.fetch_add(1, std::memory_order_relaxed);
+		return pixels;
+	}
+	std::lock_guard<std::mutex> lock(m_loadMutex);
+	pixels = m_pixels.load(std::memory_order_acquire);
+	if (pixels) {
+		m_hits.fetch_add(1, std::memory_order_relaxed);
+		return pixels;
+	}
+	m_misses.fetch_add(1, std::memory_order_relaxed);
+	pixels = Decode();
+	size_t bytes = std::visit([](const auto& mipMap) { return mipMap.GetSizeInBytes(); }, *pixels);
+	m_residentBytes.store(bytes, std::memory_order_relaxed);
+	m_pixels.store(pixels, std::memory_order_release);
+	TextureCache::OnTextureLoaded(this, bytes);
+	return pixels;
+}
+
+std::shared_ptr<const CachedTexture::Pixels> CachedTexture::Decode() const {
+	int32_t width, height, channels;
+	std::string path = m_path.string();
+	if (m_format == TexelFormat::RGB16F) {
+		float* data = stbi_loadf(path.c_str(), &width, &height, &channels, 3);
+		if (data) {
+			std::vector<glm::u16vec3> texels((size_t)width * height);
+			for (size_t i = 0; i < texels.size(); i++) {
+				texels[i] = TexelStorage<Vec3, glm::u16vec3>::Encode(Vec3(data[i * 3 + 0], data[i * 3 + 1], data[i * 3 + 2]));
+			}
+			stbi_image_free(data);
+			return std::make_shared<const Pixels>(std::in_place_type<HDRMIPMap>, glm::ivec2(width, height), texels.data());
+		}
+	}
+	else {
+		stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 3);
+		if (data) {
+			std::vector<glm::u8vec3> texels((size_t)width * height);
+			for (size_t i = 0; i < texels.size(); i++) {
+				texels[i] = glm::u8vec3(data[i * 3 + 0], data[i * 3 + 1], data[i * 3 + 2]);
+			}
+			stbi_image_free(data);
+			return std::make_shared<const Pixels>(std::in_place_type<LDRMIPMap>, glm::ivec2(width, height), texels.data());
+		}
+	}
+	std::cout << "  Error: Failed to decode texture: " << m_path << "\n";
+	return std::make_shared<const Pixels>(std::in_place_type<LDRMIPMap>, glm::ivec2(1), nullptr);
+}
+
+size_t CachedTexture::Release() const {
+	if (!m_pixels.exchange(nullptr, std::memory_order_acq_rel)) {
+		return 0;
+	}
+	return m_residentBytes.exchange(0, std::memory_order_relaxed);
+}
+
+PinnedTexture::PinnedTexture(std::shared_ptr<const CachedTexture::Pixels> pixels) :
+	m_pixels(std::move(pixels)) {}
+
+PinnedTexture::operator bool() const {
+	return m_pixels != nullptr;
+}
+
+Vec3 PinnedTexture::Sample(Vec2 uv, Float width, TextureFilter filter) const {
+	const CachedTexture::Pixels* pixels = m_pixels.get();
+	return std::visit([&](const auto& mipMap) { return mipMap.Filter(uv, width, filter); }, *pixels);
+}
+
+std::mutex TextureCache::m_mutex;
+std::map<std::filesystem::path, std::shared_ptr<CachedTexture>> TextureCache::m_texturesByPath = {};
+std::map<uint64_t, std::shared_ptr<CachedTexture>> TextureCache::m_texturesByHash = {};
+std::atomic<size_t> TextureCache::m_budget = (size_t)512 * 1024 * 1024;
+std::atomic<size_t> TextureCache::m_residentBytes = 0;
+std::atomic<uint64_t> TextureCache::m_epoch = 0;
+std::atomic<uint64_t> TextureCache::m_evictions = 0;
+
+std::shared_ptr<CachedTexture> TextureCache::Load(const std::filesystem::path& path) {
+	std::error_code error;
+	std::filesystem::path key = std::filesystem::weakly_canonical(path, error);
+	if (error) {
+		key = path;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto pathIt = m_texturesByPath.find(key);
+		if (pathIt != m_texturesByPath.end()) {
+			return pathIt->second;
+		}
+	}
+
+	// File is read and hashed without holding the lock, so several threads can load different textures at once.
+	std::cout << "  Loading texture: " << path << "\n";
+	std::ifstream file(key, std::ios::binary);
+	if (!file) {
+		std::cout << "  Error: Failed to load texture.\n";
+		return nullptr;
+	}
+	std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	uint64_t hash = MurmurHash64A(bytes.data(), bytes.size(), 0);
+	int32_t width, height, channels;
+	bool isSupported = stbi_info_from_memory(bytes.data(), (int32_t)bytes.size(), &width, &height, &channels);
+	bool isHDR = isSupported && stbi_is_hdr_from_memory(bytes.data(), (int32_t)bytes.size());
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// Another thread could load the same file in the meantime.
+	auto pathIt = m_texturesByPath.find(key);
+	if (pathIt != m_texturesByPath.end()) {
+		return pathIt->second;
+	}
+	auto hashIt = m_texturesByHash.find(hash);
+	if (hashIt != m_texturesByHash.end()) {
+		m_texturesByPath[key] = hashIt->second;
+		return hashIt->second;
+	}
+	if (!isSupported) {
+		std::cout << "  Error: Unsupported texture format.\n";
+		return nullptr;
+	}
+	TexelFormat format = isHDR ? TexelFormat::RGB16F : TexelFormat::RGB8;
+	std::shared_ptr<CachedTexture> texture = std::make_shared<CachedTexture>(key, hash, glm::ivec2(width, height), format);
+	m_texturesByPath[key] = texture;
+	m_texturesByHash[hash] = texture;
+	return texture;
+}
+
+size_t TextureCache::GetBudget() {
+	return m_budget;
+}
+
+void TextureCache::SetBudget(size_t bytes) {
+	m_budget = bytes;
+	EvictOverBudget(nullptr);
+}
+
+TextureCacheStats TextureCache::GetStats() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	TextureCacheStats stats;
+	for (const auto& [hash, texture] : m_texturesByHash) {
+		stats.hits += texture->m_hits.load(std::memory_order_relaxed);
+		stats.misses += texture->m_misses.load(std::memory_order_relaxed);
+		stats.residentTexturesCount += texture->IsResident() ? 1 : 0;
+	}
+	stats.evictions = m_evictions;
+	stats.texturesCount = (int32_t)m_texturesByHash.size();
+	stats.residentBytes = m_residentBytes;
+	stats.budgetBytes = m_budget;
+	return stats;
+}
+
+void TextureCache::ResetStats() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const auto& [hash, texture] : m_texturesByHash) {
+		texture->m_hits = 0;
+		texture->m_misses = 0;
+	}
+	m_evictions = 0;
+}
+
+uint64_t TextureCache::GetEpoch() {
+	return m_epoch.load(std::memory_order_relaxed);
+}
+
+void TextureCache::OnTextureLoaded(const CachedTexture* texture, size_t bytes) {
+	m_residentBytes += bytes;
+	m_epoch++;
+	EvictOverBudget(texture);
+}
+
+void TextureCache::EvictOverBudget(const CachedTexture* keep) {
+	// Texture load mutexes are never taken here, loading thread may already hold one while waiting for this lock.
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (m_residentBytes > m_budget) {
+		const CachedTexture* victim = nullptr;
+		for (const auto& [hash, texture] : m_texturesByHash) {
+			if (texture.get() == keep || !texture->IsResident()) {
+				continue;
+			}
+			if (!victim || texture->m_lastAccess.load(std::memory_order_relaxed) < victim->m_lastAccess.load(std::memory_order_relaxed)) {
+				victim = texture.get();
+			}
+		}
+		if (!victim) {
+			break;
+		}
+		m_residentBytes -= victim->Release();
+		m_evictions++;
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "pch.h"
+#include "Texture.h"
+#include "MIPMap.h"
+
+enum class TexelFormat : int32_t {
+	RGB8 = 0,
+	RGB16F,
+	COUNT
+};
+
+std::string to_string(TexelFormat format);
+
+class PinnedTexture;
+
+struct TextureCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	int32_t texturesCount = 0;
+	int32_t residentTexturesCount = 0;
+	size_t residentBytes = 0;
+	size_t budgetBytes = 0;
+};
+
+// Image file shared by all materials referencing it. Pixels are kept in format of the source file, 8 bit per channel
+// for LDR images and half floats for HDR ones, decoded on first access and released when cache goes over budget.
+class CachedTexture {
+public:
+	CachedTexture(const std::filesystem::path& path, uint64_t contentHash, glm::ivec2 resolution, TexelFormat format);
+
+	const std::filesystem::path& GetPath() const;
+	uint64_t GetContentHash() const;
+	glm::ivec2 GetResolution() const;
+	TexelFormat GetFormat() const;
+	bool IsResident() const;
+	// Filtered lookup, safe to call from render threads.
+	Vec3 Sample(Vec2 uv, Float width, TextureFilter filter = TextureFilter::Trilinear) const;
+	// Decodes pixels if needed and keeps them alive for as long as the returned handle, even when evicted from cache.
+	PinnedTexture Pin() const;
+	// Uploads pixels on first call, has to be called from thread owning OpenGL context.
+	GLuint GetTextureID() const;
+	// Decodes pixels ahead of first use, safe to call from any thread.
+	void Preload() const;
+
+protected:
+	using LDRMIPMap = MIPMap<Vec3, glm::u8vec3>;
+	using HDRMIPMap = MIPMap<Vec3, glm::u16vec3>;
+	using Pixels = std::variant<LDRMIPMap, HDRMIPMap>;
+
+	std::filesystem::path m_path;
+	uint64_t m_contentHash;
+	glm::ivec2 m_resolution;
+	TexelFormat m_format;
+	mutable std::atomic<std::shared_ptr<const Pixels>> m_pixels;
+	mutable std::atomic<size_t> m_residentBytes = 0;
+	mutable std::atomic<uint64_t> m_lastAccess = 0;
+	mutable std::atomic<uint64_t> m_hits = 0;
+	mutable std::atomic<uint64_t> m_misses = 0;
+	mutable std::mutex m_loadMutex;
+	mutable std::unique_ptr<Texture> m_texture;
+
+	std::shared_ptr<const Pixels> Acquire() const;
+	std::shared_ptr<const Pixels> Decode() const;
+	// Drops pixels, returns number of released bytes.
+	size_t Release() const;
+
+	friend class TextureCache;
+	friend class PinnedTexture;
+};
+
+// Resident pixels of a cached texture resolved once, so render threads sample them without touching shared counters
+// of the cache on every lookup.
+class PinnedTexture {
+public:
+	PinnedTexture() = default;
+
+	explicit operator bool() const;
+	Vec3 Sample(Vec2 uv, Float width, TextureFilter filter = TextureFilter::Trilinear) const;
+
+protected:
+	std::shared_ptr<const CachedTexture::Pixels> m_pixels;
+
+	PinnedTexture(std::shared_ptr<const CachedTexture::Pixels> pixels);
+
+	friend class CachedTexture;
+};
+
+// Deduplicates textures by path and by content hash, so identical files under different names are decoded once.
+// Resident pixels are kept under a byte budget, least recently used textures are released first.
+class TextureCache {
+public:
+	static std::shared_ptr<CachedTexture> Load(const std::filesystem::path& path);
+	static size_t GetBudget();
+	static void SetBudget(size_t bytes);
+	static TextureCacheStats GetStats();
+	static void ResetStats();
+
+protected:
+	static std::mutex m_mutex;
+	static std::map<std::filesystem::path, std::shared_ptr<CachedTexture>> m_texturesByPath;
+	static std::map<uint64_t, std::shared_ptr<CachedTexture>> m_texturesByHash;
+	static std::atomic<size_t> m_budget;
+	static std::atomic<size_t> m_residentBytes;
+	// Advanced on every load, textures remember epoch of their last access to approximate LRU order without
+	// writing shared state on every lookup.
+	static std::atomic<uint64_t> m_epoch;
+	static std::atomic<uint64_t> m_evictions;
+
+	static uint64_t GetEpoch();
+	static void OnTextureLoaded(const CachedTexture* texture, size_t bytes);
+	static void EvictOverBudget(const CachedTexture* keep);
+
+	friend class CachedTexture;
+};
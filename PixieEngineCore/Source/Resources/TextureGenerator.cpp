@@ -11,6 +11,9 @@ Texture TextureGenerator::SSAONoiseTexture(glm::ivec2 resolution) {
 }
 
 Texture TextureGenerator::CreateCubemap(glm::ivec2 resolution, GLint internalFormat, GLenum format, GLenum type) {
+	if (!IsOpenGLContextLoaded()) {
+		return Texture(resolution, 0);
+	}
 	GLuint cubemap;
 	glGenTextures(1, &cubemap);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
@@ -29,7 +32,9 @@ HDRISkybox TextureGenerator::Skybox(Buffer2DTexture<Vec3>& equirectangularTextur
 	Texture envCubemap = TextureGenerator::CreateCubemap(resolution);
 	Texture irradianceMap = TextureGenerator::CreateCubemap(irradianceResolution);
 	Texture prefilterMap = TextureGenerator::CreateCubemap(prefilterResoution);
-	GlobalRenderer::DrawCubeMap(equirectangularTexture.GetID(), resolution, envCubemap.m_id, irradianceResolution, irradianceMap.m_id, prefilterResoution, prefilterMap.m_id);
+	if (IsOpenGLContextLoaded()) {
+		GlobalRenderer::DrawCubeMap(equirectangularTexture.GetID(), resolution, envCubemap.m_id, irradianceResolution, irradianceMap.m_id, prefilterResoution, prefilterMap.m_id);
+	}
 	return HDRISkybox(equirectangularTexture, envCubemap, irradianceMap, prefilterMap);
 }
 
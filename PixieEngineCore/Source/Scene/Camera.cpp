@@ -20,7 +20,9 @@ Ray Camera::GetRay(const Vec2& coord) const {
 	Float theta = Lerp(coord.x, -(m_fovy * m_aspect) / 2, (m_fovy * m_aspect) / 2);
 	Float phi = Lerp(coord.y, -m_fovy / 2, m_fovy / 2);
 	Vec3 dir = glm::normalize(glm::mat3(m_transform.GetMatrix()) * Vec3(glm::tan(theta), glm::tan(phi), -1.0f));
-	return Ray(m_transform.GetPosition(), dir);
+	Ray ray(m_transform.GetPosition(), dir);
+	ray.coneSpread = m_fovy / m_resolution.y;
+	return ray;
 }
 
 Float Camera::GetFieldOfViewY() const {
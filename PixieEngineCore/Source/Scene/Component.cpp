@@ -13,3 +13,5 @@ void Component::OnStart() {}
 void Component::OnUpdate() {}
 
 void Component::OnFixedUpdate() {}
+
+void Component::OnLateUpdate() {}
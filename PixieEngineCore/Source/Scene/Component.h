@@ -17,11 +17,16 @@ public:
 	virtual void OnStart();
 	virtual void OnUpdate();
 	virtual void OnFixedUpdate();
+	// Called on main thread after updates of all components, which may run on worker threads. OpenGL resources are
+	// updated here.
+	virtual void OnLateUpdate();
 
 protected:
 	Component(ComponentType type, SceneObject* parent);
 
 	SceneObject* m_parent;
+	int32_t m_storageIndex = -1; // slot in ComponentStorage of the scene
 
 	friend class SceneManager;
+	friend class ComponentStorage;
 };
@@ -0,0 +1,28 @@
+#include "pch.h"
+#include "ComponentStorage.h"
+
+void ComponentStorage::Add(Component* component) {
+	std::vector<Component*>& components = m_components[(size_t)component->type];
+	component->m_storageIndex = (int32_t)components.size();
+	components.push_back(component);
+}
+
+void ComponentStorage::Remove(Component* component) {
+	std::vector<Component*>& components = m_components[(size_t)component->type];
+	int32_t index = component->m_storageIndex;
+	if (index < 0 || (size_t)index >= components.size() || components[index] != component) {
+		return;
+	}
+	components[index] = components.back();
+	components[index]->m_storageIndex = index;
+	components.pop_back();
+	component->m_storageIndex = -1;
+}
+
+const std::vector<Component*>& ComponentStorage::Get(ComponentType type) const {
+	return m_components[(size_t)type];
+}
+
+size_t ComponentStorage::GetCount(ComponentType type) const {
+	return m_components[(size_t)type].size();
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "pch.h"
+#include "Component.h"
+#include "SceneObject.h"
+
+// Typed read only view of a dense component array, valid until components of the type are added or removed.
+template<typename T>
+class ComponentView {
+public:
+	class Iterator {
+	public:
+		Iterator(Component* const* component) :
+			m_component(component) {}
+
+		T* operator*() const { return static_cast<T*>(*m_component); }
+		Iterator& operator++() { m_component++; return *this; }
+		bool operator!=(const Iterator& other) const { return m_component != other.m_component; }
+
+	protected:
+		Component* const* m_component;
+	};
+
+	ComponentView(const std::vector<Component*>& components) :
+		m_components(components) {}
+
+	size_t size() const { return m_components.size(); }
+	bool empty() const { return m_components.empty(); }
+	T* operator[](size_t index) const { return static_cast<T*>(m_components[index]); }
+	Iterator begin() const { return Iterator(m_components.data()); }
+	Iterator end() const { return Iterator(m_components.data() + m_components.size()); }
+
+protected:
+	const std::vector<Component*>& m_components;
+};
+
+// Components of a scene grouped by type in dense arrays. Removal moves the last component of the type into the freed
+// slot and every component remembers its slot, so adding and removing is constant time and iteration is linear.
+// Components themselves stay where they were allocated, so pointers to them remain valid handles.
+class ComponentStorage {
+public:
+	void Add(Component* component);
+	void Remove(Component* component);
+	const std::vector<Component*>& Get(ComponentType type) const;
+	size_t GetCount(ComponentType type) const;
+
+	template<typename T>
+	ComponentView<T> Get() const {
+		return ComponentView<T>(Get(T::c_type));
+	}
+
+	// Calls function(object, components...) once for every object having components of all given types. Walks the
+	// shortest of their arrays and checks the remaining types with constant time lookups on the object.
+	template<typename... T, typename Function>
+	void ForEach(Function function) const {
+		const ComponentType types[] = { T::c_type... };
+		ComponentType shortest = types[0];
+		for (ComponentType type : types) {
+			if (GetCount(type) < GetCount(shortest)) {
+				shortest = type;
+			}
+		}
+		for (Component* component : Get(shortest)) {
+			SceneObject* object = component->GetParent();
+			// Objects with several components of the type are visited for the first one only.
+			if (object->GetComponent(shortest) != component) {
+				continue;
+			}
+			if ((object->GetComponent(T::c_type) && ...)) {
+				function(object, object->template GetComponent<T>()...);
+			}
+		}
+	}
+
+protected:
+	std::array<std::vector<Component*>, (size_t)ComponentType::COUNT> m_components;
+};
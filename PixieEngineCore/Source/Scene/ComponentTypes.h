@@ -12,6 +12,7 @@ enum class ComponentType {
 	DiffuseAreaLight,
 	MeshAnimator,
 	Sphere,
+	COUNT
 };
 
 constexpr inline std::string to_string(ComponentType type) {
@@ -29,3 +30,41 @@ constexpr inline std::string to_string(ComponentType type) {
 	default: return "Undefined Component";
 	}
 };
+
+// Scene data touched by component updates. Update batches of two types run concurrently unless one of them writes
+// data the other reads or writes.
+enum ComponentAccess : uint32_t {
+	ComponentAccessNone = 0,
+	ComponentAccessLocalTransforms = 1 << 0,
+	ComponentAccessMeshVertices = 1 << 1,
+	ComponentAccessAnimationState = 1 << 2,
+	ComponentAccessAll = 0xffffffff,
+};
+
+// How updates of a component type are scheduled. Instances of parallel types touch only their own state within the
+// declared data, so one batch is split into jobs over instances.
+struct ComponentUpdateInfo {
+	bool hasUpdate = true;
+	bool isParallel = false;
+	uint32_t reads = ComponentAccessAll;
+	uint32_t writes = ComponentAccessAll;
+};
+
+// Types not listed here are updated serially and conflict with every other batch, so new components overriding
+// OnUpdate are always called safely. Types known to have no updates opt out.
+constexpr inline ComponentUpdateInfo GetUpdateInfo(ComponentType type) {
+	switch (type) {
+	case ComponentType::Material:
+	case ComponentType::Mesh:
+	case ComponentType::Camera:
+	case ComponentType::PointLight:
+	case ComponentType::DirectionalLight:
+	case ComponentType::DiffuseAreaLight:
+	case ComponentType::Sphere:
+		return { false, false, ComponentAccessNone, ComponentAccessNone };
+	// Softbodies can share a mesh, so their instances are updated one after another.
+	case ComponentType::Softbody: return { true, false, ComponentAccessNone, ComponentAccessMeshVertices };
+	case ComponentType::MeshAnimator: return { true, true, ComponentAccessLocalTransforms, ComponentAccessAnimationState };
+	default: return {};
+	}
+};
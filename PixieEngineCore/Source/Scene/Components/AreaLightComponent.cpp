@@ -2,7 +2,7 @@
 #include "AreaLightComponent.h"
 
 AreaLightComponent::AreaLightComponent(SceneObject* parent, Vec3 color, Float strength) :
-	Component(ComponentType::DiffuseAreaLight, parent), m_color(color), m_strength(strength) {}
+	Component(c_type, parent), m_color(color), m_strength(strength) {}
 
 void AreaLightComponent::OnStart() {
 	if (MeshComponent* meshComponent = m_parent->GetComponent<MeshComponent>()) {
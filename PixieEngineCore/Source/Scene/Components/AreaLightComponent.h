@@ -4,6 +4,8 @@
 
 class AreaLightComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::DiffuseAreaLight;
+
 public:
 	AreaLightComponent(SceneObject* parent, Vec3 color, Float strength);
 
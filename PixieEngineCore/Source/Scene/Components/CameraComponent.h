@@ -4,6 +4,8 @@
 
 class CameraComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::Camera;
+
 	CameraComponent(SceneObject* parent, glm::ivec2 resolution, Float fovy, Float near, Float far);
 
 	Camera& GetCamera();
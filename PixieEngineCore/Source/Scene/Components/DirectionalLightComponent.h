@@ -4,6 +4,8 @@
 
 class DirectionalLightComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::DirectionalLight;
+
 	DirectionalLightComponent(SceneObject* parent, Vec3 direction, Vec3 color, Float strength);
 
 	Vec3 GetDirection();
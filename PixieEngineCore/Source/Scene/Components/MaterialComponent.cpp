@@ -2,7 +2,7 @@
 #include "MaterialComponent.h"
 
 MaterialComponent::MaterialComponent(SceneObject* parent, Material* material) :
-	Component(ComponentType::Material, parent), m_material(material) {}
+	Component(c_type, parent), m_material(material) {}
 
 Material* MaterialComponent::GetMaterial() {
 	return m_material;
@@ -6,6 +6,8 @@ class SceneObject;
 
 class MaterialComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::Material;
+
 	MaterialComponent(SceneObject* parent, Material* material);
 
 	Material* GetMaterial();
@@ -2,7 +2,7 @@
 #include "MeshAnimatorComponent.h"
 
 MeshAnimatorComponent::MeshAnimatorComponent(SceneObject* parent, const std::vector<Animation*>& animations, Mat4 globalInverseTransform) :
-	Component(ComponentType::MeshAnimator, parent), m_animations(animations), m_animator(nullptr) {
+	Component(c_type, parent), m_animations(animations), m_animator(nullptr) {
 	if (animations.size() > 0) {
 		m_animator = new Animator(animations[0], globalInverseTransform);
 	}
@@ -7,6 +7,8 @@
 
 class MeshAnimatorComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::MeshAnimator;
+
 	MeshAnimatorComponent(SceneObject* parent, const std::vector<Animation*>& animations, Mat4 globalInverseTransform);
 	~MeshAnimatorComponent();
 
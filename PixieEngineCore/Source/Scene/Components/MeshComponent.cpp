@@ -3,8 +3,11 @@
 #include "GlobalRenderer.h"
 
 MeshComponent::MeshComponent(SceneObject* parent, Mesh* mesh) :
-	Component(ComponentType::Mesh, parent), m_mesh(mesh) {
-	UploadMesh();
+	Component(c_type, parent), m_mesh(mesh) {
+	// Mesh shared by several components is uploaded only once.
+	if (!m_mesh->m_vao) {
+		UploadMesh();
+	}
 }
 
 const Mesh* MeshComponent::GetMesh() const {
@@ -5,6 +5,8 @@
 
 class MeshComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::Mesh;
+
 	MeshComponent(SceneObject* parent, Mesh* mesh);
 
 	const Mesh* GetMesh() const;
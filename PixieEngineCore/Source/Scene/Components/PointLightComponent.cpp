@@ -2,7 +2,7 @@
 #include "PointLightComponent.h"
 
 PointLightComponent::PointLightComponent(SceneObject* parent, Vec3 color, Float strength) :
-	Component(ComponentType::PointLight, parent), m_color(color), m_strength(strength) {}
+	Component(c_type, parent), m_color(color), m_strength(strength) {}
 
 Vec3 PointLightComponent::GetEmission() {
 	return m_color * m_strength;
@@ -4,6 +4,8 @@
 
 class PointLightComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::PointLight;
+
 	PointLightComponent(SceneObject* parent, Vec3 color, Float strength);
 
 	Vec3 GetEmission();
@@ -2,7 +2,7 @@
 #include "SoftbodyComponent.h"
 
 SoftbodyComponent::SoftbodyComponent(SceneObject* parent) :
-	Component(ComponentType::Softbody, parent) {}
+	Component(c_type, parent) {}
 
 void SoftbodyComponent::OnStart() {
 	m_mesh = m_parent->GetComponent<MeshComponent>()->GetMesh();
@@ -91,6 +91,13 @@ void SoftbodyComponent::OnUpdate() {
 	UpdateMesh();
 }
 
+void SoftbodyComponent::OnLateUpdate() {
+	if (m_meshChanged) {
+		m_mesh->Upload();
+		m_meshChanged = false;
+	}
+}
+
 void SoftbodyComponent::SetForcesToGravity() {
 	for (size_t i = 0; i < m_forces.size(); i++) {
 		m_forces[i] = m_gravity;
@@ -109,5 +116,5 @@ void SoftbodyComponent::UpdateMesh() {
 	for (size_t i = 0; i < m_positions.size(); i++) {
 		m_mesh->m_vertices[i].position = m_positions[i];
 	}
-	m_mesh->Upload();
+	m_meshChanged = true;
 }
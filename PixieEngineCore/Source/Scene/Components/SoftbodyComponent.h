@@ -6,10 +6,13 @@
 
 class SoftbodyComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::Softbody;
+
 	SoftbodyComponent(SceneObject* parent);
 
 	void OnStart() override;
 	void OnUpdate() override;
+	void OnLateUpdate() override;
 
 protected:
 	const int32_t m_stepsPerSecond = 256;
@@ -17,6 +20,7 @@ protected:
 	const glm::fvec3 m_gravity = glm::fvec3(0.0f, -9.81f, 0.0f);
 	float m_timeAligner = 0.0f;
 	Mesh* m_mesh = nullptr;
+	bool m_meshChanged = false;
 	std::vector<glm::fvec3> m_positions;
 	std::vector<glm::fvec3> m_lastPositions;
 	std::vector<glm::fvec3> m_forces;
@@ -3,7 +3,7 @@
 #include "GlobalRenderer.h"
 
 SphereComponent::SphereComponent(SceneObject* parent, Float radius) :
-	Component(ComponentType::Sphere, parent), m_radius(radius) {}
+	Component(c_type, parent), m_radius(radius) {}
 
 void SphereComponent::Draw() const {
 	GlobalRenderer::DrawMesh(ResourceManager::GetSphereMesh());
@@ -4,6 +4,8 @@
 
 class SphereComponent : public Component {
 public:
+	static constexpr ComponentType c_type = ComponentType::Sphere;
+
 	SphereComponent(SceneObject* parent, Float radius);
 
 	void Draw() const;
@@ -1,10 +1,14 @@
 #include "pch.h"
 #include "Scene.h"
 #include "ResourceManager.h"
+#include "JobSystem.h"
+#include "EngineTime.h"
+
+static std::atomic<uint64_t> skyboxVersionCounter = 0;
 
 Scene::Scene(const std::string& name) :
 	m_name(name) {
-	m_skybox = ResourceManager::LoadSkybox("kloppenheim_01_puresky_4k.hdr");
+	SetSkybox(ResourceManager::LoadSkybox("kloppenheim_01_puresky_4k.hdr"));
 }
 
 Scene::~Scene() {
@@ -28,31 +32,46 @@ std::vector<SceneObject*> Scene::FindObjects(const std::string& objectName) cons
 }
 
 SceneObject* Scene::FindObjectWithComponent(ComponentType type) const {
-	return m_rootObject->FindObjectWithComponent(type);
+	const std::vector<Component*>& components = m_components.Get(type);
+	return components.empty() ? nullptr : components[0]->GetParent();
 }
 
 std::vector<SceneObject*> Scene::FindObjectsWithComponent(ComponentType type) const  {
-	return m_rootObject->FindObjectsWithComponent(type);
+	std::vector<SceneObject*> objects;
+	for (Component* component : m_components.Get(type)) {
+		if (component->GetParent()->GetComponent(type) == component) {
+			objects.push_back(component->GetParent());
+		}
+	}
+	return objects;
 }
 
 SceneObject* Scene::GetRootObject() const {
 	return m_rootObject;
 }
 
-const std::vector<AreaLightComponent*>& Scene::GetAreaLights() const {
-	return m_areaLights;
+const ComponentStorage& Scene::GetComponents() const {
+	return m_components;
+}
+
+const TransformHierarchy& Scene::GetTransformHierarchy() const {
+	return m_transforms;
+}
+
+ComponentView<AreaLightComponent> Scene::GetAreaLights() const {
+	return m_components.Get<AreaLightComponent>();
 }
 
-const std::vector<DirectionalLightComponent*>& Scene::GetDirectionalLights() const {
-	return m_directionalLights;
+ComponentView<DirectionalLightComponent> Scene::GetDirectionalLights() const {
+	return m_components.Get<DirectionalLightComponent>();
 }
 
-const std::vector<PointLightComponent*>& Scene::GetPointLights() const {
-	return m_pointLights;
+ComponentView<PointLightComponent> Scene::GetPointLights() const {
+	return m_components.Get<PointLightComponent>();
 }
 
-const std::vector<CameraComponent*>& Scene::GetCameras() const {
-	return m_cameras;
+ComponentView<CameraComponent> Scene::GetCameras() const {
+	return m_components.Get<CameraComponent>();
 }
 
 Bounds3f Scene::GetBounds() const {
@@ -60,11 +79,55 @@ Bounds3f Scene::GetBounds() const {
 }
 
 void Scene::SetSkybox(const HDRISkybox& skybox) {
+	SetSkybox(std::make_shared<const HDRISkybox>(skybox));
+}
+
+void Scene::SetSkybox(std::shared_ptr<const HDRISkybox> skybox) {
+	m_pendingSkybox.reset();
 	m_skybox = skybox;
+	m_skyboxVersion = ++skyboxVersionCounter;
+}
+
+void Scene::SetSkybox(std::shared_ptr<SharedSkybox> skybox) {
+	if (skybox->IsReady()) {
+		SetSkybox(skybox->Get());
+		return;
+	}
+	if (!m_skybox) {
+		SetSkybox(SkyboxRegistry::GetPlaceholder());
+	}
+	m_pendingSkybox = skybox;
+}
+
+bool Scene::UpdateSkybox() {
+	if (!m_pendingSkybox) {
+		return false;
+	}
+	if (m_pendingSkybox->IsFailed()) {
+		m_pendingSkybox.reset();
+		return false;
+	}
+	if (!m_pendingSkybox->IsReady()) {
+		return false;
+	}
+	SetSkybox(m_pendingSkybox->Get());
+	return true;
+}
+
+void Scene::WaitForSkybox() {
+	if (m_pendingSkybox) {
+		SkyboxRegistry::Wait(*m_pendingSkybox);
+		UpdateSkybox();
+	}
+}
+
+uint64_t Scene::GetSkyboxVersion() const {
+	return m_skyboxVersion;
 }
 
 const HDRISkybox& Scene::GetSkybox() const {
-	return m_skybox;
+	static const HDRISkybox emptySkybox;
+	return m_skybox ? *m_skybox : emptySkybox;
 }
 
 void Scene::Start() {
@@ -72,9 +135,72 @@ void Scene::Start() {
 }
 
 void Scene::Update() {
-	m_rootObject->OnUpdate();
+	RunComponentUpdates(&Component::OnUpdate, "Update");
 }
 
 void Scene::FixedUpdate() {
-	m_rootObject->OnFixedUpdate();
+	RunComponentUpdates(&Component::OnFixedUpdate, "Fixed Update");
+}
+
+void Scene::UpdateTransforms() {
+	m_transforms.Update(m_rootObject);
+}
+
+void Scene::RunComponentUpdates(void (Component::*update)(), const std::string& name) {
+	struct Batch {
+		ComponentType type;
+		ComponentUpdateInfo info;
+		std::vector<int32_t> jobs;
+	};
+
+	HighPrecisionTimer::StartTimer("Scene " + name);
+	JobGraph graph;
+	std::vector<Batch> batches;
+	for (int32_t i = 0; i < (int32_t)ComponentType::COUNT; i++) {
+		ComponentType type = (ComponentType)i;
+		ComponentUpdateInfo info = GetUpdateInfo(type);
+		const std::vector<Component*>& components = m_components.Get(type);
+		if (!info.hasUpdate || components.empty()) {
+			continue;
+		}
+
+		// Conflicting batches run in order of component types, independent ones run concurrently.
+		std::vector<int32_t> dependencies;
+		for (const Batch& batch : batches) {
+			if ((batch.info.writes & (info.reads | info.writes)) || (batch.info.reads & info.writes)) {
+				dependencies.insert(dependencies.end(), batch.jobs.begin(), batch.jobs.end());
+			}
+		}
+
+		batches.push_back({ type, info });
+		Batch& batch = batches.back();
+		size_t jobsCount = info.isParallel ? (components.size() + c_componentsPerJob - 1) / c_componentsPerJob : 1;
+		for (size_t j = 0; j < jobsCount; j++) {
+			size_t start = components.size() * j / jobsCount;
+			size_t end = components.size() * (j + 1) / jobsCount;
+			batch.jobs.push_back(graph.Add(to_string(type), [&components, start, end, update]() {
+				for (size_t k = start; k < end; k++) {
+					(components[k]->*update)();
+				}
+			}, dependencies));
+		}
+	}
+
+	JobSystem::Run(graph);
+
+	for (const Batch& batch : batches) {
+		std::chrono::steady_clock::time_point start = graph.GetJob(batch.jobs[0]).start;
+		std::chrono::steady_clock::time_point end = graph.GetJob(batch.jobs[0]).end;
+		for (int32_t job : batch.jobs) {
+			start = std::min(start, graph.GetJob(job).start);
+			end = std::max(end, graph.GetJob(job).end);
+		}
+		HighPrecisionTimer::RecordTimer(name + " " + to_string(batch.type), start, end);
+	}
+	for (const Batch& batch : batches) {
+		for (Component* component : m_components.Get(batch.type)) {
+			component->OnLateUpdate();
+		}
+	}
+	HighPrecisionTimer::StopTimer("Scene " + name);
 }
@@ -2,8 +2,11 @@
 #include "UID.h"
 #include "Math/Transform.h"
 #include "SceneObject.h"
+#include "ComponentStorage.h"
+#include "TransformHierarchy.h"
 #include "Camera.h"
 #include "Skyboxes.h"
+#include "Resources/SkyboxRegistry.h"
 #include "Scene/Components/Components.h"
 
 class Scene {
@@ -17,6 +20,8 @@ public:
 	void Start();
 	void Update();
 	void FixedUpdate();
+	// Recomputes world transforms changed since the last call.
+	void UpdateTransforms();
 
 	const std::string& GetName() const;
 	void SetName(const std::string& name);
@@ -24,24 +29,40 @@ public:
 	Bounds3f GetBounds() const;
 	const HDRISkybox& GetSkybox() const;
 	void SetSkybox(const HDRISkybox& skybox);
+	void SetSkybox(std::shared_ptr<const HDRISkybox> skybox);
+	// Placeholder sky is shown until the shared skybox is loaded.
+	void SetSkybox(std::shared_ptr<SharedSkybox> skybox);
+	// Switches to the requested skybox once it's loaded, returns true when skybox changed.
+	bool UpdateSkybox();
+	// Blocks until the requested skybox is loaded and switches to it.
+	void WaitForSkybox();
+	uint64_t GetSkyboxVersion() const;
 
 	SceneObject* FindObject(const std::string& objectName) const;
 	std::vector<SceneObject*> FindObjects(const std::string& objectName) const;
 	SceneObject* FindObjectWithComponent(ComponentType type) const;
 	std::vector<SceneObject*> FindObjectsWithComponent(ComponentType type) const;
-	const std::vector<AreaLightComponent*>& GetAreaLights() const;
-	const std::vector<DirectionalLightComponent*>& GetDirectionalLights() const;
-	const std::vector<PointLightComponent*>& GetPointLights() const;
-	const std::vector<CameraComponent*>& GetCameras() const;
+	const ComponentStorage& GetComponents() const;
+	const TransformHierarchy& GetTransformHierarchy() const;
+	ComponentView<AreaLightComponent> GetAreaLights() const;
+	ComponentView<DirectionalLightComponent> GetDirectionalLights() const;
+	ComponentView<PointLightComponent> GetPointLights() const;
+	ComponentView<CameraComponent> GetCameras() const;
 
 protected:
 	std::string m_name = "New Scene";
+	static constexpr size_t c_componentsPerJob = 16;
+
 	SceneObject* m_rootObject = new SceneObject("root");
-	std::vector<CameraComponent*> m_cameras;
-	std::vector<DirectionalLightComponent*> m_directionalLights;
-	std::vector<PointLightComponent*> m_pointLights;
-	std::vector<AreaLightComponent*> m_areaLights;
-	HDRISkybox m_skybox;
+	ComponentStorage m_components;
+	TransformHierarchy m_transforms;
+	std::shared_ptr<const HDRISkybox> m_skybox;
+	std::shared_ptr<SharedSkybox> m_pendingSkybox;
+	uint64_t m_skyboxVersion = 0;
+
+	// Runs update of every component as jobs grouped by component type, see GetUpdateInfo. Components must not be
+	// added or removed by updates.
+	void RunComponentUpdates(void (Component::*update)(), const std::string& name);
 
 	friend class SceneManager;
 };
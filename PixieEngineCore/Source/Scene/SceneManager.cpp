@@ -6,6 +6,7 @@ std::shared_ptr<Scene> SceneManager::m_currentScene = nullptr;
 std::shared_ptr<Scene> SceneManager::m_virtualScene = nullptr;
 std::shared_ptr<Scene> SceneManager::m_activeScene = nullptr;
 std::shared_ptr<SceneSnapshot> SceneManager::m_sceneSnapshot = nullptr;
+BVHBuildMethod SceneManager::m_bvhBuildMethod = BVHBuildMethod::SAH;
 SceneObject* SceneManager::m_selectedObject = nullptr;
 bool SceneManager::m_playing = false;
 bool SceneManager::m_paused = false;
@@ -31,9 +32,9 @@ void SceneManager::LoadScene(const std::filesystem::path& filePath) {
 	}
 }
 
-void SceneManager::LoadModel(const std::filesystem::path& filePath) {
-	if (!m_activeScene) return;
-	SceneObject* object = ResourceManager::LoadModel(filePath);
+std::shared_ptr<ModelImport> SceneManager::LoadModel(const std::filesystem::path& filePath) {
+	if (!m_activeScene) return nullptr;
+	return ResourceManager::LoadModelAsync(filePath);
 }
 
 void SceneManager::ReloadScene() {
@@ -65,8 +66,18 @@ void SceneManager::Stop() {
 }
 
 void SceneManager::Update() {
-	if (!m_playing || m_paused) return;
-	m_activeScene->Update();
+	SkyboxRegistry::Update();
+	if (!m_activeScene) return;
+	bool isSkyboxChanged = m_activeScene->UpdateSkybox();
+	bool isModelAdded = ResourceManager::UpdateModelImports();
+	if (isSkyboxChanged || isModelAdded) {
+		UpdateSceneSnapshot();
+	}
+	if (m_playing && !m_paused) {
+		m_activeScene->Update();
+	}
+	// Transforms are edited in the editor while the scene is not playing as well.
+	m_activeScene->UpdateTransforms();
 }
 
 void SceneManager::FixedUpdate() {
@@ -85,7 +96,11 @@ SceneObject* SceneManager::CreateObject(const std::string& name, SceneObject* pa
 	if (!parent) parent = m_activeScene->m_rootObject;
 	SceneObject* object = new SceneObject(name, transform);
 	object->m_parent = parent;
+	object->m_hierarchy = parent->m_hierarchy;
 	parent->m_children.push_back(object);
+	if (object->m_hierarchy) {
+		object->m_hierarchy->SetStructureDirty();
+	}
 	return object;
 }
 
@@ -100,7 +115,8 @@ void SceneManager::RemoveObjects(const std::string& objectName) {
 }
 
 void SceneManager::RemoveObject(const SceneObject* object) {
-	if (object == m_currentScene->m_rootObject || object == m_virtualScene->m_rootObject) return;
+	if (!object) return;
+	if ((m_currentScene && object == m_currentScene->m_rootObject) || (m_virtualScene && object == m_virtualScene->m_rootObject)) return;
 	if (object->m_parent) {
 		for (int32_t i = 0; i < object->m_parent->m_children.size(); i++) {
 			if (object->m_parent->m_children[i] == object) {
@@ -109,7 +125,26 @@ void SceneManager::RemoveObject(const SceneObject* object) {
 			}
 		}
 	}
-	delete object;
+	if (object->m_hierarchy) {
+		object->m_hierarchy->SetStructureDirty();
+	}
+	// Components of the whole subtree leave scene storage before their objects are deleted.
+	std::queue<const SceneObject*> objectsList;
+	objectsList.push(object);
+	while (objectsList.size() > 0) {
+		const SceneObject* obj = objectsList.front();
+		objectsList.pop();
+		for (size_t i = 0; i < obj->m_children.size(); i++) {
+			objectsList.push(obj->m_children[i]);
+		}
+		while (obj->m_components.size() > 0) {
+			RemoveComponent(obj->m_components.back());
+		}
+		if (obj == m_selectedObject) {
+			m_selectedObject = nullptr;
+		}
+		delete obj;
+	}
 }
 
 void SceneManager::RemoveObjects(const std::vector<SceneObject*>& objects) {
@@ -130,6 +165,12 @@ void SceneManager::SetObjectParent(SceneObject* object, SceneObject* parent) {
 	}
 	object->m_parent = parent;
 	parent->m_children.push_back(object);
+	if (object->m_hierarchy) {
+		object->m_hierarchy->SetStructureDirty();
+	}
+	if (parent->m_hierarchy) {
+		parent->m_hierarchy->SetStructureDirty();
+	}
 }
 
 SceneObject* SceneManager::FindObject(const std::string& objectName) {
@@ -150,33 +191,8 @@ std::vector<SceneObject*> SceneManager::FindObjectsWithComponent(ComponentType t
 
 void SceneManager::RemoveComponent(Component* component) {
 	if (!component || !component->m_parent) return;
-	if (component->type == ComponentType::PointLight) {
-		for (size_t i = 0; i < m_activeScene->m_pointLights.size(); i++) {
-			if (m_activeScene->m_pointLights[i] == component) {
-				m_activeScene->m_pointLights.erase(m_activeScene->m_pointLights.begin() + i);
-			}
-		}
-	}
-	else if (component->type == ComponentType::DiffuseAreaLight) {
-		for (size_t i = 0; i < m_activeScene->m_areaLights.size(); i++) {
-			if (m_activeScene->m_areaLights[i] == component) {
-				m_activeScene->m_areaLights.erase(m_activeScene->m_areaLights.begin() + i);
-			}
-		}
-	}
-	else if (component->type == ComponentType::DirectionalLight) {
-		for (size_t i = 0; i < m_activeScene->m_directionalLights.size(); i++) {
-			if (m_activeScene->m_directionalLights[i] == component) {
-				m_activeScene->m_directionalLights.erase(m_activeScene->m_directionalLights.begin() + i);
-			}
-		}
-	}
-	for (int32_t i = 0; i < component->m_parent->m_components.size(); i++) {
-		if (component->m_parent->m_components[i] == component) {
-			component->m_parent->m_components.erase(component->m_parent->m_components.begin() + i);
-			break;
-		}
-	}
+	m_activeScene->m_components.Remove(component);
+	component->m_parent->RemoveComponent(component);
 	delete component;
 }
 
@@ -198,33 +214,22 @@ void SceneManager::SetSelectedObject(SceneObject* object) {
 
 void SceneManager::UpdateSceneSnapshot() {
 	if (!m_activeScene) return;
-	m_sceneSnapshot = std::make_shared<SceneSnapshot>(m_activeScene.get());
+	m_sceneSnapshot = std::make_shared<SceneSnapshot>(m_activeScene.get(), m_bvhBuildMethod, m_sceneSnapshot.get());
+}
+
+BVHBuildMethod SceneManager::GetBVHBuildMethod() {
+	return m_bvhBuildMethod;
+}
+
+void SceneManager::SetBVHBuildMethod(BVHBuildMethod method) {
+	if (m_bvhBuildMethod == method) return;
+	m_bvhBuildMethod = method;
+	UpdateSceneSnapshot();
 }
 
 void SceneManager::RemoveSelectedObject() {
 	if (!m_selectedObject || !m_activeScene || m_selectedObject == m_activeScene->GetRootObject()) {
 		return;
 	}
-	for (size_t i = 0; i < m_selectedObject->m_parent->m_children.size(); i++) {
-		if (m_selectedObject->m_parent->m_children[i] == m_selectedObject) {
-			m_selectedObject->m_parent->m_children.erase(m_selectedObject->m_parent->m_children.begin() + i);
-			break;
-		}
-	}
-	std::queue<SceneObject*> objectsList;
-	objectsList.push(m_selectedObject);
-	m_selectedObject = nullptr;
-	while (objectsList.size() > 0) {
-		SceneObject* obj = objectsList.front();
-		objectsList.pop();
-		for (size_t i = 0; i < obj->m_children.size(); i++) {
-			objectsList.push(obj->m_children[i]);
-		}
-		while (obj->m_components.size() > 0) {
-			RemoveComponent(obj->m_components.back());
-		}
-		delete obj;
-	}
+	RemoveObject(m_selectedObject);
 }
-
-
@@ -2,12 +2,14 @@
 #include "pch.h"
 #include "Scene.h"
 #include "SceneSnapshot.h"
+#include "Resources/ModelImport.h"
 
 class SceneManager {
 public:
 	static void Initialize();
 	static void LoadScene(const std::filesystem::path& filePath);
-	static void LoadModel(const std::filesystem::path& filePath);
+	// Model is imported in background and added to the scene active when the import finishes.
+	static std::shared_ptr<ModelImport> LoadModel(const std::filesystem::path& filePath);
 	static void ReloadScene();
 
 	static void Start();
@@ -42,6 +44,8 @@ public:
 	static std::shared_ptr<Scene> GetScene();
 	static std::shared_ptr<SceneSnapshot> GetSceneSnapshot();
 	static void UpdateSceneSnapshot();
+	static BVHBuildMethod GetBVHBuildMethod();
+	static void SetBVHBuildMethod(BVHBuildMethod method);
 
 protected:
 	static std::filesystem::path m_currentScenePath;
@@ -49,6 +53,7 @@ protected:
 	static std::shared_ptr<Scene> m_virtualScene;
 	static std::shared_ptr<Scene> m_activeScene;
 	static std::shared_ptr<SceneSnapshot> m_sceneSnapshot;
+	static BVHBuildMethod m_bvhBuildMethod;
 	static SceneObject* m_selectedObject;
 	static bool m_playing;
 	static bool m_paused;
@@ -57,16 +62,8 @@ public:
 	template <class T, class... Args>
 	static inline T* CreateComponent(SceneObject* parent, Args&&... args) {
 		T* component = new T(parent, args...);
-		parent->m_components.push_back(component);
-		if constexpr (std::is_same<T, PointLightComponent>::value) {
-			m_activeScene->m_pointLights.push_back(component);
-		}
-		else if constexpr (std::is_same<T, AreaLightComponent>::value) {
-			m_activeScene->m_areaLights.push_back(component);
-		}
-		else if constexpr (std::is_same<T, DirectionalLightComponent>::value) {
-			m_activeScene->m_directionalLights.push_back(component);
-		}
+		parent->AddComponent(component);
+		m_activeScene->m_components.Add(component);
 		return component;
 	}
 };
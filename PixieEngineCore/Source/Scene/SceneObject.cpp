@@ -14,12 +14,33 @@ Component* SceneObject::GetComponent(int32_t index) const {
 }
 
 Component* SceneObject::GetComponent(ComponentType type) const {
+	return m_componentsByType[(size_t)type];
+}
+
+void SceneObject::AddComponent(Component* component) {
+	m_components.push_back(component);
+	if (!m_componentsByType[(size_t)component->type]) {
+		m_componentsByType[(size_t)component->type] = component;
+	}
+}
+
+void SceneObject::RemoveComponent(Component* component) {
 	for (size_t i = 0; i < m_components.size(); i++) {
-		if (m_components[i]->type == type) {
-			return m_components[i];
+		if (m_components[i] == component) {
+			m_components.erase(m_components.begin() + i);
+			break;
+		}
+	}
+	if (m_componentsByType[(size_t)component->type] != component) {
+		return;
+	}
+	m_componentsByType[(size_t)component->type] = nullptr;
+	for (size_t i = 0; i < m_components.size(); i++) {
+		if (m_components[i]->type == component->type) {
+			m_componentsByType[(size_t)component->type] = m_components[i];
+			break;
 		}
 	}
-	return nullptr;
 }
 
 void SceneObject::OnStart() {
@@ -58,6 +79,9 @@ void SceneObject::SetName(const std::string& name) {
 }
 
 Transform& SceneObject::GetTransform() {
+	if (m_hierarchy) {
+		m_hierarchy->SetDirty(m_transformIndex);
+	}
 	return m_localTransform;
 }
 
@@ -65,6 +89,10 @@ const Transform& SceneObject::GetTransform() const {
 	return m_localTransform;
 }
 
+const Transform& SceneObject::GetWorldTransform() const {
+	return m_worldTransform;
+}
+
 const std::vector<SceneObject*>& SceneObject::GetChildren() const {
 	return m_children;
 }
@@ -84,14 +112,17 @@ SceneObject* SceneObject::FindObject(const std::string& objectName) const {
 
 std::vector<SceneObject*> SceneObject::FindObjects(const std::string& objectName) const {
 	std::vector<SceneObject*> objects;
+	CollectObjects(objectName, objects);
+	return objects;
+}
+
+void SceneObject::CollectObjects(const std::string& objectName, std::vector<SceneObject*>& objects) const {
 	for (size_t i = 0; i < m_children.size(); i++) {
 		if (m_children[i]->m_name == objectName) {
 			objects.push_back(m_children[i]);
 		}
-		std::vector<SceneObject*> childrenFound = m_children[i]->FindObjects(objectName);
-		objects.insert(objects.end(), childrenFound.begin(), childrenFound.end());
+		m_children[i]->CollectObjects(objectName, objects);
 	}
-	return objects;
 }
 
 SceneObject* SceneObject::FindObjectWithComponent(ComponentType type) const {
@@ -105,12 +136,15 @@ SceneObject* SceneObject::FindObjectWithComponent(ComponentType type) const {
 
 std::vector<SceneObject*> SceneObject::FindObjectsWithComponent(ComponentType type) const {
 	std::vector<SceneObject*> objects;
+	CollectObjectsWithComponent(type, objects);
+	return objects;
+}
+
+void SceneObject::CollectObjectsWithComponent(ComponentType type, std::vector<SceneObject*>& objects) const {
 	for (size_t i = 0; i < m_children.size(); i++) {
 		if (m_children[i]->GetComponent(type)) {
 			objects.push_back(m_children[i]);
 		}
-		std::vector<SceneObject*> childrenFound = m_children[i]->FindObjectsWithComponent(type);
-		objects.insert(objects.end(), childrenFound.begin(), childrenFound.end());
+		m_children[i]->CollectObjectsWithComponent(type, objects);
 	}
-	return objects;
 }
@@ -3,6 +3,7 @@
 #include "Math/Transform.h"
 #include "Component.h"
 #include "ComponentTypes.h"
+#include "TransformHierarchy.h"
 
 class Component;
 
@@ -21,8 +22,11 @@ public:
 	const std::vector<Component*>& GetComponents() const;
 	Component* GetComponent(int32_t index) const;
 	Component* GetComponent(ComponentType type) const;
+	// Local transform, mutable access marks world transforms of the object and its subtree for update.
 	Transform& GetTransform();
 	const Transform& GetTransform() const;
+	// World transform as of the last Scene::UpdateTransforms.
+	const Transform& GetWorldTransform() const;
 
 	SceneObject* FindObject(const std::string& objectName) const;
 	std::vector<SceneObject*> FindObjects(const std::string& objectName) const;
@@ -38,19 +42,23 @@ protected:
 	SceneObject* m_parent;
 	std::vector<SceneObject*> m_children;
 	std::vector<Component*> m_components;
+	TransformHierarchy* m_hierarchy = nullptr;
+	int32_t m_transformIndex = -1;
+	// First component of each type, so typed lookups don't scan components.
+	std::array<Component*, (size_t)ComponentType::COUNT> m_componentsByType = {};
+
+	void AddComponent(Component* component);
+	void RemoveComponent(Component* component);
+	void CollectObjects(const std::string& objectName, std::vector<SceneObject*>& objects) const;
+	void CollectObjectsWithComponent(ComponentType type, std::vector<SceneObject*>& objects) const;
 
 	friend class SceneManager;
 	friend class Scene;
+	friend class TransformHierarchy;
 
 public:
 	template<typename T>
 	T* GetComponent() const {
-		for (size_t i = 0; i < m_components.size(); i++) {
-			T* cast = dynamic_cast<T*>(m_components[i]);
-			if (cast) {
-				return cast;
-			}
-		}
-		return nullptr;
+		return static_cast<T*>(m_componentsByType[(size_t)T::c_type]);
 	}
 };
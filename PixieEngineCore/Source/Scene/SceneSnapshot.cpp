@@ -3,48 +3,31 @@
 #include "Scene.h"
 #include "ResourceManager.h"
 
-SceneSnapshot::SceneSnapshot(Scene* scene) {
-	m_invalidTrianglesCount = 0;
-	std::vector<SceneObject*> flatObjects = scene->FindObjectsWithComponent(ComponentType::Mesh);
-	std::vector<ObjectCache> objects;
-
-	int32_t maxTrianglesCount = 0;
-	for (size_t i = 0; i < flatObjects.size(); i++) {
-		maxTrianglesCount += (int32_t)flatObjects[i]->GetComponent<MeshComponent>()->GetMesh()->m_indices.size() / 3;
-	}
-	m_triangles.reserve(maxTrianglesCount);
-
-	for (size_t sceneObjectIndex = 0; sceneObjectIndex < flatObjects.size(); sceneObjectIndex++) {
-		SceneObject* object = flatObjects[sceneObjectIndex];
-		MeshComponent* meshComopnent = object->GetComponent<MeshComponent>();
-		MaterialComponent* materialComponent = object->GetComponent<MaterialComponent>();
-		if (!meshComopnent || !materialComponent) {
-			continue;
-		}
-
-		Mesh* mesh = meshComopnent->GetMesh();
-		Material* material = materialComponent->GetMaterial();
-		if (!mesh || !material) {
-			continue;
-		}
+// Direction is not normalized, so distances along the instance space ray match world space ones and tMax is shared.
+static inline Ray ToInstanceSpace(const MeshInstance& instance, const Ray& ray) {
+	Ray instanceRay = ray;
+	instanceRay.origin = instance.transform.ApplyInversePoint(ray.origin);
+	instanceRay.direction = instance.transform.ApplyInverseVector(ray.direction);
+	instanceRay.inverseDirection = (Float)1 / instanceRay.direction;
+	return instanceRay;
+}
 
-		int32_t nodeIndex = BuildMeshBVH(mesh, material);
-		if (nodeIndex == -1) {
-			continue;
+SceneSnapshot::SceneSnapshot(Scene* scene, BVHBuildMethod buildMethod, const SceneSnapshot* previous) :
+	m_buildMethod(buildMethod) {
+	scene->UpdateTransforms();
+	const ComponentStorage& components = scene->GetComponents();
+	std::vector<ObjectCache> objects;
+	components.ForEach<MeshComponent, MaterialComponent>([&](SceneObject* object, MeshComponent* meshComponent, MaterialComponent* materialComponent) {
+		if (meshComponent->GetMesh() && materialComponent->GetMaterial()) {
+			AddMeshInstance(meshComponent->GetMesh(), materialComponent->GetMaterial(), object->GetWorldTransform(), previous, objects);
 		}
-		objects.push_back(ObjectCache(ObjectType::Mesh, nodeIndex, Bounds3f(m_nodes[nodeIndex].pMin, m_nodes[nodeIndex].pMax)));
-	}
-
-	std::vector<SceneObject*> spheres = scene->FindObjectsWithComponent(ComponentType::Sphere);
-	for (int32_t i = 0; i < spheres.size(); i++) {
-		SphereComponent* sphereComponent = spheres[i]->GetComponent<SphereComponent>();
-		MaterialComponent* materialComponent = spheres[i]->GetComponent<MaterialComponent>();
-		if (!sphereComponent || !materialComponent) {
-			continue;
+	});
+	components.ForEach<SphereComponent, MaterialComponent>([&](SceneObject* object, SphereComponent* sphereComponent, MaterialComponent* materialComponent) {
+		if (Material* material = materialComponent->GetMaterial()) {
+			m_spheres.push_back(Sphere(ResourceManager::GetMaterialIndex(material), object->GetWorldTransform(), sphereComponent->GetRadius()));
+			objects.push_back(ObjectCache(ObjectType::Sphere, (int32_t)m_spheres.size() - 1, m_spheres.back().Bounds()));
 		}
-		m_spheres.push_back(Sphere(ResourceManager::GetMaterialIndex(materialComponent->GetMaterial()), spheres[i]->GetTransform(), sphereComponent->GetRadius()));
-		objects.push_back(ObjectCache(ObjectType::Sphere, (int32_t)m_spheres.size() - 1, m_spheres.back().Bounds()));
-	}
+	});
 
 	//Skybox* skybox = scene->GetSkybox();
 	//if (skybox) {
@@ -60,281 +43,141 @@ SceneSnapshot::SceneSnapshot(Scene* scene) {
 	//	}
 	//}
 
-	std::vector<SceneObject*> directionalLights = scene->FindObjectsWithComponent(ComponentType::DirectionalLight);
-	for (int32_t i = 0; i < directionalLights.size(); i++) {
-		DirectionalLightComponent* lightComponent = directionalLights[i]->GetComponent<DirectionalLightComponent>();
-		DirectionalLight* light = new DirectionalLight(lightComponent->GetColor(), lightComponent->GetStrength(), directionalLights[i]->GetTransform());
+	for (DirectionalLightComponent* lightComponent : scene->GetDirectionalLights()) {
+		DirectionalLight* light = new DirectionalLight(lightComponent->GetColor(), lightComponent->GetStrength(), lightComponent->GetParent()->GetWorldTransform());
 		m_infiniteLights.push_back(light);
 		m_lights.push_back(light);
 	}
 
-	std::vector<SceneObject*> pointLights = scene->FindObjectsWithComponent(ComponentType::PointLight);
-	for (int32_t i = 0; i < pointLights.size(); i++) {
-		PointLightComponent* lightComponent = pointLights[i]->GetComponent<PointLightComponent>();
-		PointLight* light = new PointLight(lightComponent->GetColor(), lightComponent->GetStrength(), pointLights[i]->GetTransform());
+	for (PointLightComponent* lightComponent : scene->GetPointLights()) {
+		PointLight* light = new PointLight(lightComponent->GetColor(), lightComponent->GetStrength(), lightComponent->GetParent()->GetWorldTransform());
 		m_infiniteLights.push_back(light);
 		m_lights.push_back(light);
 	}
 
-	std::vector<SceneObject*> cameras = scene->FindObjectsWithComponent(ComponentType::Camera);
-	for (int32_t i = 0; i < cameras.size(); i++) {
-		CameraComponent* cameraComponent = cameras[i]->GetComponent<CameraComponent>();
+	for (CameraComponent* cameraComponent : scene->GetCameras()) {
 		Camera camera = cameraComponent->GetCamera();
-		camera.GetTransform() = cameras[i]->GetTransform();
+		camera.GetTransform() = cameraComponent->GetParent()->GetWorldTransform();
 		m_cameras.push_back(camera);
 	}
 
-	m_materials = ResourceManager::GetMaterials();
+	CreateSkyboxLight(scene, previous);
+	m_infiniteLights.push_back(m_skyboxLight.get());
 
-	const HDRISkybox& skybox = scene->GetSkybox();
-	glm::ivec2 skyboxResolution = skybox.m_equrectangularTexture.GetResolution();
-	Buffer2D<Spectrum> skyboxSpectrum(skyboxResolution);
-	for (int32_t y = 0; y < skyboxResolution.y; y++) {
-		for (int32_t x = 0; x < skyboxResolution.x; x++) {
-			skyboxSpectrum.SetValue(x, y, Spectrum(skybox.m_equrectangularTexture.GetPixel({ x, y })));
+	// Render threads read materials while the inspector may edit them, so every snapshot keeps its own copy.
+	m_materials = ResourceManager::GetMaterials();
+	for (Material& material : m_materials) {
+		if (material.m_albedoMap) {
+			material.m_pinnedAlbedoMap = material.m_albedoMap->Pin();
 		}
 	}
-	m_infiniteLights.push_back(new ImageInfiniteLight(Transform(), skyboxSpectrum, 1.0f));
 
-	BuildObjectsBVHRecoursive(objects, 0, (int32_t)objects.size());
+	BuildObjectsBVH(objects);
 }
 
-int32_t SceneSnapshot::BuildMeshBVH(Mesh* mesh, Material* material) {
-	int32_t materialIndex = ResourceManager::GetMaterialIndex(material);
-
-	int32_t startIndex = (int32_t)m_triangles.size();
-	for (size_t i = 0; i < mesh->m_indices.size() / 3; i++) {
-		Triangle triangle = Triangle(materialIndex, 
-			mesh->m_vertices[mesh->m_indices[i * 3 + 0]],
-			mesh->m_vertices[mesh->m_indices[i * 3 + 1]],
-			mesh->m_vertices[mesh->m_indices[i * 3 + 2]]
-		);
-
-		if (!triangle.Area() || isnan(triangle.normal)) {
-			m_invalidTrianglesCount++;
-			continue;
-		}
-		m_triangles.push_back(triangle);
+void SceneSnapshot::AddMeshInstance(Mesh* mesh, Material* material, const Transform& transform, const SceneSnapshot* previous, std::vector<ObjectCache>& objects) {
+	MeshBVH* bvh = GetMeshBVH(mesh, previous);
+	if (bvh->IsEmpty()) {
+		return;
+	}
 
-		DiffuseAreaLight* areaLight = nullptr;
-		if (material->m_emissionStrength) {
-			areaLight = new DiffuseAreaLight(&m_triangles.back(), Transform(), materialIndex);
-			m_triangles[m_triangles.size() - 1].m_lightIndex = (int32_t)m_areaLights.size();
+	int32_t materialIndex = ResourceManager::GetMaterialIndex(material);
+	int32_t lightOffset = -1;
+	if (material->m_emissionStrength) {
+		lightOffset = (int32_t)m_areaLights.size();
+		for (int32_t i = 0; i < bvh->GetTrianglesCount(); i++) {
+			m_lightTriangles.push_back(bvh->GetTriangle(i, materialIndex, transform));
+			DiffuseAreaLight* areaLight = new DiffuseAreaLight(&m_lightTriangles.back(), Transform(), materialIndex);
 			m_areaLights.push_back(areaLight);
 			m_lights.push_back(areaLight);
 		}
 	}
-	int32_t trianglesCount = (int32_t)m_triangles.size() - startIndex;
-	if (trianglesCount == 0) {
-		return -1;
-	}
-	return BuildBVHRecoursive(startIndex, trianglesCount);
+	m_meshInstances.push_back({ bvh, transform, !transform.IsIdentity(), materialIndex, lightOffset });
+	objects.push_back(ObjectCache(ObjectType::Mesh, (int32_t)m_meshInstances.size() - 1, transform.ApplyBounds(bvh->GetBounds())));
 }
 
-int32_t SceneSnapshot::BuildObjectsBVHRecoursive(std::vector<ObjectCache>& cache, int32_t start, int32_t objectsCount) {
-	constexpr int32_t nBuckets = 12;
-	constexpr int32_t nSplits = nBuckets - 1;
-
-	Vec3 pMin = Vec3(Infinity);
-	Vec3 pMax = Vec3(-Infinity);
-	Vec3 pMinNode = Vec3(Infinity);
-	Vec3 pMaxNode = Vec3(-Infinity);
-	for (int32_t i = start; i < start + objectsCount; i++) {
-		const ObjectCache& c = cache[i];
-		Vec3 centroid = c.bounds.Center();
-		pMin = glm::min(pMin, centroid);
-		pMax = glm::max(pMax, centroid);
-		pMinNode = glm::min(pMinNode, c.bounds.min);
-		pMaxNode = glm::max(pMaxNode, c.bounds.max);
-	}
-	int32_t axis = MaxComponentIndex(glm::abs(pMax - pMin));
-
-	std::sort(cache.begin() + start, cache.begin() + start + objectsCount,
-		[&](const ObjectCache& t0, const ObjectCache& t1) {
-			return t0.bounds.Center()[axis] < t1.bounds.Center()[axis];
-		});
-
-	std::array<int32_t, nBuckets> bucketCounts;
-	std::array<Vec3, nBuckets> bucketMins{ Vec3(Infinity) };
-	std::array<Vec3, nBuckets> bucketMaxs{ Vec3(-Infinity) };
-
-	for (int32_t i = start; i < start + objectsCount; i++) {
-		const ObjectCache& c = cache[i];
-		int32_t b = int32_t(nBuckets * Bounds3f(pMin, pMax).Offset(c.bounds.Center())[axis]);
-		if (b == nBuckets) {
-			b = nBuckets - 1;
-		}
-		bucketCounts[b]++;
-		bucketMins[b] = glm::min(bucketMins[b], c.bounds.min);
-		bucketMaxs[b] = glm::max(bucketMaxs[b], c.bounds.max);
+MeshBVH* SceneSnapshot::GetMeshBVH(const Mesh* mesh, const SceneSnapshot* previous) {
+	if (auto it = m_meshBVHs.find(mesh); it != m_meshBVHs.end()) {
+		return it->second.get();
 	}
 
-	std::array<Float, nSplits> costs{ 0 };
-	int32_t countBelow = 0;
-	Vec3 pMinBelow = Vec3(Infinity);
-	Vec3 pMaxBelow = Vec3(-Infinity);
-	for (int32_t i = 0; i < nSplits; i++) {
-		pMinBelow = glm::min(pMinBelow, bucketMins[i]);
-		pMaxBelow = glm::max(pMaxBelow, bucketMaxs[i]);
-		countBelow += bucketCounts[i];
-		costs[i] += countBelow * Bounds3f(pMinBelow, pMaxBelow).Area();
+	std::shared_ptr<MeshBVH> bvh;
+	if (previous) {
+		auto it = previous->m_meshBVHs.find(mesh);
+		// Version is unique among meshes, so a new mesh allocated at the address of a removed one is not matched.
+		if (it != previous->m_meshBVHs.end() && it->second->IsUpToDate(mesh, m_buildMethod)) {
+			bvh = it->second;
+		}
 	}
-
-	int32_t countAbove = 0;
-	Vec3 pMinAbove = Vec3(Infinity);
-	Vec3 pMaxAbove = Vec3(-Infinity);
-	for (int32_t i = nSplits; i >= 1; i--) {
-		pMinAbove = glm::min(pMinAbove, bucketMins[i]);
-		pMaxAbove = glm::max(pMaxAbove, bucketMaxs[i]);
-		countAbove += bucketCounts[i];
-		costs[i - 1] += countAbove * Bounds3f(pMinAbove, pMaxAbove).Area();
+	if (!bvh && mesh->m_cachedBVH && mesh->m_cachedBVH->IsUpToDate(mesh, m_buildMethod)) {
+		bvh = mesh->m_cachedBVH;
 	}
 
-	int32_t minCostSplitBucket = -1;
-	Float minCost = Infinity;
-	for (int32_t i = 0; i < nSplits; i++) {
-		if (costs[i] < minCost) {
-			minCost = costs[i];
-			minCostSplitBucket = i;
-		}
+	BVHBuildStats stats;
+	if (bvh) {
+		stats = bvh->GetBuildStats();
+		stats.buildTime = 0.0f;
+		m_reusedMeshBVHsCount++;
 	}
-
-	Float leafCost = (Float)objectsCount;
-	minCost = 1.0f / 2.0f + minCost / Bounds3f(pMinNode, pMaxNode).Area();
-
-	if (objectsCount <= ObjectBVHNodeChildrenCount || minCost > leafCost) {
-		m_objects.push_back(ObjectBVHNode(Transform(), pMinNode, pMaxNode));
-		for (int32_t childIndex = 0; childIndex < ObjectBVHNodeChildrenCount && childIndex < objectsCount; childIndex++) {
-			m_objects.back().childrenTypes[childIndex] = cache[start + childIndex].type;
-			m_objects.back().childrenIndexes[childIndex] = cache[start + childIndex].index;
-		}
-		return (int32_t)m_objects.size() - 1;
+	else {
+		bvh = std::make_shared<MeshBVH>(mesh, m_buildMethod);
+		stats = bvh->GetBuildStats();
 	}
-
-	auto midIter = std::partition(cache.begin() + start, cache.begin() + start + objectsCount,
-		[=](const ObjectCache& c) {
-			int32_t b = int32_t(nBuckets * Bounds3f(pMin, pMax).Offset(c.bounds.Center())[axis]);
-			if (b == nBuckets) {
-				b = nBuckets - 1;
-			}
-			return b <= minCostSplitBucket;
-		});
-	int32_t mid = int32_t(midIter - cache.begin());
-
-	int32_t nodeIndex = (int32_t)m_objects.size();
-	m_objects.push_back(ObjectBVHNode(Transform(), pMinNode, pMaxNode));
-
-	int32_t firstChild = BuildObjectsBVHRecoursive(cache, start, mid - start);
-	int32_t secondChild = BuildObjectsBVHRecoursive(cache, mid, objectsCount - (mid - start));
-
-	m_objects[nodeIndex].childrenIndexes[0] = firstChild;
-	m_objects[nodeIndex].childrenTypes[0] = ObjectType::Node;
-	m_objects[nodeIndex].childrenIndexes[1] = secondChild;
-	m_objects[nodeIndex].childrenTypes[1] = ObjectType::Node;
-
-	return nodeIndex;
+	m_buildStats.Add(stats);
+	m_meshBVHs[mesh] = bvh;
+	return bvh.get();
 }
 
-int32_t SceneSnapshot::BuildBVHRecoursive(int32_t start, int32_t trianglesCount) {
-	constexpr int32_t MaxTrianglesPerNode = 4;
-	constexpr int32_t nBuckets = 12;
-	constexpr int32_t nSplits = nBuckets - 1;
-
-	Vec3 pMin = Vec3(Infinity);
-	Vec3 pMax = Vec3(-Infinity);
-	Vec3 pMinNode = Vec3(Infinity);
-	Vec3 pMaxNode = Vec3(-Infinity);
-	for (int32_t i = start; i < start + trianglesCount; i++) {
-		const Triangle& tri = m_triangles[i];
-		Bounds3f bounds = tri.Bounds();
-		Vec3 centroid = bounds.Center();
-		pMin = glm::min(pMin, centroid);
-		pMax = glm::max(pMax, centroid);
-		pMinNode = glm::min(pMinNode, bounds.min);
-		pMaxNode = glm::max(pMaxNode, bounds.max);
-	}
-	int32_t axis = MaxComponentIndex(glm::abs(pMax - pMin));
-
-	std::sort(m_triangles.begin() + start, m_triangles.begin() + start + trianglesCount,
-		[&](const Triangle& t0, const Triangle& t1) {
-			return t0.Bounds().Center()[axis] < t1.Bounds().Center()[axis];
-		});
-
-	std::array<int32_t, nBuckets> bucketCounts;
-	std::array<Vec3, nBuckets> bucketMins{ Vec3(Infinity) };
-	std::array<Vec3, nBuckets> bucketMaxs{ Vec3(-Infinity) };
-
-	for (int32_t i = start; i < start + trianglesCount; i++) {
-		const Triangle& tri = m_triangles[i];
-		Bounds3f bounds = tri.Bounds();
-		int32_t b = int32_t(nBuckets * Bounds3f(pMin, pMax).Offset(bounds.Center())[axis]);
-		if (b == nBuckets) {
-			b = nBuckets - 1;
-		}
-		bucketCounts[b]++;
-		bucketMins[b] = glm::min(bucketMins[b], bounds.min);
-		bucketMaxs[b] = glm::max(bucketMaxs[b], bounds.max);
+void SceneSnapshot::CreateSkyboxLight(Scene* scene, const SceneSnapshot* previous) {
+	m_skyboxVersion = scene->GetSkyboxVersion();
+	if (previous && previous->m_skyboxLight && previous->m_skyboxVersion == m_skyboxVersion) {
+		m_skyboxLight = previous->m_skyboxLight;
+		return;
 	}
 
-	std::array<Float, nSplits> costs{ 0 };
-	int32_t countBelow = 0;
-	Vec3 pMinBelow = Vec3(Infinity);
-	Vec3 pMaxBelow = Vec3(-Infinity);
-	for (int32_t i = 0; i < nSplits; i++) {
-		pMinBelow = glm::min(pMinBelow, bucketMins[i]);
-		pMaxBelow = glm::max(pMaxBelow, bucketMaxs[i]);
-		countBelow += bucketCounts[i];
-		costs[i] += countBelow * Bounds3f(pMinBelow, pMaxBelow).Area();
+	const HDRISkybox& skybox = scene->GetSkybox();
+	std::shared_ptr<const EnvironmentMap> environmentMap = skybox.m_environmentMap;
+	if (!environmentMap) {
+		environmentMap = EnvironmentMap::FromTexture(skybox.m_equrectangularTexture);
 	}
+	m_skyboxLight = std::make_shared<ImageInfiniteLight>(Transform(), environmentMap, 1.0f);
+}
 
-	int32_t countAbove = 0;
-	Vec3 pMinAbove = Vec3(Infinity);
-	Vec3 pMaxAbove = Vec3(-Infinity);
-	for (int32_t i = nSplits; i >= 1; i--) {
-		pMinAbove = glm::min(pMinAbove, bucketMins[i]);
-		pMaxAbove = glm::max(pMaxAbove, bucketMaxs[i]);
-		countAbove += bucketCounts[i];
-		costs[i - 1] += countAbove * Bounds3f(pMinAbove, pMaxAbove).Area();
+void SceneSnapshot::BuildObjectsBVH(const std::vector<ObjectCache>& cache) {
+	if (cache.empty()) {
+		return;
 	}
-
-	int32_t minCostSplitBucket = -1;
-	Float minCost = Infinity;
-	for (int32_t i = 0; i < nSplits; i++) {
-		if (costs[i] < minCost) {
-			minCost = costs[i];
-			minCostSplitBucket = i;
-		}
+	std::vector<Bounds3f> bounds(cache.size());
+	for (size_t i = 0; i < cache.size(); i++) {
+		bounds[i] = cache[i].bounds;
 	}
+	BVHBuilder builder(m_buildMethod, ObjectBVHNodeChildrenCount, ObjectBVHNodeChildrenCount);
+	std::vector<BVHNode> nodes;
+	builder.Build(bounds, nodes);
+	m_buildStats.Add(builder.GetStats());
+	BuildObjectNodes(cache, nodes, builder.GetPrimitivesOrder(), 0);
+}
 
-	Float leafCost = (Float)trianglesCount;
-	minCost = 1.0f / 2.0f + minCost / Bounds3f(pMinNode, pMaxNode).Area();
-
-	if (trianglesCount <= MaxTrianglesPerNode || minCost > leafCost) {
-		m_nodes.push_back(BVHNode(start, trianglesCount, axis));
-		m_nodes.back().pMin = pMinNode;
-		m_nodes.back().pMax = pMaxNode;
-		return (int32_t)m_nodes.size() - 1;
+int32_t SceneSnapshot::BuildObjectNodes(const std::vector<ObjectCache>& cache, const std::vector<BVHNode>& nodes, const std::vector<int32_t>& order, int32_t nodeIndex) {
+	const BVHNode& node = nodes[nodeIndex];
+	int32_t objectIndex = (int32_t)m_objects.size();
+	m_objects.push_back(ObjectBVHNode(node.pMin, node.pMax));
+	if (node.nTriangles > 0) {
+		for (int32_t childIndex = 0; childIndex < node.nTriangles; childIndex++) {
+			const ObjectCache& object = cache[order[node.childOffset + childIndex]];
+			m_objects[objectIndex].childrenTypes[childIndex] = object.type;
+			m_objects[objectIndex].childrenIndexes[childIndex] = object.index;
+		}
+		return objectIndex;
 	}
 
-	auto midIter = std::partition(m_triangles.begin() + start, m_triangles.begin() + start + trianglesCount,
-		[=](const Triangle& tri) {
-			int32_t b = int32_t(nBuckets * Bounds3f(pMin, pMax).Offset(tri.Bounds().Center())[axis]);
-			if (b == nBuckets) {
-				b = nBuckets - 1;
-			}
-			return b <= minCostSplitBucket;
-		});
-	int32_t mid = int32_t(midIter - m_triangles.begin());
-
-	int32_t nodeIndex = (int32_t)m_nodes.size();
-	m_nodes.push_back(BVHNode(pMinNode, pMaxNode, axis));
-
-	int32_t firstChild = BuildBVHRecoursive(start, mid - start);
-	int32_t secondChild = BuildBVHRecoursive(mid, trianglesCount - (mid - start));
-
-	m_nodes[nodeIndex].childOffset = secondChild;
-
-	return nodeIndex;
+	int32_t firstChild = BuildObjectNodes(cache, nodes, order, nodeIndex + 1);
+	int32_t secondChild = BuildObjectNodes(cache, nodes, order, node.childOffset);
+	m_objects[objectIndex].childrenIndexes[0] = firstChild;
+	m_objects[objectIndex].childrenTypes[0] = ObjectType::Node;
+	m_objects[objectIndex].childrenIndexes[1] = secondChild;
+	m_objects[objectIndex].childrenTypes[1] = ObjectType::Node;
+	return objectIndex;
 }
 
 SceneSnapshot::~SceneSnapshot() {
@@ -343,10 +186,6 @@ SceneSnapshot::~SceneSnapshot() {
 	}
 }
 
-std::vector<BVHNode>& SceneSnapshot::GetNodes() {
-	return m_nodes;
-}
-
 std::vector<Light*>& SceneSnapshot::GetLights() {
 	return m_lights;
 }
@@ -363,39 +202,72 @@ std::vector<Light*>& SceneSnapshot::GetInfiniteLights() {
 	return m_infiniteLights;
 }
 
-std::vector<Triangle>& SceneSnapshot::GetTriangles() {
-	return m_triangles;
-}
-
 std::vector<Camera>& SceneSnapshot::GetCameras() {
 	return m_cameras;
 }
 
 Bounds3f SceneSnapshot::GetBounds() const {
-	return m_nodes.size() > 0 ? Bounds3f(m_nodes[0].pMin, m_nodes[0].pMax) : Bounds3f();
+	return m_objects.size() > 0 ? Bounds3f(m_objects[0].pMin, m_objects[0].pMax) : Bounds3f();
 }
 
 uint32_t SceneSnapshot::GetTrianglesCount() {
-	return (int32_t)m_triangles.size();
+	uint32_t count = 0;
+	for (const auto& [mesh, bvh] : m_meshBVHs) {
+		count += bvh->GetTrianglesCount();
+	}
+	return count;
+}
+
+uint32_t SceneSnapshot::GetMeshInstancesCount() {
+	return (uint32_t)m_meshInstances.size();
 }
 
 uint32_t SceneSnapshot::GetInvalidTrianglesCount() {
-	return m_invalidTrianglesCount;
+	uint32_t count = 0;
+	for (const auto& [mesh, bvh] : m_meshBVHs) {
+		count += bvh->GetInvalidTrianglesCount();
+	}
+	return count;
 }
 
 uint32_t SceneSnapshot::GetNodesCount() {
-	return (int32_t)m_nodes.size();
+	uint32_t count = (uint32_t)m_objects.size();
+	for (const auto& [mesh, bvh] : m_meshBVHs) {
+		count += bvh->GetNodesCount();
+	}
+	return count;
 }
 
 Material& SceneSnapshot::GetMaterial(int32_t index) {
 	return m_materials[index];
 }
 
+BVHLayout SceneSnapshot::GetBVHLayout() const {
+	return m_bvhLayout;
+}
+
+const BVHBuildStats& SceneSnapshot::GetBVHBuildStats() const {
+	return m_buildStats;
+}
+
+int32_t SceneSnapshot::GetReusedMeshBVHsCount() const {
+	return m_reusedMeshBVHsCount;
+}
+
+void SceneSnapshot::SetBVHLayout(BVHLayout layout) {
+	m_bvhLayout = layout;
+	for (auto& [mesh, bvh] : m_meshBVHs) {
+		bvh->PrepareLayout(layout);
+	}
+}
+
 std::optional<ShapeIntersection> SceneSnapshot::Intersect(const Ray& ray, int32_t* boxChecks, int32_t* shapeChecks, Float tMax) {
 	std::optional<ShapeIntersection> intersection = {};
 	if (m_objects.size() == 0) {
 		return intersection;
 	}
+	int32_t closestTriangle = -1;
+	int32_t closestInstance = -1;
 	std::array<int32_t, 64> objectsStack;
 	int32_t objectsStackSize = 0;
 	(*boxChecks)++;
@@ -422,96 +294,110 @@ std::optional<ShapeIntersection> SceneSnapshot::Intersect(const Ray& ray, int32_
 					if (si) {
 						tMax = si->tHit;
 						intersection = si;
+						closestInstance = -1;
 					}
 					break;
 				}
 				case ObjectType::Mesh: {
-					std::array<int32_t, 64> nodesStack;
-					int32_t nodesStackSize = 0;
-					(*boxChecks)++;
-					if (m_nodes[objectIndex].IsIntersected(ray, tMax)) {
-						nodesStack[nodesStackSize++] = objectIndex;
-					}
-					while (nodesStackSize > 0) {
-						nodesStackSize--;
-						int32_t nodeIndex = nodesStack[nodesStackSize];
-						const BVHNode& node = m_nodes[nodeIndex];
-						if (node.nTriangles > 0) {
-							for (int32_t i = 0; i < node.nTriangles; i++) {
-								(*shapeChecks)++;
-								std::optional<ShapeIntersection> si = m_triangles[node.childOffset + i].Intersect(ray, tMax);
-								if (si) {
-									tMax = si->tHit;
-									intersection = si;
-								}
-							}
-							continue;
-						}
-						int32_t firstChild = nodeIndex + 1;
-						int32_t secondChild = node.childOffset;
-						Float firstDistance = m_nodes[firstChild].IsIntersected(ray, tMax);
-						if (firstDistance != Infinity) {
-							nodesStack[nodesStackSize++] = firstChild;
-						}
-						Float secondDistance = m_nodes[secondChild].IsIntersected(ray, tMax);
-						if (secondDistance != Infinity) {
-							nodesStack[nodesStackSize++] = secondChild;
-						}
-						(*boxChecks) += 2;
+					const MeshInstance& instance = m_meshInstances[objectIndex];
+					int32_t hitTriangle = -1;
+					instance.bvh->Intersect(m_bvhLayout, instance.hasTransform ? ToInstanceSpace(instance, ray) : ray, hitTriangle, tMax, boxChecks, shapeChecks);
+					if (hitTriangle != -1) {
+						closestTriangle = hitTriangle;
+						closestInstance = objectIndex;
 					}
+					break;
 				}
 				}
 			}
 		}
 		
 	}
+	if (closestInstance != -1) {
+		intersection = GetTriangleIntersection(m_meshInstances[closestInstance], closestTriangle, ray, tMax);
+	}
 	return intersection;
 }
 
-bool SceneSnapshot::IsIntersected(const Ray& ray, int32_t* boxChecks, int32_t* shapeChecks, Float tMax) {
-	for (int32_t i = 0; i < m_spheres.size(); i++) {
-		(*shapeChecks)++;
-		if (m_spheres[i].IsIntersected(ray, tMax)) {
-			return true;
-		}
+ShapeIntersection SceneSnapshot::GetTriangleIntersection(const MeshInstance& instance, int32_t triangleIndex, const Ray& ray, Float tHit) const {
+	const TriangleShading& shading = instance.bvh->GetTriangleShading(triangleIndex);
+	Vec3 normal = shading.normal;
+	Vec3 position = ray.origin + ray.direction * tHit;
+	Vec3 localPosition = position;
+	Float uvScale = shading.uvScale;
+	if (instance.hasTransform) {
+		normal = glm::normalize(Mat3(glm::transpose(instance.transform.GetInverseMatrix())) * normal);
+		localPosition = instance.transform.ApplyInversePoint(position);
+		uvScale /= std::max<Float>(std::cbrt(glm::abs(glm::determinant(Mat3(instance.transform.GetMatrix())))), MachineEpsilon);
 	}
-	if (m_triangles.size() == 0) {
+	RayInteraction intr;
+	intr.normal = glm::dot(normal, ray.direction) < 0 ? normal : -normal;
+	intr.position = position;
+	intr.uv = instance.bvh->GetTriangleUV(triangleIndex, localPosition);
+	// Footprint stretches along the surface at grazing angles, cosine is clamped to keep it bounded.
+	Float cosTheta = std::max<Float>(glm::abs(glm::dot(normal, ray.direction)), 0.05f);
+	intr.uvFootprint = (ray.coneWidth + ray.coneSpread * tHit) * uvScale / cosTheta;
+	intr.wo = -ray.direction;
+	intr.materialIndex = instance.materialIndex;
+	intr.lightIndex = instance.lightOffset != -1 ? instance.lightOffset + triangleIndex : -1;
+	return ShapeIntersection(intr, tHit);
+}
+
+bool SceneSnapshot::IsIntersected(const Ray& ray, int32_t* boxChecks, int32_t* shapeChecks, Float tMax) {
+	if (m_objects.size() == 0) {
 		return false;
 	}
-	std::array<int32_t, 64> nodesStack;
-	int32_t stackSize = 0;
+	std::array<int32_t, 64> objectsStack;
+	int32_t objectsStackSize = 0;
 	(*boxChecks)++;
-	Float rootDistance = m_nodes[0].IsIntersected(ray, tMax);
-	if (rootDistance != Infinity) {
-		nodesStack[stackSize] = 0;
-		stackSize++;
+	if (m_objects[0].IsIntersected(ray, tMax)) {
+		objectsStack[objectsStackSize++] = 0;
 	}
-	while (stackSize > 0) {
-		stackSize--;
-		int32_t nodeIndex = nodesStack[stackSize];
-		const BVHNode& node = m_nodes[nodeIndex];
-		if (node.nTriangles > 0) {
-			for (int32_t i = 0; i < node.nTriangles; i++) {
+	while (objectsStackSize > 0) {
+		objectsStackSize--;
+		const ObjectBVHNode& objectNode = m_objects[objectsStack[objectsStackSize]];
+		std::array<int32_t, ObjectBVHNodeChildrenCount> hitNodes;
+		std::array<Float, ObjectBVHNodeChildrenCount> hitDistances;
+		int32_t hitNodesCount = 0;
+		for (int32_t childIndex = 0; childIndex < ObjectBVHNodeChildrenCount; childIndex++) {
+			int32_t objectIndex = objectNode.childrenIndexes[childIndex];
+			if (objectIndex < 0) {
+				continue;
+			}
+			switch (objectNode.childrenTypes[childIndex]) {
+			case ObjectType::Node: {
+				(*boxChecks)++;
+				Float tEnter;
+				if (m_objects[objectIndex].IsIntersected(ray, tMax, &tEnter)) {
+					hitNodes[hitNodesCount] = objectIndex;
+					hitDistances[hitNodesCount] = tEnter;
+					hitNodesCount++;
+				}
+				break;
+			}
+			case ObjectType::Sphere: {
 				(*shapeChecks)++;
-				if (m_triangles[node.childOffset + i].IsIntersected(ray, tMax)) {
+				if (m_spheres[objectIndex].IsIntersected(ray, tMax)) {
 					return true;
 				}
+				break;
+			}
+			case ObjectType::Mesh: {
+				const MeshInstance& instance = m_meshInstances[objectIndex];
+				if (instance.bvh->IsIntersected(m_bvhLayout, instance.hasTransform ? ToInstanceSpace(instance, ray) : ray, tMax, boxChecks, shapeChecks)) {
+					return true;
+				}
+				break;
+			}
 			}
-			continue;
 		}
-		int32_t firstChild = nodeIndex + 1;
-		int32_t secondChild = node.childOffset;
-		Float firstDistance = m_nodes[firstChild].IsIntersected(ray, tMax);
-		if (firstDistance != Infinity) {
-			nodesStack[stackSize] = firstChild;
-			stackSize++;
+		// Push far node first, so the nearer one is tested first and is more likely to end the query.
+		if (hitNodesCount == 2 && hitDistances[0] < hitDistances[1]) {
+			std::swap(hitNodes[0], hitNodes[1]);
 		}
-		Float secondDistance = m_nodes[secondChild].IsIntersected(ray, tMax);
-		if (secondDistance != Infinity) {
-			nodesStack[stackSize] = secondChild;
-			stackSize++;
+		for (int32_t i = 0; i < hitNodesCount; i++) {
+			objectsStack[objectsStackSize++] = hitNodes[i];
 		}
-		(*boxChecks) += 2;
 	}
 	return false;
 }
@@ -2,12 +2,22 @@
 #include "pch.h"
 #include "SceneObject.h"
 #include "BVHNode.h"
+#include "MeshBVH.h"
 #include "RayTracing/Lights.h"
 #include "RayTracing/Shapes.h"
 #include "Scene/Components/Components.h"
 
 class Scene;
 
+// Mesh object referencing BVH shared by all objects with the same mesh. Rays are moved into mesh space with the object world transform.
+struct MeshInstance {
+	MeshBVH* bvh;
+	Transform transform;
+	bool hasTransform;
+	int32_t materialIndex;
+	int32_t lightOffset; // area light index of the first triangle, -1 if material is not emissive
+};
+
 struct ObjectCache {
 	ObjectType type;
 	int32_t index;
@@ -16,38 +26,52 @@ struct ObjectCache {
 
 class SceneSnapshot {
 public:
-	SceneSnapshot(Scene* scene);
+	// Mesh BVHs and skybox light of previous snapshot are reused when their source data did not change,
+	// so only objects tree is rebuilt when objects are moved.
+	SceneSnapshot(Scene* scene, BVHBuildMethod buildMethod = BVHBuildMethod::SAH, const SceneSnapshot* previous = nullptr);
 	~SceneSnapshot();
 
 	Bounds3f GetBounds() const;
-	std::vector<BVHNode>& GetNodes();
 	std::vector<Light*>& GetLights();
 	std::vector<DiffuseAreaLight*>& GetAreaLights();
 	DiffuseAreaLight* GetAreaLight(int32_t index);
 	std::vector<Light*>& GetInfiniteLights();
-	std::vector<Triangle>& GetTriangles();
 	std::vector<Camera>& GetCameras();
 	uint32_t GetTrianglesCount();
+	uint32_t GetMeshInstancesCount();
 	uint32_t GetInvalidTrianglesCount();
 	uint32_t GetNodesCount();
 	Material& GetMaterial(int32_t index);
+	BVHLayout GetBVHLayout() const;
+	void SetBVHLayout(BVHLayout layout);
+	const BVHBuildStats& GetBVHBuildStats() const;
+	int32_t GetReusedMeshBVHsCount() const;
 
 	std::optional<ShapeIntersection> Intersect(const Ray& ray, int32_t* boxChecks, int32_t* shapeChecks, Float tMax = Infinity);
 	bool IsIntersected(const Ray& ray, int32_t* boxChecks, int32_t* shapeChecks, Float tMax = Infinity);
 
 private:
-	std::vector<Material> m_materials;
-	std::vector<Triangle> m_triangles;
+	std::unordered_map<const Mesh*, std::shared_ptr<MeshBVH>> m_meshBVHs;
+	std::vector<MeshInstance> m_meshInstances;
+	std::deque<Triangle> m_lightTriangles;
 	std::vector<Sphere> m_spheres;
 	std::vector<ObjectBVHNode> m_objects;
-	std::vector<BVHNode> m_nodes;
+	BVHLayout m_bvhLayout = BVHLayout::Binary;
+	BVHBuildMethod m_buildMethod = BVHBuildMethod::SAH;
+	BVHBuildStats m_buildStats;
+	int32_t m_reusedMeshBVHsCount = 0;
+	std::shared_ptr<ImageInfiniteLight> m_skyboxLight;
+	uint64_t m_skyboxVersion = 0;
 	std::vector<DiffuseAreaLight*> m_areaLights;
 	std::vector<Light*> m_infiniteLights;
 	std::vector<Light*> m_lights;
 	std::vector<Camera> m_cameras;
-	uint32_t m_invalidTrianglesCount;
+	std::vector<Material> m_materials;
 
-	int32_t BuildMeshBVH(Mesh* mesh, Material* material);
-	int32_t BuildObjectsBVHRecoursive(std::vector<ObjectCache>& cache, int32_t start, int32_t objectsCount);
-	int32_t BuildBVHRecoursive(int32_t start, int32_t trianglesCount);
+	void AddMeshInstance(Mesh* mesh, Material* material, const Transform& transform, const SceneSnapshot* previous, std::vector<ObjectCache>& objects);
+	MeshBVH* GetMeshBVH(const Mesh* mesh, const SceneSnapshot* previous);
+	void CreateSkyboxLight(Scene* scene, const SceneSnapshot* previous);
+	void BuildObjectsBVH(const std::vector<ObjectCache>& cache);
+	int32_t BuildObjectNodes(const std::vector<ObjectCache>& cache, const std::vector<BVHNode>& nodes, const std::vector<int32_t>& order, int32_t nodeIndex);
+	ShapeIntersection GetTriangleIntersection(const MeshInstance& instance, int32_t triangleIndex, const Ray& ray, Float tHit) const;
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include "Buffer2DTexture.h"
+#include "RayTracing/EnvironmentMap.h"
 
 class HDRISkybox {
 public:
@@ -8,6 +9,8 @@ public:
 	Texture m_cubemapTexture;
 	Texture m_lightmapTexture;
 	Texture m_prefilteredTexture;
+	// Radiance and sampling tables for ray tracing, built on load. Snapshots build it themselves when it's missing.
+	std::shared_ptr<const EnvironmentMap> m_environmentMap;
 
 	HDRISkybox() = default;
 	HDRISkybox(Buffer2DTexture<Vec3>& equrectangularTexture, Texture cubemapTexture, Texture lightmapTexture, Texture prefilteredTexture) :
@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "TransformHierarchy.h"
+#include "SceneObject.h"
+#include "Parallel.h"
+
+void TransformHierarchy::SetStructureDirty() {
+	m_structureDirty = true;
+}
+
+void TransformHierarchy::SetDirty(int32_t index) {
+	// Indices are stale after structural changes, but then every object is updated anyway.
+	if (m_structureDirty || index < 0 || (size_t)index >= m_dirty.size()) {
+		return;
+	}
+	m_dirty[index] = 1;
+	m_hasDirty = true;
+}
+
+void TransformHierarchy::Update(SceneObject* root) {
+	if (m_structureDirty) {
+		Rebuild(root);
+	}
+	if (!m_hasDirty) {
+		m_updatedCount = 0;
+		return;
+	}
+
+	std::atomic<int32_t> updatedCount = 0;
+	for (size_t level = 0; level + 1 < m_levelOffsets.size(); level++) {
+		int32_t levelStart = m_levelOffsets[level];
+		ParallelFor(m_levelOffsets[level + 1] - levelStart, [&](int32_t start, int32_t end) {
+			int32_t count = 0;
+			for (int32_t i = levelStart + start; i < levelStart + end; i++) {
+				int32_t parent = m_parents[i];
+				if (parent != -1 && m_dirty[parent]) {
+					m_dirty[i] = 1;
+				}
+				if (!m_dirty[i]) {
+					continue;
+				}
+				SceneObject* object = m_objects[i];
+				m_worldTransforms[i] = parent == -1 ? object->m_localTransform : m_worldTransforms[parent] * object->m_localTransform;
+				object->m_worldTransform = m_worldTransforms[i];
+				count++;
+			}
+			updatedCount += count;
+		}, 4 * 1024);
+	}
+	std::fill(m_dirty.begin(), m_dirty.end(), 0);
+	m_hasDirty = false;
+	m_updatedCount = updatedCount;
+}
+
+int32_t TransformHierarchy::GetObjectsCount() const {
+	return (int32_t)m_objects.size();
+}
+
+int32_t TransformHierarchy::GetLevelsCount() const {
+	return std::max((int32_t)m_levelOffsets.size() - 1, 0);
+}
+
+int32_t TransformHierarchy::GetUpdatedCount() const {
+	return m_updatedCount;
+}
+
+void TransformHierarchy::Rebuild(SceneObject* root) {
+	m_objects.clear();
+	m_parents.clear();
+	m_levelOffsets.clear();
+	m_objects.push_back(root);
+	m_parents.push_back(-1);
+	// Breadth first order keeps each level contiguous and places parents before their children.
+	int32_t levelStart = 0;
+	while (levelStart < (int32_t)m_objects.size()) {
+		m_levelOffsets.push_back(levelStart);
+		int32_t levelEnd = (int32_t)m_objects.size();
+		for (int32_t i = levelStart; i < levelEnd; i++) {
+			for (SceneObject* child : m_objects[i]->GetChildren()) {
+				m_objects.push_back(child);
+				m_parents.push_back(i);
+			}
+		}
+		levelStart = levelEnd;
+	}
+	m_levelOffsets.push_back((int32_t)m_objects.size());
+
+	for (int32_t i = 0; i < (int32_t)m_objects.size(); i++) {
+		m_objects[i]->m_hierarchy = this;
+		m_objects[i]->m_transformIndex = i;
+	}
+	m_worldTransforms.resize(m_objects.size());
+	m_dirty.assign(m_objects.size(), 1);
+	m_hasDirty = true;
+	m_structureDirty = false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "pch.h"
+#include "Math/Transform.h"
+
+class SceneObject;
+
+// World transforms of all objects of a scene in flat arrays sorted by depth, so every parent precedes its children and
+// objects of one depth level form a contiguous range. Mutable access to a local transform marks its object dirty,
+// Update recomputes world transforms of dirty objects and their subtrees only. Levels are independent of each other's
+// objects, so large ones are processed on several threads.
+class TransformHierarchy {
+public:
+	// Objects were added, removed or moved to another parent, arrays are rebuilt on next update.
+	void SetStructureDirty();
+	void SetDirty(int32_t index);
+	void Update(SceneObject* root);
+	int32_t GetObjectsCount() const;
+	int32_t GetLevelsCount() const;
+	// Number of world transforms recomputed by the last update.
+	int32_t GetUpdatedCount() const;
+
+protected:
+	std::vector<SceneObject*> m_objects;
+	std::vector<int32_t> m_parents;
+	std::vector<Transform> m_worldTransforms;
+	std::vector<uint8_t> m_dirty;
+	std::vector<int32_t> m_levelOffsets; // first index of every level, followed by objects count
+	bool m_structureDirty = true;
+	bool m_hasDirty = false;
+	int32_t m_updatedCount = 0;
+
+	void Rebuild(SceneObject* root);
+};
@@ -60,10 +60,10 @@ void DefferedLightingNode::SetupLights(const Scene& scene) {
 	// Point lights
 	const size_t MaxPointLights = 32;
 	int32_t nPointLights = 0;
-	const std::vector<PointLightComponent*>& pointLights = scene.GetPointLights();
+	ComponentView<PointLightComponent> pointLights = scene.GetPointLights();
 	for (size_t i = 0; i < pointLights.size() && i < MaxPointLights; i++) {
 		const std::string base = std::string("pointLights[") + std::to_string(nPointLights) + std::string("].");
-		m_program.SetUniform3f(base + std::string("position"), pointLights[i]->GetParent()->GetTransform().GetPosition());
+		m_program.SetUniform3f(base + std::string("position"), pointLights[i]->GetParent()->GetWorldTransform().GetPosition());
 		m_program.SetUniform3f(base + std::string("emission"), pointLights[i]->GetEmission());
 		nPointLights++;
 	}
@@ -72,7 +72,7 @@ void DefferedLightingNode::SetupLights(const Scene& scene) {
 	// Area lights
 	const size_t MaxAreaLights = 32;
 	int32_t nAreaLights = 0;
-	const std::vector<AreaLightComponent*>& areaLights = scene.GetAreaLights();
+	ComponentView<AreaLightComponent> areaLights = scene.GetAreaLights();
 	for (size_t i = 0; i < areaLights.size(); i++) {
 		MeshComponent* meshComponent = areaLights[i]->GetParent()->GetComponent<MeshComponent>();
 		if (!meshComponent) continue;
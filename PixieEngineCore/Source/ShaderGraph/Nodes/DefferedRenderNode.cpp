@@ -70,17 +70,17 @@ void DefferedRenderNode::Process(const Scene& scene, const Camera& camera) {
 	m_program.SetUniform3f("cameraPos", camera.GetTransform().GetPosition());
 	m_program.SetUniformMat4f("mView", camera.GetViewMatrix());
 	m_program.SetUniformMat4f("mProjection", camera.GetProjectionMatrix());
-	DrawObject(scene.GetRootObject(), Mat4(1.0f));
+	DrawObject(scene.GetRootObject());
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Restore original viewport
 	glViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
 }
 
-void DefferedRenderNode::DrawObject(SceneObject* object, Mat4 parentTransform) {
+void DefferedRenderNode::DrawObject(SceneObject* object) {
 	if (!object) return;
 
-	Mat4 objectTransform = parentTransform * object->GetTransform().GetMatrix();
+	const Mat4& objectTransform = object->GetWorldTransform().GetMatrix();
 	if (const MeshAnimatorComponent* animatorComponent = object->GetComponent<MeshAnimatorComponent>()) {
 		std::array<Mat4, MaxBonesPerModel> boneMatricesBuffer;
 		animatorComponent->GetBoneMatrices(0.0f, boneMatricesBuffer);
@@ -105,7 +105,7 @@ void DefferedRenderNode::DrawObject(SceneObject* object, Mat4 parentTransform) {
 		sphere->Draw();
 	}
 	for (size_t i = 0; i < object->GetChildren().size(); i++) {
-		DrawObject(object->GetChild((int32_t)i), objectTransform);
+		DrawObject(object->GetChild((int32_t)i));
 	}
 }
 
@@ -113,5 +113,5 @@ void DefferedRenderNode::SetupMaterial(Material* material) {
 	m_program.SetUniform3f("albedo", material->m_albedo.GetRGB());
 	m_program.SetUniform1f("metallic", material->m_metallic);
 	m_program.SetUniform1f("roughness", material->m_roughness);
-	m_program.SetTexture("albedoTexture", material->m_albedoTexture.GetID(), 6);
+	m_program.SetTexture("albedoTexture", material->GetAlbedoTextureID(), 6);
 }
@@ -19,6 +19,6 @@ protected:
 	Texture m_metallic;
 	Texture m_roughness;
 
-	void DrawObject(SceneObject* object, Mat4 parentTransform);
+	void DrawObject(SceneObject* object);
 	void SetupMaterial(Material* material);
 };
@@ -0,0 +1,115 @@
+#pragma once
+#include "pch.h"
+#include "Math/MathBase.h"
+#include "Math/SIMD.h"
+#include "RayTracing/Ray.h"
+
+// Ray data in single precision, shared by all children tests of wide nodes.
+struct WideBVHRay {
+	float origin[3];
+	float inverseDirection[3];
+
+	WideBVHRay(const Ray& ray) {
+		for (int32_t i = 0; i < 3; i++) {
+			origin[i] = (float)ray.origin[i];
+			inverseDirection[i] = (float)ray.inverseDirection[i];
+		}
+	}
+};
+
+// BVH node with Width children bounds stored as SoA, so all of them are tested at once.
+// Child with trianglesCount > 0 is a leaf and childOffset is its first triangle packet, otherwise a wide node index.
+template<int32_t Width>
+struct alignas(32) WideBVHNode {
+	float minX[Width] = { 0 };
+	float minY[Width] = { 0 };
+	float minZ[Width] = { 0 };
+	float maxX[Width] = { 0 };
+	float maxY[Width] = { 0 };
+	float maxZ[Width] = { 0 };
+	int32_t childOffsets[Width];
+	int32_t trianglesCounts[Width] = { 0 };
+	int32_t childrenCount = 0;
+
+	WideBVHNode() {
+		std::fill(childOffsets, childOffsets + Width, -1);
+	}
+
+	void SetChild(int32_t index, Vec3 pMin, Vec3 pMax, int32_t offset, int32_t trianglesCount) {
+		// Round outwards, so single precision bounds never shrink.
+		auto roundDown = [](Float value) {
+			float result = (float)value;
+			return (Float)result > value ? std::nextafter(result, -std::numeric_limits<float>::infinity()) : result;
+			};
+		auto roundUp = [](Float value) {
+			float result = (float)value;
+			return (Float)result < value ? std::nextafter(result, std::numeric_limits<float>::infinity()) : result;
+			};
+		minX[index] = roundDown(pMin.x);
+		minY[index] = roundDown(pMin.y);
+		minZ[index] = roundDown(pMin.z);
+		maxX[index] = roundUp(pMax.x);
+		maxY[index] = roundUp(pMax.y);
+		maxZ[index] = roundUp(pMax.z);
+		childOffsets[index] = offset;
+		trianglesCounts[index] = trianglesCount;
+		childrenCount = std::max(childrenCount, index + 1);
+	}
+
+	// Returns bit mask of intersected children and writes entry distances into tNear.
+	int32_t Intersect(const WideBVHRay& ray, float tMax, float* tNear) const {
+		const float farScale = 1.0f + 2.0f * (float)gamma(3);
+		int32_t mask = 0;
+#if defined(PIXIE_ENGINE_AVX)
+		if constexpr (Width == 8) {
+			__m256 ox = _mm256_set1_ps(ray.origin[0]), oy = _mm256_set1_ps(ray.origin[1]), oz = _mm256_set1_ps(ray.origin[2]);
+			__m256 ix = _mm256_set1_ps(ray.inverseDirection[0]), iy = _mm256_set1_ps(ray.inverseDirection[1]), iz = _mm256_set1_ps(ray.inverseDirection[2]);
+			__m256 t0x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(minX), ox), ix);
+			__m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(maxX), ox), ix);
+			__m256 t0y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(minY), oy), iy);
+			__m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(maxY), oy), iy);
+			__m256 t0z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(minZ), oz), iz);
+			__m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(maxZ), oz), iz);
+			__m256 scale = _mm256_set1_ps(farScale);
+			__m256 tEnter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)), _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_setzero_ps()));
+			__m256 tExit = _mm256_min_ps(_mm256_mul_ps(_mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)), _mm256_max_ps(t0z, t1z)), scale), _mm256_set1_ps(tMax));
+			_mm256_storeu_ps(tNear, tEnter);
+			mask = _mm256_movemask_ps(_mm256_cmp_ps(tEnter, tExit, _CMP_LE_OQ));
+			return mask & ((1 << childrenCount) - 1);
+		}
+#endif
+#if defined(PIXIE_ENGINE_SSE)
+		if constexpr (Width % 4 == 0) {
+			__m128 ox = _mm_set1_ps(ray.origin[0]), oy = _mm_set1_ps(ray.origin[1]), oz = _mm_set1_ps(ray.origin[2]);
+			__m128 ix = _mm_set1_ps(ray.inverseDirection[0]), iy = _mm_set1_ps(ray.inverseDirection[1]), iz = _mm_set1_ps(ray.inverseDirection[2]);
+			__m128 scale = _mm_set1_ps(farScale);
+			__m128 maxDistance = _mm_set1_ps(tMax);
+			for (int32_t i = 0; i < Width; i += 4) {
+				__m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minX + i), ox), ix);
+				__m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxX + i), ox), ix);
+				__m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minY + i), oy), iy);
+				__m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxY + i), oy), iy);
+				__m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minZ + i), oz), iz);
+				__m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maxZ + i), oz), iz);
+				__m128 tEnter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+				__m128 tExit = _mm_min_ps(_mm_mul_ps(_mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_max_ps(t0z, t1z)), scale), maxDistance);
+				_mm_storeu_ps(tNear + i, tEnter);
+				mask |= _mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)) << i;
+			}
+			return mask & ((1 << childrenCount) - 1);
+		}
+#endif
+		for (int32_t i = 0; i < childrenCount; i++) {
+			float t0x = (minX[i] - ray.origin[0]) * ray.inverseDirection[0], t1x = (maxX[i] - ray.origin[0]) * ray.inverseDirection[0];
+			float t0y = (minY[i] - ray.origin[1]) * ray.inverseDirection[1], t1y = (maxY[i] - ray.origin[1]) * ray.inverseDirection[1];
+			float t0z = (minZ[i] - ray.origin[2]) * ray.inverseDirection[2], t1z = (maxZ[i] - ray.origin[2]) * ray.inverseDirection[2];
+			float tEnter = std::max(std::max(std::min(t0x, t1x), std::min(t0y, t1y)), std::max(std::min(t0z, t1z), 0.0f));
+			float tExit = std::min(std::min(std::min(std::max(t0x, t1x), std::max(t0y, t1y)), std::max(t0z, t1z)) * farScale, tMax);
+			tNear[i] = tEnter;
+			if (tEnter <= tExit) {
+				mask |= 1 << i;
+			}
+		}
+		return mask;
+	}
+};
@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "WorkStealingDeque.h"
+
+void WorkStealingDeque::Reset(int32_t capacity) {
+	int64_t size = 1;
+	while (size < capacity) size <<= 1;
+	m_items = std::make_unique<std::atomic<int64_t>[]>(size);
+	m_mask = size - 1;
+	m_top = 0;
+	m_bottom = 0;
+}
+
+void WorkStealingDeque::Push(int64_t item) {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	m_items[bottom & m_mask].store(item, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+bool WorkStealingDeque::Pop(int64_t& item) {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+	if (top > bottom) {
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+	item = m_items[bottom & m_mask].load(std::memory_order_relaxed);
+	if (top == bottom) {
+		// Last item, race with thieves.
+		bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+	return true;
+}
+
+bool WorkStealingDeque::Steal(int64_t& item) {
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+	if (top >= bottom) {
+		return false;
+	}
+	item = m_items[top & m_mask].load(std::memory_order_relaxed);
+	return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "pch.h"
+
+// Fixed capacity Chase-Lev deque. Only owner thread can push and pop, any thread can steal.
+class WorkStealingDeque {
+public:
+	void Reset(int32_t capacity);
+	void Push(int64_t item);
+	bool Pop(int64_t& item);
+	bool Steal(int64_t& item);
+
+protected:
+	std::unique_ptr<std::atomic<int64_t>[]> m_items;
+	int64_t m_mask = 0;
+	alignas(64) std::atomic<int64_t> m_top = 0;
+	alignas(64) std::atomic<int64_t> m_bottom = 0;
+};
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <filesystem>
 #include <string>
+#include <sstream>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
@@ -12,15 +13,20 @@
 #include <vector>
 #include <array>
 #include <queue>
+#include <deque>
 #include <unordered_map>
 #include <map>
 #include <set>
 #include <span>
 #include <atomic>
 #include <thread>
+#include <future>
 #include <optional>
+#include <variant>
 #include <mutex>
+#include <condition_variable>
 #include <numeric>
+#include <bit>
 #include <memory_resource>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -13,5 +13,6 @@ void main() {
 	if (pixel.a < 0.1) {
 		discard;
 	}
+	else if (uSamples <= 0.0) color = vec4(pixel.rgb / pixel.a, 1.0f);
 	else color = vec4(pixel.rgb / uSamples, 1.0f);
 }